@@ -31,6 +31,7 @@
 #include <string>
 #include <unordered_map>
 #include <memory>
+#include <vector>
 
 #include "velocypack/velocypack-common.h"
 #include "velocypack/Options.h"
@@ -46,7 +47,8 @@ class AttributeTranslator {
   AttributeTranslator(AttributeTranslator const&) = delete;
   AttributeTranslator& operator=(AttributeTranslator const&) = delete;
 
-  AttributeTranslator() : _builder(nullptr), _count(0) {}
+  AttributeTranslator()
+      : _builder(nullptr), _keyToIdMask(0), _count(0), _generation(nextGeneration()) {}
 
   ~AttributeTranslator();
 
@@ -56,8 +58,33 @@ class AttributeTranslator {
 
   void seal();
 
+  // makes the translator use an existing dictionary Object that maps
+  // attribute names to ids, as produced by builder() after seal(). the
+  // memory of dictionary is not copied and must stay valid for the
+  // lifetime of the translator. keys must not have been added before
+  void load(Slice const& dictionary);
+
+  // returns the dictionary Object of a sealed or loaded translator
+  Slice dictionary() const { return _dictionary; }
+
   Builder* builder() const { return _builder; }
 
+  // returns an id that is unique among all translators and changes
+  // whenever the translator's tables are rebuilt by seal() or load(), so
+  // that cached translations can be checked without relying on the
+  // translator's address, which may be reused by a later translator
+  uint64_t generation() const noexcept { return _generation; }
+
+  // returns the translator that Slices use to translate attribute names
+  // on the current thread. this is the translator installed via an
+  // AttributeTranslatorThreadScope, or Options::Defaults.attributeTranslator
+  // if there is none
+  static AttributeTranslator* current() noexcept;
+
+  // sets the translator for the current thread and returns the previous
+  // one. nullptr makes the thread use Options::Defaults.attributeTranslator
+  static AttributeTranslator* setThreadTranslator(AttributeTranslator* translator) noexcept;
+
   // translate from string to id
   uint8_t const* translate(std::string const& key) const noexcept;
 
@@ -65,16 +92,50 @@ class AttributeTranslator {
   uint8_t const* translate(char const* key, ValueLength length) const noexcept;
 
   // translate from id to string
-  uint8_t const* translate(uint64_t id) const noexcept;
+  uint8_t const* translate(uint64_t id) const noexcept {
+    if (VELOCYPACK_LIKELY(id < _idToKey.size())) {
+      return _idToKey[id];
+    }
+    return translateSparse(id);
+  }
 
  private:
+  // slot in the open-addressing key to id table. an empty slot has
+  // id == nullptr
+  struct KeySlot {
+    uint64_t hash;
+    char const* key;
+    ValueLength length;
+    uint8_t const* id;
+  };
+
+  static uint64_t hashKey(char const* key, ValueLength length) noexcept {
+    return VELOCYPACK_HASH(key, checkOverflow(length), 0xdeadbeef);
+  }
+
+  void insertKey(char const* key, ValueLength length, uint8_t const* id);
+
+  void buildTables();
+
+  uint8_t const* translateSparse(uint64_t id) const noexcept;
+
+  static uint64_t nextGeneration() noexcept;
+
   Builder* _builder;
-  std::unordered_map<std::string, uint8_t const*> _keyToIdString;
-  std::unordered_map<StringRef, uint8_t const*> _keyToIdStringRef;
-  std::unordered_map<uint64_t, uint8_t const*> _idToKey;
+  // the Object with all attribute names and their ids
+  Slice _dictionary;
+  // key to id table with linear probing, size is a power of two
+  std::vector<KeySlot> _keyToId;
+  uint64_t _keyToIdMask;
+  // id to key, indexed by id. ids too large for the dense table are
+  // kept in _sparseIdToKey
+  std::vector<uint8_t const*> _idToKey;
+  std::unordered_map<uint64_t, uint8_t const*> _sparseIdToKey;
   size_t _count;
+  uint64_t _generation;
 };
 
+// installs a translator in Options::Defaults, i.e. for all threads
 class AttributeTranslatorScope {
  private:
   AttributeTranslatorScope(AttributeTranslatorScope const&) = delete;
@@ -99,6 +160,31 @@ class AttributeTranslatorScope {
    AttributeTranslator* _old;
 };
 
+// installs a translator for the current thread only, without modifying
+// Options::Defaults. this allows threads to decode data using different
+// translators concurrently
+class AttributeTranslatorThreadScope {
+ private:
+  AttributeTranslatorThreadScope(AttributeTranslatorThreadScope const&) = delete;
+  AttributeTranslatorThreadScope& operator= (AttributeTranslatorThreadScope const&) = delete;
+
+ public:
+  explicit AttributeTranslatorThreadScope(AttributeTranslator* translator)
+      : _old(AttributeTranslator::setThreadTranslator(translator)) {}
+
+  ~AttributeTranslatorThreadScope() {
+    revert();
+  }
+
+  // prematurely revert the change
+  void revert() {
+    AttributeTranslator::setThreadTranslator(_old);
+  }
+
+ private:
+   AttributeTranslator* _old;
+};
+
 }  // namespace arangodb::velocypack
 }  // namespace arangodb
 
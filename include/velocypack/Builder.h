@@ -121,7 +121,12 @@ class Builder {
   // at position base, also determine the length len of the attribute.
   // This takes into account the different possibilities for the format
   // of attribute names:
-  static uint8_t const* findAttrName(uint8_t const* base, uint64_t& len);
+  uint8_t const* findAttrName(uint8_t const* base, uint64_t& len) const;
+
+  // returns the String attribute name for key. translated attribute names
+  // are looked up in the translator of the Builder's options, or in
+  // AttributeTranslator::current() if the options have none
+  Slice translateKey(Slice const& key) const;
 
   void sortObjectIndexShort(uint8_t* objBase,
                             std::vector<ValueLength>& offsets) const;
@@ -132,6 +137,8 @@ class Builder {
   void sortObjectIndex(uint8_t* objBase,
                        std::vector<ValueLength>& offsets);
 
+  void sortObjectData(uint8_t* objBase, std::vector<ValueLength>& offsets);
+
  public:
   Options const* options;
 
@@ -491,6 +498,10 @@ class Builder {
   // close for the array case:
   Builder& closeArray(ValueLength tos, std::vector<ValueLength>& index);
 
+  // close for the hashed object case, returns false if the object is
+  // too big for this format:
+  bool closeHashedObject(ValueLength tos, std::vector<ValueLength>& index);
+
   void addNull() {
     appendByte(0x18);
   }
@@ -504,6 +515,10 @@ class Builder {
   }
 
   void addDouble(double v) {
+    if (VELOCYPACK_UNLIKELY(options->buildCanonical)) {
+      addCanonicalDouble(v);
+      return;
+    }
     uint64_t dv;
     ValueLength vSize = sizeof(double);
     memcpy(&dv, &v, vSize);
@@ -520,11 +535,15 @@ class Builder {
       appendByte(static_cast<uint8_t>(0x30 + v));
     } else if (v < 0 && v >= -6) {
       appendByte(static_cast<uint8_t>(0x40 + v));
+    } else if (v > 0 && options->buildCanonical) {
+      appendUInt(static_cast<uint64_t>(v), 0x27);
     } else {
       appendInt(v, 0x1f);
     }
   }
 
+  void addCanonicalDouble(double v);
+
   void addUInt(uint64_t v) {
     if (v <= 9) {
       appendByte(static_cast<uint8_t>(0x30 + v));
@@ -627,7 +646,7 @@ class Builder {
     }
 
     try {
-      if (options->attributeTranslator != nullptr) {
+      if (options->attributeTranslator != nullptr && !options->buildCanonical) {
         // check if a translation for the attribute name exists
         uint8_t const* translated =
             options->attributeTranslator->translate(attrName);
@@ -677,7 +696,7 @@ class Builder {
     }
 
     try {
-      if (options->attributeTranslator != nullptr) {
+      if (options->attributeTranslator != nullptr && !options->buildCanonical) {
         // check if a translation for the attribute name exists
         uint8_t const* translated =
             options->attributeTranslator->translate(attrName, attrLength);
@@ -750,6 +769,9 @@ class Builder {
 
   uint8_t* set(Slice const& item);
 
+  // adds a resolved, non-External Slice in canonical form
+  uint8_t* setCanonical(Slice const& item);
+
   void cleanupAdd() noexcept {
     size_t depth = _stack.size() - 1;
     VELOCYPACK_ASSERT(!_index[depth].empty());
@@ -214,6 +214,15 @@ class Collection {
   static Builder sort(
       Slice const& array,
       std::function<bool (Slice const&, Slice const&)> lessthan);
+
+  // returns the canonical form of slice (see Options::buildCanonical).
+  // two values that only differ in their physical layout have the same
+  // canonical form
+  static Builder canonicalize(Slice const& slice);
+
+  static Builder canonicalize(Slice const* slice) {
+    return canonicalize(*slice);
+  }
 };
 
 struct IsEqualPredicate {
@@ -34,7 +34,9 @@
 #include "velocypack/Slice.h"
 #include "velocypack/ValueType.h"
 
+#include <algorithm>
 #include <set>
+#include <vector>
 
 namespace arangodb {
 namespace velocypack {
@@ -70,8 +72,20 @@ static bool equalsStrings(Slice lhs, Slice rhs) {
 }
 
 static bool equals(Slice lhs, Slice rhs) {
-  lhs = lhs.resolveExternals();
-  rhs = rhs.resolveExternals();
+  uint8_t const lh = lhs.head();
+  uint8_t const rh = rhs.head();
+
+  // fast path for SmallInts and short strings, decided by the head bytes
+  // alone: such values are equal exactly if their bytes are equal
+  if (lh >= 0x30 && lh <= 0xbe && rh >= 0x30 && rh <= 0xbe) {
+    return (lh == rh &&
+            (lh < 0x40 || memcmp(lhs.start() + 1, rhs.start() + 1, lh - 0x40) == 0));
+  }
+
+  if (lh == 0x1d || rh == 0x1d) {
+    lhs = lhs.resolveExternals();
+    rhs = rhs.resolveExternals();
+  }
   ValueType lhsType = valueTypeGroup(lhs.type());
   ValueType rhsType = valueTypeGroup(rhs.type());
 
@@ -142,6 +156,325 @@ static bool equals(Slice lhs, Slice rhs) {
   }
 }
 
+// position of a value type in the sort order used by compare(). all
+// number types share the same position
+static int typeOrder(ValueType type) {
+  switch (type) {
+    case ValueType::MinKey:
+      return 0;
+    case ValueType::None:
+      return 1;
+    case ValueType::Illegal:
+      return 2;
+    case ValueType::Null:
+      return 3;
+    case ValueType::Bool:
+      return 4;
+    case ValueType::Double:
+    case ValueType::Int:
+    case ValueType::UInt:
+    case ValueType::SmallInt:
+      return 5;
+    case ValueType::UTCDate:
+      return 6;
+    case ValueType::String:
+      return 7;
+    case ValueType::Binary:
+      return 8;
+    case ValueType::BCD:
+      return 9;
+    case ValueType::Array:
+      return 10;
+    case ValueType::Object:
+      return 11;
+    case ValueType::Custom:
+      return 12;
+    case ValueType::MaxKey:
+      return 13;
+    default:
+      throw Exception(Exception::InternalError, "invalid value type for comparison");
+  }
+}
+
+template<typename T>
+static inline int compareValues(T lhs, T rhs) noexcept {
+  return (lhs < rhs) ? -1 : ((rhs < lhs) ? 1 : 0);
+}
+
+static int compareBytes(uint8_t const* lhs, ValueLength nl,
+                        uint8_t const* rhs, ValueLength nr) {
+  int res = memcmp(lhs, rhs, checkOverflow((std::min)(nl, nr)));
+  if (res != 0) {
+    return (res < 0) ? -1 : 1;
+  }
+  return compareValues(nl, nr);
+}
+
+// NaN is sorted behind all other numbers and is equal to itself
+static int compareDoubles(double lhs, double rhs) noexcept {
+  if (lhs < rhs) {
+    return -1;
+  }
+  if (rhs < lhs) {
+    return 1;
+  }
+  if (lhs == rhs) {
+    return 0;
+  }
+  return (lhs != lhs) - (rhs != rhs);
+}
+
+// exact comparison of an integer and a double, without converting the
+// integer to double first
+static int compareIntDouble(int64_t lhs, double rhs) noexcept {
+  if (rhs != rhs || rhs >= 9223372036854775808.0) {
+    return -1;
+  }
+  if (rhs < -9223372036854775808.0) {
+    return 1;
+  }
+  int64_t const truncated = static_cast<int64_t>(rhs);
+  if (lhs != truncated) {
+    return compareValues(lhs, truncated);
+  }
+  // same integral part. the fraction decides
+  return compareDoubles(0.0, rhs - static_cast<double>(truncated));
+}
+
+static int compareUIntDouble(uint64_t lhs, double rhs) noexcept {
+  if (rhs != rhs || rhs >= 18446744073709551616.0) {
+    return -1;
+  }
+  if (rhs < 0.0) {
+    return 1;
+  }
+  uint64_t const truncated = static_cast<uint64_t>(rhs);
+  if (lhs != truncated) {
+    return compareValues(lhs, truncated);
+  }
+  return compareDoubles(0.0, rhs - static_cast<double>(truncated));
+}
+
+static int compareIntUInt(int64_t lhs, uint64_t rhs) noexcept {
+  if (lhs < 0) {
+    return -1;
+  }
+  return compareValues(static_cast<uint64_t>(lhs), rhs);
+}
+
+// compares two numbers of any numeric type exactly. note that unlike
+// equalsNumbers() this does not convert integers to double, so large
+// integers compare unequal to doubles that are merely close to them.
+// this is required for compare() to be a strict weak ordering
+static int compareNumbers(Slice lhs, Slice rhs) {
+  ValueType const lhsType = lhs.type();
+  ValueType const rhsType = rhs.type();
+
+  if (lhsType == ValueType::Double) {
+    double const l = lhs.getDouble();
+    if (rhsType == ValueType::Double) {
+      return compareDoubles(l, rhs.getDouble());
+    }
+    if (rhsType == ValueType::UInt) {
+      return -compareUIntDouble(rhs.getUIntUnchecked(), l);
+    }
+    return -compareIntDouble(rhs.getIntUnchecked(), l);
+  }
+  
+  if (lhsType == ValueType::UInt) {
+    uint64_t const l = lhs.getUIntUnchecked();
+    if (rhsType == ValueType::Double) {
+      return compareUIntDouble(l, rhs.getDouble());
+    }
+    if (rhsType == ValueType::UInt) {
+      return compareValues(l, rhs.getUIntUnchecked());
+    }
+    return -compareIntUInt(rhs.getIntUnchecked(), l);
+  }
+
+  // Int or SmallInt
+  int64_t const l = lhs.getIntUnchecked();
+  if (rhsType == ValueType::Double) {
+    return compareIntDouble(l, rhs.getDouble());
+  }
+  if (rhsType == ValueType::UInt) {
+    return compareIntUInt(l, rhs.getUIntUnchecked());
+  }
+  return compareValues(l, rhs.getIntUnchecked());
+}
+
+static int compareStrings(Slice lhs, Slice rhs) {
+  ValueLength nl;
+  char const* left = lhs.getString(nl);
+  VELOCYPACK_ASSERT(left != nullptr);
+  ValueLength nr;
+  char const* right = rhs.getString(nr);
+  VELOCYPACK_ASSERT(right != nullptr);
+  return compareBytes(reinterpret_cast<uint8_t const*>(left), nl,
+                      reinterpret_cast<uint8_t const*>(right), nr);
+}
+
+// an object member, with its key resolved to a string
+struct ObjectMember {
+  char const* key;
+  ValueLength keyLength;
+  Slice value;
+
+  bool operator<(ObjectMember const& other) const {
+    return compareBytes(reinterpret_cast<uint8_t const*>(key), keyLength,
+                        reinterpret_cast<uint8_t const*>(other.key), other.keyLength) < 0;
+  }
+};
+
+// returns the members of an object, ordered by key
+static std::vector<ObjectMember> sortedMembers(Slice slice) {
+  std::vector<ObjectMember> result;
+  ObjectIterator it(slice);
+  result.reserve(checkOverflow(it.size()));
+  while (it.valid()) {
+    ObjectMember member;
+    member.key = it.key(true).getString(member.keyLength);
+    member.value = it.value();
+    result.emplace_back(member);
+    it.next();
+  }
+  // sorted objects are mostly in order already
+  if (!std::is_sorted(result.begin(), result.end())) {
+    std::sort(result.begin(), result.end());
+  }
+  return result;
+}
+
+static int compareObjects(Slice lhs, Slice rhs) {
+  // objects are compared like sorted arrays of key/value pairs. a key that
+  // is missing in one of the objects is compared as if its value was None
+  std::vector<ObjectMember> const left = sortedMembers(lhs);
+  std::vector<ObjectMember> const right = sortedMembers(rhs);
+
+  auto l = left.begin();
+  auto r = right.begin();
+  while (l != left.end() || r != right.end()) {
+    int res;
+    if (r == right.end() || (l != left.end() && *l < *r)) {
+      res = compare((*l).value, Slice::noneSlice());
+      ++l;
+    } else if (l == left.end() || *r < *l) {
+      res = compare(Slice::noneSlice(), (*r).value);
+      ++r;
+    } else {
+      res = compare((*l).value, (*r).value);
+      ++l;
+      ++r;
+    }
+    if (res != 0) {
+      return res;
+    }
+  }
+  return 0;
+}
+
+// three-way comparison of two values, using the same normalization as
+// equals(): numbers of all types are compared by their numeric values,
+// the key order of objects does not matter, and Externals are resolved.
+// values of different type groups are ordered by typeOrder(). returns a
+// negative value if lhs < rhs, 0 if both are equal, and a positive value
+// if lhs > rhs
+static int compare(Slice lhs, Slice rhs) {
+  uint8_t lh = lhs.head();
+  uint8_t rh = rhs.head();
+
+  // fast paths for SmallInts and short strings
+  if (lh >= 0x30 && lh <= 0x3f && rh >= 0x30 && rh <= 0x3f) {
+    // 0x30 - 0x39 are 0 to 9, 0x3a - 0x3f are -6 to -1
+    return compareValues(static_cast<int>(lh) - (lh >= 0x3a ? 0x40 : 0x30),
+                         static_cast<int>(rh) - (rh >= 0x3a ? 0x40 : 0x30));
+  }
+  if (lh >= 0x40 && lh <= 0xbe && rh >= 0x40 && rh <= 0xbe) {
+    return compareBytes(lhs.start() + 1, lh - 0x40, rhs.start() + 1, rh - 0x40);
+  }
+
+  if (lh == 0x1d || rh == 0x1d) {
+    lhs = lhs.resolveExternals();
+    rhs = rhs.resolveExternals();
+    lh = lhs.head();
+    rh = rhs.head();
+  }
+
+  ValueType const lhsType = lhs.type();
+  ValueType const rhsType = rhs.type();
+  int const lhsOrder = typeOrder(lhsType);
+  int const rhsOrder = typeOrder(rhsType);
+  if (lhsOrder != rhsOrder) {
+    return (lhsOrder < rhsOrder) ? -1 : 1;
+  }
+
+  switch (lhsType) {
+    case ValueType::Illegal:
+    case ValueType::None:
+    case ValueType::Null:
+    case ValueType::MinKey:
+    case ValueType::MaxKey: {
+      return 0;
+    }
+    case ValueType::Bool: {
+      return compareValues(lhs.getBoolean(), rhs.getBoolean());
+    }
+    case ValueType::Double:
+    case ValueType::Int:
+    case ValueType::UInt:
+    case ValueType::SmallInt: {
+      return compareNumbers(lhs, rhs);
+    }
+    case ValueType::UTCDate: {
+      return compareValues(lhs.getUTCDate(), rhs.getUTCDate());
+    }
+    case ValueType::String: {
+      return compareStrings(lhs, rhs);
+    }
+    case ValueType::Binary: {
+      ValueLength nl;
+      uint8_t const* left = lhs.getBinary(nl);
+      ValueLength nr;
+      uint8_t const* right = rhs.getBinary(nr);
+      return compareBytes(left, nl, right, nr);
+    }
+    case ValueType::Array: {
+      ArrayIterator lhsValue(lhs);
+      ArrayIterator rhsValue(rhs);
+
+      while (lhsValue.valid() && rhsValue.valid()) {
+        // recurse
+        int res = compare(lhsValue.value(), rhsValue.value());
+        if (res != 0) {
+          return res;
+        }
+        lhsValue.next();
+        rhsValue.next();
+      }
+      // the shorter array is a prefix of the longer one
+      return compareValues(lhsValue.size(), rhsValue.size());
+    }
+    case ValueType::Object: {
+      return compareObjects(lhs, rhs);
+    }
+    case ValueType::BCD:
+    case ValueType::Custom: {
+      throw Exception(Exception::NotImplemented, "compare for BCD and Custom types is not implemented");
+    }
+    default: {
+      throw Exception(Exception::InternalError, "invalid value type for comparison");
+    }
+  }
+}
+
+};
+
+// ordering predicate based on NormalizedCompare::compare(), for use with
+// std::sort and ordered containers
+struct NormalizedLess {
+  bool operator()(Slice const& lhs, Slice const& rhs) const {
+    return NormalizedCompare::compare(lhs, rhs) < 0;
+  }
 };
 
 }
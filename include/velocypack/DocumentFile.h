@@ -0,0 +1,146 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef VELOCYPACK_DOCUMENTFILE_H
+#define VELOCYPACK_DOCUMENTFILE_H 1
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Slice.h"
+
+namespace arangodb {
+namespace velocypack {
+struct Sink;
+
+// container for many VPack documents with random access by ordinal. a
+// document file consists of a header, the documents stored back to back
+// and a trailing table with the offsets of the documents (all integers
+// little endian):
+//
+//   offset      size  content
+//        0         4  magic bytes "VPKF"
+//        4         4  format version
+//        8         d  n VPack documents
+//    8 + d     8 * n  offsets of the documents from the start of the file
+//   end - 16       8  number n of documents
+//   end - 8        8  offset 8 + d of the offset table
+//
+// document files are memory-mapped when opened, so documents can be
+// accessed as Slices pointing into the mapping without reading, copying
+// or parsing the file first
+class DocumentFile {
+ public:
+  // expected access pattern, passed as hint to the operating system
+  enum AccessPattern {
+    NormalAccess,
+    SequentialAccess,
+    RandomAccess
+  };
+
+  static uint32_t const Version;
+  static ValueLength const HeaderSize;
+  static ValueLength const FooterSize;
+
+  DocumentFile(DocumentFile const&) = delete;
+  DocumentFile& operator=(DocumentFile const&) = delete;
+
+  // maps the document file filename into memory
+  explicit DocumentFile(std::string const& filename,
+                        AccessPattern pattern = RandomAccess);
+
+  // uses the serialized document file in data without copying it. data
+  // must stay valid as long as the DocumentFile is used
+  DocumentFile(uint8_t const* data, ValueLength length);
+
+  ~DocumentFile();
+
+  // returns the number of documents
+  ValueLength size() const noexcept { return _size; }
+
+  // returns the document with the given index. only the framing of the
+  // document is checked, use a Validator to check its contents.
+  // the Slice can be used as long as the DocumentFile exists. for a
+  // DocumentFile owned by a shared_ptr file, SharedSlice(file, file->at(i))
+  // keeps the file mapped as long as the document is used
+  Slice at(ValueLength index) const;
+
+  Slice operator[](ValueLength index) const { return at(index); }
+
+  // passes a new access pattern hint for the mapped file to the operating
+  // system. does nothing if the file is not memory-mapped
+  void advise(AccessPattern pattern) const;
+
+ private:
+  void load(uint8_t const* data, ValueLength length);
+
+  ValueLength offset(ValueLength index) const noexcept {
+    return readIntegerFixed<ValueLength, 8>(_data + _tableOffset + 8 * index);
+  }
+
+  // copy of the file if it is not memory-mapped
+  std::string _buffer;
+  void* _mapping;
+  size_t _mappingSize;
+  uint8_t const* _data;
+  ValueLength _tableOffset;
+  ValueLength _size;
+};
+
+// writes VPack documents into a Sink in the format read by DocumentFile
+class DocumentFileWriter {
+ public:
+  DocumentFileWriter(DocumentFileWriter const&) = delete;
+  DocumentFileWriter& operator=(DocumentFileWriter const&) = delete;
+
+  // writes the header into sink, which must stay valid until finish()
+  // was called
+  explicit DocumentFileWriter(Sink* sink);
+
+  ~DocumentFileWriter() = default;
+
+  // appends a copy of document and returns its index
+  ValueLength add(Slice document);
+
+  // writes the offset table. no documents can be added afterwards
+  void finish();
+
+  // returns the number of documents added so far
+  ValueLength size() const noexcept { return _offsets.size(); }
+
+ private:
+  Sink* _sink;
+  std::vector<ValueLength> _offsets;
+  ValueLength _position;
+  bool _finished;
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
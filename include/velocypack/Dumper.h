@@ -27,7 +27,9 @@
 #ifndef VELOCYPACK_DUMPER_H
 #define VELOCYPACK_DUMPER_H 1
 
+#include <cstring>
 #include <string>
+#include <vector>
 
 #include "velocypack/velocypack-common.h"
 #include "velocypack/Exception.h"
@@ -38,7 +40,10 @@
 namespace arangodb {
 namespace velocypack {
 
-// Dumps VPack into a JSON output string
+// Dumps VPack into a JSON output string. the output is collected in a
+// local buffer and handed over to the sink in large blocks, so the sink's
+// virtual methods are not called for every single character. all public
+// methods flush the buffer before they return
 class Dumper {
  public:
   Options const* options;
@@ -47,7 +52,20 @@ class Dumper {
   Dumper& operator=(Dumper const&) = delete;
 
   Dumper(Sink* sink, Options const* options = &Options::Defaults)
-      : options(options), _sink(sink), _indentation(0) {
+      : options(options),
+        _sink(sink),
+        _pos(_buffer),
+        _indentation(0),
+        _written(0),
+        _maxBytes(0),
+        _maxDepth(UINT64_MAX),
+        _maxElements(UINT64_MAX),
+        _depth(0),
+        _active(false),
+        _keyTranslator(nullptr),
+        _keyGeneration(0),
+        _keyEscapeForwardSlashes(false),
+        _keyEscapeUnicode(false) {
     if (sink == nullptr) {
       throw Exception(Exception::InternalError, "Sink cannot be a nullptr");
     }
@@ -62,8 +80,12 @@ class Dumper {
 
   void dump(Slice const& slice) {
     _indentation = 0;
-    _sink->reserve(slice.byteSize());
-    dumpValue(&slice);
+    ValueLength size = slice.byteSize();
+    if (options->dumpMaxBytes != 0 && options->dumpMaxBytes < size) {
+      size = options->dumpMaxBytes;
+    }
+    _sink->reserve(size);
+    dumpTopLevel(&slice);
   }
 
   void dump(Slice const* slice) { dump(*slice); }
@@ -79,6 +101,17 @@ class Dumper {
     dump(*slice, sink, options);
   }
 
+  // dumps slice like dump(), with the same output. the members of a large
+  // top-level Array are dumped in chunks by up to concurrency threads (0
+  // means one per hardware thread), and the chunks are appended to the
+  // sink in order by the calling thread. values that are not Arrays, small
+  // Arrays and dumps with output limits (Options::dumpMaxBytes etc.) are
+  // dumped on the calling thread only. a custom type handler must be
+  // thread-safe, and is passed a Dumper writing to a per-chunk sink
+  static void dumpParallel(Slice const& slice, Sink* sink,
+                           Options const* options = &Options::Defaults,
+                           size_t concurrency = 0);
+
   static std::string toString(Slice const& slice,
                               Options const* options = &Options::Defaults) {
     std::string buffer;
@@ -92,55 +125,171 @@ class Dumper {
     return toString(*slice, options);
   }
 
-  void append(Slice const& slice) { dumpValue(&slice); }
+  void append(Slice const& slice) { dumpTopLevel(&slice); }
 
-  void append(Slice const* slice) { dumpValue(slice); }
+  void append(Slice const* slice) { dumpTopLevel(slice); }
 
   void appendString(char const* src, ValueLength len) {
-    _sink->reserve(2 + len);
-    _sink->push_back('"');
+    put('"');
     dumpString(src, len);
-    _sink->push_back('"');
+    put('"');
+    flush();
   }
 
   void appendString(std::string const& str) {
-    _sink->reserve(2 + str.size());
-    _sink->push_back('"');
-    dumpString(str.data(), str.size());
-    _sink->push_back('"');
+    appendString(str.data(), str.size());
   }
 
-  void appendUInt(uint64_t);
+  void appendUInt(uint64_t v) {
+    dumpUInt(v);
+    flush();
+  }
 
-  void appendDouble(double);
+  void appendDouble(double v) {
+    dumpDouble(v);
+    flush();
+  }
 
  private:
-  void dumpUnicodeCharacter(uint16_t value);
+  // makes room for at least n bytes in the local buffer, so that they can
+  // be stored without further checks. n must not exceed BufferSize
+  void ensure(size_t n) {
+    if (static_cast<size_t>((_buffer + BufferSize) - _pos) < n) {
+      flush();
+    }
+  }
+
+  void put(char c) {
+    ensure(1);
+    *_pos++ = c;
+  }
+
+  void put(char const* p, size_t len) {
+    if (static_cast<size_t>((_buffer + BufferSize) - _pos) < len) {
+      flush();
+      if (len >= BufferSize / 2) {
+        // large blocks go to the sink directly
+        emit(p, len);
+        return;
+      }
+    }
+    memcpy(_pos, p, len);
+    _pos += len;
+  }
+
+  void flush() {
+    if (_pos != _buffer) {
+      emit(_buffer, static_cast<size_t>(_pos - _buffer));
+      _pos = _buffer;
+    }
+  }
+
+  // hands a block of output over to the sink. when the output size is
+  // limited, only the part up to the limit is passed on
+  void emit(char const* p, size_t len) {
+    ValueLength const offset = _written;
+    _written += len;
+    if (_maxBytes != 0 && _written > _maxBytes) {
+      if (offset >= _maxBytes) {
+        return;
+      }
+      len = cutOutput(p, static_cast<size_t>(_maxBytes - offset));
+    }
+    if (len > 0) {
+      _sink->append(p, len);
+    }
+  }
+
+  // number of bytes produced by the current dump, including the bytes
+  // that were cut off by dumpMaxBytes
+  ValueLength outputSize() const {
+    return _written + static_cast<ValueLength>(_pos - _buffer);
+  }
+
+  // whether the output has reached dumpMaxBytes, so that the rest of the
+  // value can be skipped
+  bool truncated() const {
+    return (_maxBytes != 0 && outputSize() >= _maxBytes);
+  }
+
+  static size_t cutOutput(char const*, size_t);
+
+  void dumpTopLevel(Slice const*);
 
-  void dumpInteger(Slice const*);
+  // sets up the limits and the key cache for a new top-level dump
+  void beginDump();
+
+  void dumpElided(ValueLength);
+
+  void dumpUInt(uint64_t);
+
+  void dumpDouble(double);
+
+  void dumpUnicodeCharacter(uint16_t value);
 
   void dumpString(char const*, ValueLength);
 
+  void dumpArray(Slice const*);
+
+  // dumps the members from to to of an Array, starting with the one at p,
+  // including the separators between them
+  void dumpArrayMembers(Slice const*, uint8_t const* p, ValueLength from,
+                        ValueLength to);
+
+  void dumpObject(Slice const*);
+
+  void dumpKey(Slice const&);
+
+  void checkKeyCache();
+
   inline void dumpValue(Slice const& slice, Slice const* base = nullptr) {
     dumpValue(&slice, base);
   }
 
-  void dumpValue(Slice const*, Slice const* = nullptr);
+  // dispatches on the head byte with a single table lookup, instead of
+  // mapping the head byte to a ValueType first and switching on that
+  inline void dumpValue(Slice const* slice, Slice const* base = nullptr) {
+    (this->*ValueHandlers[slice->head()])(slice,
+                                          (base == nullptr) ? slice : base);
+  }
+
+  // handlers for the values with a given head byte. the second argument
+  // is the base value passed on to custom type handlers
+  void dumpNullValue(Slice const*, Slice const*);
+  void dumpFalseValue(Slice const*, Slice const*);
+  void dumpTrueValue(Slice const*, Slice const*);
+  void dumpArrayValue(Slice const*, Slice const*);
+  void dumpObjectValue(Slice const*, Slice const*);
+  void dumpDoubleValue(Slice const*, Slice const*);
+  void dumpIntValue(Slice const*, Slice const*);
+  void dumpUIntValue(Slice const*, Slice const*);
+  void dumpSmallIntValue(Slice const*, Slice const*);
+  void dumpShortStringValue(Slice const*, Slice const*);
+  void dumpLongStringValue(Slice const*, Slice const*);
+  void dumpExternalValue(Slice const*, Slice const*);
+  void dumpUnsupportedValue(Slice const*, Slice const*);
+  void dumpBCDValue(Slice const*, Slice const*);
+  void dumpCustomValue(Slice const*, Slice const*);
+
+  typedef void (Dumper::*ValueHandler)(Slice const*, Slice const*);
+
+  // the handler for each head byte
+  static ValueHandler const ValueHandlers[256];
 
   void indent() {
     size_t n = _indentation;
-    _sink->reserve(2 * n);
     for (size_t i = 0; i < n; ++i) {
-      _sink->append("  ", 2);
+      put("  ", 2);
     }
   }
 
   void handleUnsupportedType(Slice const* slice) {
     if (options->unsupportedTypeBehavior == Options::NullifyUnsupportedType) {
-      _sink->append("null", 4);
+      put("null", 4);
       return;
     } else if (options->unsupportedTypeBehavior == Options::ConvertUnsupportedType) {
-      _sink->append(std::string("\"(non-representable type ") + slice->typeName() + ")\"");
+      std::string const value = std::string("\"(non-representable type ") + slice->typeName() + ")\"";
+      put(value.data(), value.size());
       return;
     }
 
@@ -148,9 +297,49 @@ class Dumper {
   }
 
  private:
+  static size_t const BufferSize = 4096;
+
   Sink* _sink;
 
+  char* _pos;
+
   int _indentation;
+
+  // bytes handed over to the sink by the current dump, including the
+  // bytes that were cut off
+  ValueLength _written;
+
+  // limits of the current dump, see Options::dumpMaxBytes etc. 0 means
+  // unlimited for _maxBytes, UINT64_MAX for the others
+  ValueLength _maxBytes;
+  ValueLength _maxDepth;
+  ValueLength _maxElements;
+
+  // nesting depth of the Array or Object currently dumped
+  ValueLength _depth;
+
+  // whether a dump is in progress. custom type handlers may append values
+  // while their value is dumped
+  bool _active;
+
+  // JSON strings of translated attribute names, escaped according to the
+  // options, so that a translated key is dumped with a single copy. the
+  // strings are stored in _keyData, _keys is indexed by attribute id and
+  // holds their offsets and lengths (0 if not yet cached). the cache is
+  // dropped when the translator (or its generation) or the escape options
+  // change
+  struct CachedKey {
+    uint32_t offset;
+    uint32_t length;
+  };
+  std::vector<CachedKey> _keys;
+  std::string _keyData;
+  AttributeTranslator const* _keyTranslator;
+  uint64_t _keyGeneration;
+  bool _keyEscapeForwardSlashes;
+  bool _keyEscapeUnicode;
+
+  char _buffer[BufferSize];
 };
 
 }  // namespace arangodb::velocypack
@@ -42,6 +42,7 @@ struct Exception : std::exception {
   enum ExceptionType {
     InternalError = 1,
     NotImplemented = 2,
+    IOError = 3,
 
     NoJsonEquivalent = 10,
     ParseError = 11,
@@ -56,6 +57,8 @@ struct Exception : std::exception {
     NeedAttributeTranslator = 20,
     CannotTranslateKey = 21,
     KeyNotFound = 22, // not used anymore
+    InvalidKeyDictionary = 23,
+    InvalidDocumentFile = 24,
 
     BuilderNotSealed = 30,
     BuilderNeedOpenObject = 31,
@@ -70,6 +73,7 @@ struct Exception : std::exception {
 
     ValidatorInvalidLength = 50,
     ValidatorInvalidType = 51,
+    ValidatorNestingTooDeep = 52,
 
     UnknownError = 999
   };
@@ -96,6 +100,8 @@ struct Exception : std::exception {
         return "Internal error";
       case NotImplemented:
         return "Not implemented";
+      case IOError:
+        return "I/O error";
       case NoJsonEquivalent:
         return "Type has no equivalent in JSON";
       case ParseError:
@@ -122,6 +128,10 @@ struct Exception : std::exception {
         return "Cannot translate key";
       case KeyNotFound:
         return "Key not found";
+      case InvalidKeyDictionary:
+        return "Invalid key dictionary";
+      case InvalidDocumentFile:
+        return "Invalid document file";
       case BuilderNotSealed:
         return "Builder value not yet sealed";
       case BuilderNeedOpenObject:
@@ -147,6 +157,8 @@ struct Exception : std::exception {
         return "Invalid type found in binary data";
       case ValidatorInvalidLength:
         return "Invalid length found in binary data";
+      case ValidatorNestingTooDeep:
+        return "Arrays or Objects nested too deeply in binary data";
 
       case UnknownError:
       default:
@@ -0,0 +1,94 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef VELOCYPACK_KEYDICTIONARY_H
+#define VELOCYPACK_KEYDICTIONARY_H 1
+
+#include <cstdint>
+#include <string>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/AttributeTranslator.h"
+
+namespace arangodb {
+namespace velocypack {
+
+// persistent key dictionary for an AttributeTranslator, so that data built
+// with translated attribute names can be decoded later on. a dictionary
+// consists of a header and the VPack Object that maps attribute names to
+// their ids (all integers little endian):
+//
+//   offset  size  content
+//        0     4  magic bytes "VPKD"
+//        4     4  format version
+//        8     8  byte size n of the VPack Object
+//       16     4  CRC-32 of the VPack Object
+//       20     4  reserved, always 0
+//       24     n  VPack Object
+//
+// dictionary files are memory-mapped when loaded, so no copying or parsing
+// is needed to use them
+class KeyDictionary {
+ public:
+  static uint32_t const Version;
+  static ValueLength const HeaderSize;
+
+  KeyDictionary(KeyDictionary const&) = delete;
+  KeyDictionary& operator=(KeyDictionary const&) = delete;
+
+  // maps the dictionary file filename into memory
+  explicit KeyDictionary(std::string const& filename);
+
+  // uses a copy of the serialized dictionary in data
+  KeyDictionary(uint8_t const* data, ValueLength length);
+
+  ~KeyDictionary();
+
+  // returns the translator for the dictionary. it can be used as long as
+  // the KeyDictionary exists
+  AttributeTranslator* translator() noexcept { return &_translator; }
+
+  // returns the serialized form of the dictionary of a sealed translator
+  static std::string serialize(AttributeTranslator const& translator);
+
+  // writes the dictionary of a sealed translator into file filename
+  static void save(AttributeTranslator const& translator,
+                   std::string const& filename);
+
+ private:
+  void load(uint8_t const* data, ValueLength length);
+
+  // copy of the dictionary if it is not memory-mapped
+  std::string _buffer;
+  void* _mapping;
+  size_t _mappingSize;
+  AttributeTranslator _translator;
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
@@ -0,0 +1,79 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef VELOCYPACK_KEYENCODER_H
+#define VELOCYPACK_KEYENCODER_H 1
+
+#include <string>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Builder.h"
+#include "velocypack/Slice.h"
+
+namespace arangodb {
+namespace velocypack {
+
+// converts Slices into byte strings whose memcmp() order is the same as
+// the order defined by NormalizedCompare::compare(), so that they can be
+// used as keys in ordered key-value stores without a custom comparator.
+// two values produce the same encoding if and only if compare() considers
+// them equal. the encoding is prefix-free, so encoded values can be
+// concatenated to build compound keys
+//
+// decoding produces a value that is equal to the original one under
+// NormalizedCompare, but not necessarily the same VPack: numbers are
+// decoded as integers if they have an integral value that fits into an
+// int64_t or uint64_t, and as doubles otherwise. Externals are resolved
+// when encoding, and object attributes are decoded in sorted order
+class KeyEncoder {
+ public:
+  KeyEncoder() = delete;
+  KeyEncoder(KeyEncoder const&) = delete;
+  KeyEncoder& operator=(KeyEncoder const&) = delete;
+
+  // appends the encoded form of slice to result
+  static void encode(Slice const& slice, std::string& result);
+
+  static std::string encode(Slice const& slice) {
+    std::string result;
+    encode(slice, result);
+    return result;
+  }
+
+  // decodes a single value starting at start and adds it to builder.
+  // returns the number of bytes consumed
+  static ValueLength decode(uint8_t const* start, ValueLength length,
+                            Builder& builder);
+
+  // decodes a key that contains exactly one encoded value
+  static Builder decode(std::string const& key,
+                        Options const* options = &Options::Defaults);
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
@@ -0,0 +1,109 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef VELOCYPACK_KEYLEARNER_H
+#define VELOCYPACK_KEYLEARNER_H 1
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/AttributeTranslator.h"
+
+namespace arangodb {
+namespace velocypack {
+
+// learns a key dictionary while parsing. when set in Options::keyLearner,
+// the Parser reports all attribute names it cannot translate yet. their
+// frequencies are estimated with a count-min sketch, and names that reach
+// the threshold are assigned the next free id (starting at 1) in a new
+// translator epoch. ids are never changed or reused, so the translator of
+// any later epoch can decode everything built with an earlier one.
+// the sketch counters are halved periodically, so that names which were
+// frequent only for a while do not accumulate until they pass the
+// threshold eventually. all methods are thread-safe
+class KeyLearner {
+ public:
+  KeyLearner(KeyLearner const&) = delete;
+  KeyLearner& operator=(KeyLearner const&) = delete;
+
+  // threshold: number of (estimated) occurrences after which an attribute
+  // name is added to the dictionary. maxKeys: maximum number of keys in
+  // the dictionary. minKeyLength: shorter attribute names are not added,
+  // as their ids would not be smaller than the names themselves
+  explicit KeyLearner(uint32_t threshold = 64, size_t maxKeys = 1024,
+                      ValueLength minKeyLength = 3);
+
+  ~KeyLearner() = default;
+
+  // records an occurrence of the attribute name key that is not contained
+  // in the current translator
+  void observe(char const* key, ValueLength length);
+
+  // returns the translator of the current epoch. it is never a nullptr,
+  // and it stays valid as long as it is referenced, even if later epochs
+  // have been created in the meantime
+  std::shared_ptr<AttributeTranslator> translator() const;
+
+  // returns the current epoch. it is increased whenever a key is added
+  uint64_t epoch() const noexcept {
+    return _epoch.load(std::memory_order_acquire);
+  }
+
+  // returns the number of keys in the current translator
+  size_t count() const;
+
+ private:
+  static constexpr int Depth = 4;
+  static constexpr uint64_t Width = 4096;
+
+  void promote(char const* key, ValueLength length);
+
+  void age();
+
+  uint32_t const _threshold;
+  size_t const _maxKeys;
+  ValueLength const _minKeyLength;
+
+  // count-min sketch with Depth rows of Width counters each
+  std::vector<std::atomic<uint32_t>> _counters;
+  // number of observations since the counters were last halved
+  std::atomic<uint64_t> _observations;
+  std::atomic<uint64_t> _epoch;
+  std::atomic<bool> _full;
+
+  // protects everything below and the halving of counters
+  mutable std::mutex _lock;
+  std::shared_ptr<AttributeTranslator> _translator;
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
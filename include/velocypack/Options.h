@@ -37,6 +37,7 @@ namespace arangodb {
 namespace velocypack {
 class AttributeTranslator;
 class Dumper;
+class KeyLearner;
 struct Options;
 class Slice;
 
@@ -66,17 +67,37 @@ struct Options {
     FailOnUnsupportedType
   };
 
+  enum DoubleFormat {
+    ShortestDoubleFormat,
+    FpconvDoubleFormat
+  };
+
   Options() {}
 
   // Dumper behavior when a VPack value is serialized to JSON that
   // has no JSON equivalent
   UnsupportedTypeBehavior unsupportedTypeBehavior = FailOnUnsupportedType;
 
+  // how the Dumper prints doubles: ShortestDoubleFormat always produces
+  // the fewest digits that convert back to the same double (Schubfach),
+  // FpconvDoubleFormat produces the output of older versions (Grisu2),
+  // which in rare cases has more digits than necessary
+  DoubleFormat doubleFormat = ShortestDoubleFormat;
+
   // callback for excluding attributes from being built by the Parser
   AttributeExcludeHandler* attributeExcludeHandler = nullptr;
 
+  // translator for attribute names used by Builder and Parser. Slices
+  // translate attribute names via AttributeTranslator::current(), which
+  // uses the translator of Options::Defaults unless a different one was
+  // installed for the current thread
   AttributeTranslator* attributeTranslator = nullptr;
 
+  // learns a key dictionary from the attribute names seen by the Parser
+  // and translates them according to it. ignored if attributeTranslator
+  // is set
+  KeyLearner* keyLearner = nullptr;
+
   // custom type handler used for processing custom types by Dumper and Slicer
   CustomTypeHandler* customTypeHandler = nullptr;
 
@@ -86,9 +107,48 @@ struct Options {
   // allow building Objects without index table?
   bool buildUnindexedObjects = false;
 
+  // build Objects with at least hashedObjectMinLength members with an
+  // additional hash table, for faster attribute lookups in very wide
+  // Objects
+  bool buildHashedObjects = false;
+  ValueLength hashedObjectMinLength = 1024;
+
+  // build values in canonical form, so that values which are equal under
+  // NormalizedCompare have the same byte representation. this implies a
+  // fixed layout for Arrays and Objects (buildUnindexedArrays,
+  // buildUnindexedObjects and buildHashedObjects are ignored), Object
+  // members stored in key order, attribute names not being translated,
+  // Externals being inlined and numbers using their shortest integer
+  // representation where possible (non-negative integers as UInt and
+  // integral doubles as integers)
+  bool buildCanonical = false;
+
   // pretty-print JSON output when dumping with Dumper
   bool prettyPrint = false;
 
+  // dump Object attributes in index order, i.e. sorted by attribute name
+  // for Objects with a sorted index table. when false, the Dumper walks
+  // Objects in storage order, which is faster for large Objects. storage
+  // order is the order in which the attributes were added to the Builder
+  // (or appeared in the JSON input of the Parser), unless the Object was
+  // built with buildCanonical, which stores attributes sorted
+  bool dumpAttributesInIndexOrder = true;
+
+  // limits for the output of the Dumper, e.g. for logging large values.
+  // 0 means unlimited. the work done is proportional to the size of the
+  // output, not of the value
+  // - output is cut off after dumpMaxBytes bytes (at the start of a UTF-8
+  //   sequence), followed by "...". output produced by a custom type
+  //   handler directly in the sink is not counted
+  // - Arrays and Objects nested more than dumpMaxDepth levels deep are
+  //   dumped as [...] and {...}
+  // - only the first dumpMaxElements members of an Array or Object are
+  //   dumped, followed by ...(n more)
+  // the output is not valid JSON when one of the limits is hit
+  ValueLength dumpMaxBytes = 0;
+  ValueLength dumpMaxDepth = 0;
+  ValueLength dumpMaxElements = 0;
+
   // keep top-level object/array open when building objects with the Parser
   bool keepTopLevelOpen = false;
 
@@ -111,6 +171,11 @@ struct Options {
   // with a Dumper (creates \uxxxx sequences)
   bool escapeUnicode = false;
 
+  // maximum nesting depth of Arrays and Objects accepted by the Validator.
+  // 0 means unlimited. should be set when validating untrusted data, as
+  // validation recurses into nested values
+  ValueLength validateMaxDepth = 0;
+
   // disallow using type External (to prevent injection of arbitrary pointer
   // values as a security precaution)
   bool disallowExternals = false;
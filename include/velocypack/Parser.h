@@ -85,6 +85,9 @@ class Parser {
   size_t _size;
   size_t _pos;
   int _nesting;
+  // snapshot of the translator of options->keyLearner
+  std::shared_ptr<AttributeTranslator> _learnedTranslator;
+  uint64_t _learnedEpoch;
 
  public:
   Options const* options;
@@ -96,7 +99,7 @@ class Parser {
   ~Parser() = default;
 
   explicit Parser(Options const* options = &Options::Defaults)
-      : _start(nullptr), _size(0), _pos(0), _nesting(0), options(options) {
+      : _start(nullptr), _size(0), _pos(0), _nesting(0), _learnedEpoch(0), options(options) {
     if (options == nullptr) {
       throw Exception(Exception::InternalError, "Options cannot be a nullptr");
     }
@@ -107,7 +110,7 @@ class Parser {
 
   explicit Parser(std::shared_ptr<Builder>& builder,
                   Options const* options = &Options::Defaults)
-      : _builder(builder), _builderPtr(_builder.get()), _start(nullptr), _size(0), _pos(0), _nesting(0),
+      : _builder(builder), _builderPtr(_builder.get()), _start(nullptr), _size(0), _pos(0), _nesting(0), _learnedEpoch(0),
          options(options) {
     if (options == nullptr) {
       throw Exception(Exception::InternalError, "Options cannot be a nullptr");
@@ -117,7 +120,7 @@ class Parser {
   // This method produces a parser that does not own the builder
   explicit Parser(Builder& builder,
                   Options const* options = &Options::Defaults)
-      : _start(nullptr), _size(0), _pos(0), _nesting(0),
+      : _start(nullptr), _size(0), _pos(0), _nesting(0), _learnedEpoch(0),
          options(options) {
     if (options == nullptr) {
       throw Exception(Exception::InternalError, "Options cannot be a nullptr");
@@ -297,6 +300,10 @@ class Parser {
 
   void parseObject();
 
+  void learnKey(ValueLength keyPos);
+
+  void refreshLearnedKeys();
+
   void parseJson();
 };
 
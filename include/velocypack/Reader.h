@@ -0,0 +1,102 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef VELOCYPACK_READER_H
+#define VELOCYPACK_READER_H 1
+
+#include <cstdint>
+#include <iosfwd>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Buffer.h"
+
+namespace arangodb {
+namespace velocypack {
+class Slice;
+class Validator;
+
+// reads a sequence of VPack values stored back to back, e.g. in a dump
+// file, from a file descriptor or a std::istream. the input is read into
+// a reusable buffer in large blocks and split into values by their byte
+// sizes, so every value is copied only once and memory usage does not
+// depend on the size of the input: the buffer only grows beyond its
+// initial size if a single value does not fit into it.
+//
+// the Slices returned by next() point into the buffer. a Slice stays valid
+// until next() is called again, which may refill the buffer
+class Reader {
+ public:
+  static ValueLength const DefaultBufferSize;
+
+  Reader(Reader const&) = delete;
+  Reader& operator=(Reader const&) = delete;
+
+  // reads from the file descriptor fd, which is not closed by the Reader.
+  // if validator is not a nullptr, each value is validated with it before
+  // it is returned
+  explicit Reader(int fd, Validator const* validator = nullptr,
+                  ValueLength bufferSize = DefaultBufferSize);
+
+  // reads from the stream in
+  explicit Reader(std::istream& in, Validator const* validator = nullptr,
+                  ValueLength bufferSize = DefaultBufferSize);
+
+  ~Reader() = default;
+
+  // stores the next value of the input in slice and returns true, or
+  // returns false at the end of the input. throws if reading fails, if
+  // the input ends in the middle of a value or if a value is invalid
+  bool next(Slice& slice);
+
+  // returns the offset of the value last returned by next() in the input
+  uint64_t position() const noexcept { return _position; }
+
+ private:
+  // moves the bytes not yet returned to the start of the buffer, grows it
+  // if a value of needed bytes does not fit into it and reads more input
+  // behind them
+  void refill(ValueLength needed);
+
+  // reads up to length bytes of input into dst and returns their number,
+  // 0 meaning the end of the input
+  size_t read(uint8_t* dst, size_t length);
+
+  int const _fd;
+  std::istream* const _in;
+  Validator const* const _validator;
+  Buffer<uint8_t> _buffer;
+  // start of the bytes in _buffer not yet returned by next()
+  ValueLength _offset;
+  // offset of the start of _buffer in the input
+  uint64_t _bufferPosition;
+  uint64_t _position;
+  bool _eof;
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
@@ -0,0 +1,127 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef VELOCYPACK_SHAREDSLICE_H
+#define VELOCYPACK_SHAREDSLICE_H 1
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Buffer.h"
+#include "velocypack/Builder.h"
+#include "velocypack/Slice.h"
+
+namespace arangodb {
+namespace velocypack {
+
+// a Slice that keeps the memory it points into alive. the memory is owned
+// by a reference-counted owner, e.g. the Buffer of a Builder, so copying a
+// SharedSlice is cheap (an atomic increment) and never copies the VPack
+// value. SharedSlices of sub values returned by at(), get() etc. share the
+// owner of their parent, so a nested value can be handed out without
+// copying it and without the caller keeping the parent around.
+// values that are not stored in the owner's memory, i.e. the targets of
+// External values and keys translated by an AttributeTranslator, are not
+// kept alive
+class SharedSlice {
+ public:
+  // a None value without owner
+  SharedSlice() noexcept = default;
+
+  // the value slice, which is kept alive by owner
+  SharedSlice(std::shared_ptr<void const> const& owner, Slice slice) noexcept
+      : _start(owner, slice.start()) {}
+
+  // the value in buffer, e.g. from Builder::steal()
+  explicit SharedSlice(std::shared_ptr<Buffer<uint8_t>> const& buffer) noexcept
+      : _start(buffer, buffer->data()) {}
+
+  // the value of a sealed Builder, e.g. from Parser::fromJson(). the
+  // Builder must not be modified afterwards
+  explicit SharedSlice(std::shared_ptr<Builder> const& builder)
+      : _start(builder, builder->slice().start()) {}
+
+  // copies slice into a new buffer owned by the SharedSlice
+  static SharedSlice copy(Slice slice) {
+    ValueLength const length = slice.byteSize();
+    std::shared_ptr<uint8_t> data(new uint8_t[checkOverflow(length)],
+                                  std::default_delete<uint8_t[]>());
+    memcpy(data.get(), slice.start(), checkOverflow(length));
+    return SharedSlice(data, Slice(data.get()));
+  }
+
+  Slice slice() const noexcept {
+    if (_start == nullptr) {
+      return Slice();
+    }
+    return Slice(_start.get());
+  }
+
+  uint8_t const* start() const noexcept { return slice().start(); }
+
+  ValueLength byteSize() const { return slice().byteSize(); }
+
+  // returns value, which must point into the memory of this SharedSlice,
+  // as SharedSlice with the same owner
+  SharedSlice share(Slice value) const noexcept {
+    SharedSlice result;
+    result._start = std::shared_ptr<uint8_t const>(_start, value.start());
+    return result;
+  }
+
+  SharedSlice at(ValueLength index) const { return share(slice().at(index)); }
+
+  SharedSlice keyAt(ValueLength index, bool translate = true) const {
+    return share(slice().keyAt(index, translate));
+  }
+
+  SharedSlice valueAt(ValueLength index) const {
+    return share(slice().valueAt(index));
+  }
+
+  template <typename T>
+  SharedSlice get(T const& attribute) const {
+    return share(slice().get(attribute));
+  }
+
+  SharedSlice operator[](std::string const& attribute) const {
+    return get(attribute);
+  }
+
+  // returns the number of SharedSlices (and other shared_ptrs) sharing
+  // the owner, 0 if there is no owner
+  long useCount() const noexcept { return _start.use_count(); }
+
+ private:
+  std::shared_ptr<uint8_t const> _start;
+};
+
+}  // namespace arangodb::velocypack
+}  // namespace arangodb
+
+#endif
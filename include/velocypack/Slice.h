@@ -35,6 +35,7 @@
 #include <algorithm>
 #include <functional>
 #include <type_traits>
+#include <utility>
 
 #include "velocypack/velocypack-common.h"
 #include "velocypack/Exception.h"
@@ -48,11 +49,15 @@
 #endif
 #endif
 
+// VELOCYPACK_HASH_ID identifies the hash function. it is stored in
+// Objects with a hash table (type 0x15)
+
 #ifdef VELOCYPACK_XXHASH
 // forward for XXH64 function declared elsewhere
 extern "C" unsigned long long XXH64(void const*, size_t, unsigned long long);
 
 #define VELOCYPACK_HASH(mem, size, seed) XXH64(mem, size, seed)
+#define VELOCYPACK_HASH_ID 1
 #endif
 
 #ifdef VELOCYPACK_FASTHASH
@@ -60,6 +65,7 @@ extern "C" unsigned long long XXH64(void const*, size_t, unsigned long long);
 uint64_t fasthash64(void const*, size_t, uint64_t);
 
 #define VELOCYPACK_HASH(mem, size, seed) fasthash64(mem, size, seed)
+#define VELOCYPACK_HASH_ID 2
 #endif
 
 namespace arangodb {
@@ -69,6 +75,8 @@ class SliceScope;
 
 struct SliceStaticData {
   static uint8_t const FixedTypeLengths[256];
+  static uint8_t const LengthFieldWidths[256];
+  static uint8_t const LengthFieldBases[256];
   static ValueType const TypeMap[256];
   static unsigned int const WidthMap[32];
   static unsigned int const FirstSubMap[32];
@@ -191,9 +199,16 @@ class Slice {
 
   // hashes the value, normalizing different representations of
   // arrays, objects and numbers. this function may produce different
-  // hash values than the binary hash() function
+  // hash values than the binary hash() function. the result does not
+  // depend on the order of object keys, and is the same for all builds
+  // of the library regardless of the hash function it uses
   uint64_t normalizedHash(uint64_t seed = defaultSeed) const;
 
+  // 128 bit variant of normalizedHash(), for use cases that need a
+  // lower collision probability. returns (high, low), where low is the
+  // same as the result of normalizedHash()
+  std::pair<uint64_t, uint64_t> normalizedHash128(uint64_t seed = defaultSeed) const;
+
   // hashes the binary representation of a String slice. No check
   // is done if the Slice value is actually of type String
   inline uint64_t hashString(uint64_t seed = defaultSeed) const noexcept {
@@ -318,7 +333,7 @@ class Slice {
 
   bool isSorted() const noexcept {
     auto const h = head();
-    return (h >= 0x0b && h <= 0x0e);
+    return ((h >= 0x0b && h <= 0x0e) || h == 0x15);
   }
 
   // return the value for a Bool object
@@ -426,6 +441,8 @@ class Slice {
   // attribute name
   // - 0x12      : object with 8-byte index table entries, not sorted by
   // attribute name
+  // - 0x15      : object with hash table and 4-byte index table entries,
+  // sorted by attribute name
   Slice keyAt(ValueLength index, bool translate = true) const {
     if (!isObject()) {
       throw Exception(Exception::InvalidValueType, "Expecting type Object");
@@ -764,94 +781,29 @@ class Slice {
       return l;
     }
 
-    // types with dynamic lengths need special treatment:
-    switch (type(h)) {
-      case ValueType::Array:
-      case ValueType::Object: {
-        if (h == 0x13 || h == 0x14) {
-          // compact Array or Object
-          return readVariableValueLength<false>(_start + 1);
-        }
-
-        VELOCYPACK_ASSERT(h > 0x01 && h <= 0x0e && h != 0x0a);
-        if (h >= sizeof(SliceStaticData::WidthMap) / sizeof(SliceStaticData::WidthMap[0])) {
-          throw Exception(Exception::InternalError, "invalid Array/Object type");
-        }
-        return readIntegerNonEmpty<ValueLength>(_start + 1,
-                                                SliceStaticData::WidthMap[h]);
-      }
-
-      case ValueType::String: {
-        VELOCYPACK_ASSERT(h == 0xbf);
-
-        if (h < 0xbf) {
-          // we cannot get here, because the FixedTypeLengths lookup
-          // above will have kicked in already. however, the compiler
-          // claims we'll be reading across the bounds of the input
-          // here...
-          return h - 0x40;
-        }
-        
-        // long UTF-8 String
-        return static_cast<ValueLength>(
-            1 + 8 + readIntegerFixed<ValueLength, 8>(_start + 1));
+    // types with a length field of 1 to 8 bytes after the head byte:
+    // Arrays, Objects, long Strings, Binary, BCD and Custom types
+    unsigned int const width = SliceStaticData::LengthFieldWidths[h];
+    if (VELOCYPACK_LIKELY(width != 0)) {
+      l = static_cast<ValueLength>(SliceStaticData::LengthFieldBases[h]);
+      switch (width) {
+        case 1:
+          return l + readIntegerFixed<ValueLength, 1>(_start + 1);
+        case 2:
+          return l + readIntegerFixed<ValueLength, 2>(_start + 1);
+        case 4:
+          return l + readIntegerFixed<ValueLength, 4>(_start + 1);
+        case 8:
+          return l + readIntegerFixed<ValueLength, 8>(_start + 1);
+        default:
+          // Binary and BCD lengths of 3, 5, 6 or 7 bytes
+          return l + readIntegerNonEmpty<ValueLength>(_start + 1, width);
       }
+    }
 
-      case ValueType::Binary: {
-        VELOCYPACK_ASSERT(h >= 0xc0 && h <= 0xc7);
-        return static_cast<ValueLength>(
-            1 + h - 0xbf + readIntegerNonEmpty<ValueLength>(_start + 1, h - 0xbf));
-      }
-
-      case ValueType::BCD: {
-        if (h <= 0xcf) {
-          // positive BCD
-          VELOCYPACK_ASSERT(h >= 0xc8 && h < 0xcf);
-          return static_cast<ValueLength>(
-              1 + h - 0xc7 + readIntegerNonEmpty<ValueLength>(_start + 1, h - 0xc7));
-        }
-
-        // negative BCD
-        VELOCYPACK_ASSERT(h >= 0xd0 && h < 0xd7);
-        return static_cast<ValueLength>(
-            1 + h - 0xcf + readIntegerNonEmpty<ValueLength>(_start + 1, h - 0xcf));
-      }
-
-      case ValueType::Custom: {
-        VELOCYPACK_ASSERT(h >= 0xf4);
-        switch (h) {
-          case 0xf4: 
-          case 0xf5: 
-          case 0xf6: {
-            return 2 + readIntegerFixed<ValueLength, 1>(_start + 1);
-          }
-
-          case 0xf7: 
-          case 0xf8: 
-          case 0xf9:  {
-            return 3 + readIntegerFixed<ValueLength, 2>(_start + 1);
-          }
-          
-          case 0xfa: 
-          case 0xfb: 
-          case 0xfc: {
-            return 5 + readIntegerFixed<ValueLength, 4>(_start + 1);
-          }
-          
-          case 0xfd: 
-          case 0xfe: 
-          case 0xff: {
-            return 9 + readIntegerFixed<ValueLength, 8>(_start + 1);
-          }
-
-          default: {
-            // fallthrough intentional
-          }
-        }
-      }
-      default: {
-        // fallthrough intentional
-      }
+    if (h == 0x13 || h == 0x14) {
+      // compact Array or Object
+      return readVariableValueLength<false>(_start + 1);
     }
 
     throw Exception(Exception::InternalError, "Invalid type for byteSize()");
@@ -859,9 +811,13 @@ class Slice {
   
   ValueLength findDataOffset(uint8_t head) const noexcept {
     // Must be called for a non-empty array or object at start():
-    VELOCYPACK_ASSERT(head != 0x01 && head != 0x0a && head <= 0x14);
+    VELOCYPACK_ASSERT(head != 0x01 && head != 0x0a && head <= 0x15);
     unsigned int fsm = SliceStaticData::FirstSubMap[head];
     if (fsm == 0) {
+      if (head == 0x15) {
+        // sub values start behind the hash table
+        return 11 + (ValueLength(8) << _start[10]);
+      }
       // need to calculate the offset by reading the dynamic length
       VELOCYPACK_ASSERT(head == 0x13 || head == 0x14);
       return 1 + arangodb::velocypack::getVariableValueLength(readVariableValueLength<false>(_start + 1));
@@ -948,8 +904,13 @@ class Slice {
   // translates an integer key into a string, without checks
   Slice translateUnchecked() const;
 
+  // translates an integer key into a string using translator, without checks
+  Slice translateUnchecked(AttributeTranslator const* translator) const;
+
   Slice getFromCompactObject(std::string const& attribute) const;
 
+  Slice getFromHashedObject(std::string const& attribute) const;
+
   // extract the nth member from an Array
   Slice getNth(ValueLength index) const;
 
@@ -967,7 +928,7 @@ class Slice {
   ValueLength getNthOffsetFromCompact(ValueLength index) const;
 
   inline ValueLength indexEntrySize(uint8_t head) const noexcept {
-    VELOCYPACK_ASSERT(head > 0x00 && head <= 0x12);
+    VELOCYPACK_ASSERT(head > 0x00 && (head <= 0x12 || head == 0x15));
     return static_cast<ValueLength>(SliceStaticData::WidthMap[head]);
   }
 
@@ -979,6 +940,11 @@ class Slice {
   template<ValueLength offsetSize>
   Slice searchObjectKeyBinary(std::string const& attribute, ValueLength ieBase, ValueLength n) const;
 
+  // perform a branch-free binary search for the specified attribute inside
+  // an Object with 1- or 2-byte offsets
+  template<ValueLength offsetSize>
+  Slice searchObjectKeyBranchless(std::string const& attribute, ValueLength ieBase, ValueLength n) const;
+
 // assert that the slice is of a specific type
 // can be used for debugging and removed in production
 #ifdef VELOCYPACK_ASSERT
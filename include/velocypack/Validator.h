@@ -36,6 +36,12 @@ class Slice;
 
 class Validator {
   // This class can validate a binary VelocyPack value.
+  // A full validation checks the complete structure of the value in a
+  // single pass over its bytes: all length fields, paddings and index
+  // table entries, key types, the encodings of compact Arrays and Objects
+  // and, depending on the options, UTF-8 strings and the nesting depth.
+  // After it succeeds, the value can be accessed with Slice, ArrayIterator
+  // and ObjectIterator without reading outside of the validated bytes.
 
  public:
   explicit Validator(Options const* options = &Options::Defaults)
@@ -58,17 +64,45 @@ class Validator {
   // throws if the data is invalid
   bool validate(uint8_t const* ptr, size_t length, bool isSubPart = false) const;
 
+  // validates a VelocyPack Slice value like validate(). the members of a
+  // large Array or Object with index table (or with members of equal size)
+  // are validated in chunks by up to concurrency threads, 0 meaning one per
+  // hardware thread. other values are validated on the calling thread only.
+  // throws if the data is invalid
+  bool validateParallel(char const* ptr, size_t length, bool isSubPart = false,
+                        size_t concurrency = 0) const {
+    return validateParallel(reinterpret_cast<uint8_t const*>(ptr), length,
+                            isSubPart, concurrency);
+  }
+
+  bool validateParallel(uint8_t const* ptr, size_t length, bool isSubPart = false,
+                        size_t concurrency = 0) const;
+
+  // validates only the framing of a VelocyPack Slice value starting at ptr,
+  // i.e. that its head byte is valid and that its byteSize fits the length
+  // bytes available. Arrays and Objects are not looked into, so this is only
+  // sufficient for data from a trusted source. throws if the data is invalid
+  bool validateFraming(char const* ptr, size_t length, bool isSubPart = false) const {
+    return validateFraming(reinterpret_cast<uint8_t const*>(ptr), length, isSubPart);
+  }
+
+  bool validateFraming(uint8_t const* ptr, size_t length, bool isSubPart = false) const;
+
  private:
-  void validateArray(uint8_t const* ptr, size_t length) const;
-  void validateCompactArray(uint8_t const* ptr, size_t length) const;
-  void validateUnindexedArray(uint8_t const* ptr, size_t length) const;
-  void validateIndexedArray(uint8_t const* ptr, size_t length) const;
-  void validateObject(uint8_t const* ptr, size_t length) const;
-  void validateCompactObject(uint8_t const* ptr, size_t length) const;
-  void validateIndexedObject(uint8_t const* ptr, size_t length) const;
+  ValueLength validateValue(uint8_t const* ptr, size_t length, ValueLength depth) const;
+  ValueLength readByteSize(uint8_t const* ptr, size_t length) const;
+  void validateArray(uint8_t const* ptr, ValueLength byteSize, ValueLength depth) const;
+  void validateCompactArray(uint8_t const* ptr, ValueLength byteSize, ValueLength depth) const;
+  void validateUnindexedArray(uint8_t const* ptr, ValueLength byteSize, ValueLength depth) const;
+  void validateIndexedArray(uint8_t const* ptr, ValueLength byteSize, ValueLength depth) const;
+  void validateObject(uint8_t const* ptr, ValueLength byteSize, ValueLength depth) const;
+  void validateCompactObject(uint8_t const* ptr, ValueLength byteSize, ValueLength depth) const;
+  void validateIndexedObject(uint8_t const* ptr, ValueLength byteSize, ValueLength depth) const;
+  void validateHashedObject(uint8_t const* ptr, ValueLength byteSize, ValueLength depth) const;
+  void validateObjectMembers(uint8_t const* ptr, ValueLength dataOffset,
+                             ValueLength dataEnd, ValueLength nrItems,
+                             ValueLength width, ValueLength depth) const;
   void validateBufferLength(size_t expected, size_t actual, bool isSubPart) const;
-  void validateSliceLength(uint8_t const* ptr, size_t length, bool isSubPart) const;
-  ValueLength readByteSize(uint8_t const*& ptr, uint8_t const* end) const;
 
  public:
   Options const* options;
@@ -64,6 +64,7 @@ using VPackBuilderContainer = arangodb::velocypack::BuilderContainer;
 #ifndef VELOCYPACK_ALIAS_COMPARE
 #define VELOCYPACK_ALIAS_COMPARE
 using VPackNormalizedCompare = arangodb::velocypack::NormalizedCompare;
+using VPackNormalizedLess = arangodb::velocypack::NormalizedLess;
 #endif
 #endif
 
@@ -75,6 +76,13 @@ template<typename T> using VPackBuffer = arangodb::velocypack::Buffer<T>;
 #endif
 #endif
 
+#ifdef VELOCYPACK_SHAREDSLICE_H
+#ifndef VELOCYPACK_ALIAS_SHAREDSLICE
+#define VELOCYPACK_ALIAS_SHAREDSLICE
+using VPackSharedSlice = arangodb::velocypack::SharedSlice;
+#endif
+#endif
+
 #ifdef VELOCYPACK_SINK_H
 #ifndef VELOCYPACK_ALIAS_SINK
 #define VELOCYPACK_ALIAS_SINK
@@ -92,6 +100,27 @@ using VPackCollection = arangodb::velocypack::Collection;
 #endif
 #endif
 
+#ifdef VELOCYPACK_KEYENCODER_H
+#ifndef VELOCYPACK_ALIAS_KEYENCODER
+#define VELOCYPACK_ALIAS_KEYENCODER
+using VPackKeyEncoder = arangodb::velocypack::KeyEncoder;
+#endif
+#endif
+
+#ifdef VELOCYPACK_KEYDICTIONARY_H
+#ifndef VELOCYPACK_ALIAS_KEYDICTIONARY
+#define VELOCYPACK_ALIAS_KEYDICTIONARY
+using VPackKeyDictionary = arangodb::velocypack::KeyDictionary;
+#endif
+#endif
+
+#ifdef VELOCYPACK_KEYLEARNER_H
+#ifndef VELOCYPACK_ALIAS_KEYLEARNER
+#define VELOCYPACK_ALIAS_KEYLEARNER
+using VPackKeyLearner = arangodb::velocypack::KeyLearner;
+#endif
+#endif
+
 #ifdef VELOCYPACK_ATTRIBUTETRANSLATOR_H
 #ifndef VELOCYPACK_ALIAS_ATTRIBUTETRANSLATOR
 #define VELOCYPACK_ALIAS_ATTRIBUTETRANSLATOR
@@ -106,6 +135,14 @@ using VPackTopLevelAttributeExcludeHandler = arangodb::velocypack::TopLevelAttri
 #endif
 #endif
 
+#ifdef VELOCYPACK_DOCUMENTFILE_H
+#ifndef VELOCYPACK_ALIAS_DOCUMENTFILE
+#define VELOCYPACK_ALIAS_DOCUMENTFILE
+using VPackDocumentFile = arangodb::velocypack::DocumentFile;
+using VPackDocumentFileWriter = arangodb::velocypack::DocumentFileWriter;
+#endif
+#endif
+
 #ifdef VELOCYPACK_DUMPER_H
 #ifndef VELOCYPACK_ALIAS_DUMPER
 #define VELOCYPACK_ALIAS_DUMPER
@@ -144,6 +181,13 @@ using VPackParser = arangodb::velocypack::Parser;
 #endif
 #endif
 
+#ifdef VELOCYPACK_READER_H
+#ifndef VELOCYPACK_ALIAS_READER
+#define VELOCYPACK_ALIAS_READER
+using VPackReader = arangodb::velocypack::Reader;
+#endif
+#endif
+
 #ifdef VELOCYPACK_SLICE_H
 #ifndef VELOCYPACK_ALIAS_SLICE
 #define VELOCYPACK_ALIAS_SLICE
@@ -32,12 +32,18 @@
 #include "velocypack/Buffer.h"
 #include "velocypack/Builder.h"
 #include "velocypack/Collection.h"
+#include "velocypack/DocumentFile.h"
 #include "velocypack/Dumper.h"
 #include "velocypack/Exception.h"
 #include "velocypack/HexDump.h"
 #include "velocypack/Iterator.h"
+#include "velocypack/KeyDictionary.h"
+#include "velocypack/KeyEncoder.h"
+#include "velocypack/KeyLearner.h"
 #include "velocypack/Options.h"
 #include "velocypack/Parser.h"
+#include "velocypack/Reader.h"
+#include "velocypack/SharedSlice.h"
 #include "velocypack/Sink.h"
 #include "velocypack/Slice.h"
 #include "velocypack/SliceContainer.h"
@@ -24,6 +24,9 @@
 /// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <atomic>
+#include <cstring>
+
 #include "velocypack/velocypack-common.h"
 #include "velocypack/AttributeTranslator.h"
 #include "velocypack/Builder.h"
@@ -33,6 +36,30 @@
 
 using namespace arangodb::velocypack;
 
+// translator installed for the current thread, overrides the default one
+static thread_local AttributeTranslator* threadTranslator = nullptr;
+
+// source of AttributeTranslator::generation()
+static std::atomic<uint64_t> lastGeneration(0);
+
+uint64_t AttributeTranslator::nextGeneration() noexcept {
+  return ++lastGeneration;
+}
+
+AttributeTranslator* AttributeTranslator::current() noexcept {
+  AttributeTranslator* translator = threadTranslator;
+  if (translator != nullptr) {
+    return translator;
+  }
+  return Options::Defaults.attributeTranslator;
+}
+
+AttributeTranslator* AttributeTranslator::setThreadTranslator(AttributeTranslator* translator) noexcept {
+  AttributeTranslator* old = threadTranslator;
+  threadTranslator = translator;
+  return old;
+}
+
 AttributeTranslator::~AttributeTranslator() {
   delete _builder;
 }
@@ -53,55 +80,131 @@ void AttributeTranslator::seal() {
   }
 
   _builder->close();
+  _dictionary = _builder->slice();
+  buildTables();
+}
+
+void AttributeTranslator::load(Slice const& dictionary) {
+  if (_builder != nullptr || !_dictionary.isNone()) {
+    throw Exception(Exception::InternalError,
+                    "Cannot load dictionary into non-empty translator");
+  }
+  if (!dictionary.isObject()) {
+    throw Exception(Exception::InvalidKeyDictionary,
+                    "Key dictionary must be an Object");
+  }
+  _dictionary = dictionary;
+  try {
+    buildTables();
+  } catch (...) {
+    _dictionary = Slice();
+    _keyToId.clear();
+    _idToKey.clear();
+    _sparseIdToKey.clear();
+    throw;
+  }
+  _count = checkOverflow(dictionary.length());
+}
+
+void AttributeTranslator::buildTables() {
+  _generation = nextGeneration();
+  Slice s(_dictionary);
+  ValueLength const n = s.length();
+
+  // size the key table for a load factor of at most 50%
+  size_t capacity = 16;
+  while (capacity < 2 * n) {
+    capacity <<= 1;
+  }
+  _keyToId.assign(capacity, KeySlot{0, nullptr, 0, nullptr});
+  _keyToIdMask = capacity - 1;
 
-  Slice s(_builder->slice());
+  // ids are expected to be small and dense, so ids up to a multiple of the
+  // number of keys are looked up in a plain array
+  uint64_t const denseLimit = 2 * n + 256;
+  _idToKey.clear();
+  _sparseIdToKey.clear();
 
   ObjectIterator it(s);
 
   while (it.valid()) {
     Slice const key(it.key(false));
-    VELOCYPACK_ASSERT(key.isString());
+    Slice const value(it.value());
+    if (!key.isString() ||
+        !(value.isUInt() || (value.isSmallInt() && value.getSmallInt() >= 0))) {
+      throw Exception(Exception::InvalidKeyDictionary,
+                      "Key dictionary must map Strings to unsigned ids");
+    }
 
     // extract key value
     ValueLength len;
     char const* p = key.getString(len);
-    // insert into string and char lookup maps
-    _keyToIdString.emplace(key.copyString(), it.value().begin());
-    _keyToIdStringRef.emplace(StringRef(p, len), it.value().begin());
-    // insert into id to slice lookup map
-    _idToKey.emplace(it.value().getUInt(), key.begin());
+    insertKey(p, len, value.begin());
+
+    // insert into id to slice lookup table
+    uint64_t const id = value.getUInt();
+    if (id < denseLimit) {
+      if (id >= _idToKey.size()) {
+        _idToKey.resize(id + 1, nullptr);
+      }
+      if (_idToKey[id] == nullptr) {
+        _idToKey[id] = key.begin();
+      }
+    } else {
+      _sparseIdToKey.emplace(id, key.begin());
+    }
     it.next();
   }
 }
 
-// translate from string to id
-uint8_t const* AttributeTranslator::translate(std::string const& key) const noexcept {
-  auto it = _keyToIdString.find(key);
-
-  if (it == _keyToIdString.end()) {
-    return nullptr;
+void AttributeTranslator::insertKey(char const* key, ValueLength length,
+                                    uint8_t const* id) {
+  uint64_t const hash = hashKey(key, length);
+  uint64_t i = hash & _keyToIdMask;
+  while (_keyToId[i].id != nullptr) {
+    KeySlot const& slot = _keyToId[i];
+    if (slot.hash == hash && slot.length == length &&
+        memcmp(slot.key, key, checkOverflow(length)) == 0) {
+      // keep the first id for duplicate keys
+      return;
+    }
+    i = (i + 1) & _keyToIdMask;
   }
+  _keyToId[i] = KeySlot{hash, key, length, id};
+}
 
-  return (*it).second;
+// translate from string to id
+uint8_t const* AttributeTranslator::translate(std::string const& key) const noexcept {
+  return translate(key.data(), key.size());
 }
 
 // translate from string to id
 uint8_t const* AttributeTranslator::translate(char const* key,
                                               ValueLength length) const noexcept {
-  auto it = _keyToIdStringRef.find(StringRef(key, length));
-
-  if (it == _keyToIdStringRef.end()) {
+  if (_keyToId.empty()) {
     return nullptr;
   }
 
-  return (*it).second;
+  uint64_t const hash = hashKey(key, length);
+  uint64_t i = hash & _keyToIdMask;
+  while (true) {
+    KeySlot const& slot = _keyToId[i];
+    if (slot.id == nullptr) {
+      return nullptr;
+    }
+    if (slot.hash == hash && slot.length == length &&
+        memcmp(slot.key, key, checkOverflow(length)) == 0) {
+      return slot.id;
+    }
+    i = (i + 1) & _keyToIdMask;
+  }
 }
 
-// translate from id to string
-uint8_t const* AttributeTranslator::translate(uint64_t id) const noexcept {
-  auto it = _idToKey.find(id);
+// translate from id to string, for ids outside of the dense table
+uint8_t const* AttributeTranslator::translateSparse(uint64_t id) const noexcept {
+  auto it = _sparseIdToKey.find(id);
 
-  if (it == _idToKey.end()) {
+  if (it == _sparseIdToKey.end()) {
     return nullptr;
   }
 
@@ -68,7 +68,7 @@ void Builder::doActualSort(std::vector<SortEntry>& entries) {
   });
 };
 
-uint8_t const* Builder::findAttrName(uint8_t const* base, uint64_t& len) {
+uint8_t const* Builder::findAttrName(uint8_t const* base, uint64_t& len) const {
   uint8_t const b = *base;
   if (b >= 0x40 && b <= 0xbe) {
     // short UTF-8 string
@@ -86,7 +86,20 @@ uint8_t const* Builder::findAttrName(uint8_t const* base, uint64_t& len) {
   }
 
   // translate attribute name
-  return findAttrName(Slice(base).makeKey().start(), len);
+  return findAttrName(translateKey(Slice(base)).start(), len);
+}
+
+Slice Builder::translateKey(Slice const& key) const {
+  if (options->attributeTranslator != nullptr &&
+      (key.isSmallInt() || key.isUInt())) {
+    uint8_t const* result =
+        options->attributeTranslator->translate(key.getUIntUnchecked());
+    if (result != nullptr) {
+      return Slice(result);
+    }
+    return Slice();
+  }
+  return key.makeKey();
 }
 
 void Builder::sortObjectIndexShort(uint8_t* objBase,
@@ -143,6 +156,31 @@ void Builder::sortObjectIndex(uint8_t* objBase,
   }
 }
 
+// moves the members of an Object into the order of its sorted index
+// table, so that the result does not depend on the order in which the
+// members were added
+void Builder::sortObjectData(uint8_t* objBase,
+                             std::vector<ValueLength>& offsets) {
+  if (std::is_sorted(offsets.begin(), offsets.end())) {
+    // members were added in key order already
+    return;
+  }
+
+  ValueLength const dataStart =
+      *std::min_element(offsets.begin(), offsets.end());
+  std::vector<uint8_t> data;
+  for (auto& it : offsets) {
+    Slice key(objBase + it);
+    ValueLength const keyLength = key.byteSize();
+    ValueLength const length =
+        keyLength + Slice(key.start() + keyLength).byteSize();
+    ValueLength const newOffset = dataStart + data.size();
+    data.insert(data.end(), key.start(), key.start() + length);
+    it = newOffset;
+  }
+  memcpy(objBase + dataStart, data.data(), data.size());
+}
+
 void Builder::removeLast() {
   if (_stack.empty()) {
     throw Exception(Exception::BuilderNeedOpenCompound);
@@ -357,6 +395,104 @@ Builder& Builder::closeArray(ValueLength tos, std::vector<ValueLength>& index) {
   return *this;
 }
 
+bool Builder::closeHashedObject(ValueLength tos,
+                                std::vector<ValueLength>& index) {
+  // Layout of an Object with hash table (type 0x15):
+  //   0x15
+  //   BYTELENGTH, 4 bytes
+  //   NRITEMS, 4 bytes
+  //   hash function id, 1 byte
+  //   log2 of the number of hash table slots, 1 byte
+  //   hash table, 8 bytes per slot: upper 32 bits of the key's hash and
+  //   offset of the key (0 = empty slot)
+  //   sub VPack values as pairs of attribute and value
+  //   INDEXTABLE with 4-byte offsets, sorted by attribute name
+  ValueLength const n = index.size();
+
+  // keep the load factor at or below 0.5
+  uint8_t slotBits = 1;
+  while ((ValueLength(1) << slotBits) < 2 * n) {
+    ++slotBits;
+  }
+  ValueLength const slots = ValueLength(1) << slotBits;
+  ValueLength const dataOffset = 11 + 8 * slots;
+  VELOCYPACK_ASSERT(dataOffset > 9);
+  ValueLength const diff = dataOffset - 9;
+  ValueLength const dataLength = _pos - (tos + 9);
+
+  if (dataOffset + dataLength + 4 * n > 0xffffffffu) {
+    // offsets do not fit into 4 bytes
+    return false;
+  }
+
+  // make room for the hash table
+  reserve(diff + 4 * n);
+  if (dataLength > 0) {
+    memmove(_start + tos + dataOffset, _start + tos + 9,
+            checkOverflow(dataLength));
+  }
+  advance(diff);
+  for (auto& it : index) {
+    it += diff;
+  }
+
+  uint8_t* objBase = _start + tos;
+  sortObjectIndex(objBase, index);
+
+  // fill the hash table
+  uint8_t* table = objBase + 11;
+  memset(table, 0, checkOverflow(8 * slots));
+  ValueLength const mask = slots - 1;
+  for (auto const& it : index) {
+    uint64_t nameSize;
+    uint8_t const* name = findAttrName(objBase + it, nameSize);
+    uint64_t const hash =
+        VELOCYPACK_HASH(name, checkOverflow(nameSize), Slice::defaultSeed);
+    ValueLength slot = hash & mask;
+    while (readIntegerFixed<ValueLength, 4>(table + slot * 8 + 4) != 0) {
+      slot = (slot + 1) & mask;
+    }
+    uint64_t x = (hash >> 32) | (static_cast<uint64_t>(it) << 32);
+    for (size_t j = 0; j < 8; ++j) {
+      table[slot * 8 + j] = x & 0xff;
+      x >>= 8;
+    }
+  }
+
+  // index table
+  ValueLength const tableBase = _pos;
+  advance(4 * n);
+  for (size_t i = 0; i < n; ++i) {
+    uint64_t x = index[i];
+    for (size_t j = 0; j < 4; ++j) {
+      _start[tableBase + 4 * i + j] = x & 0xff;
+      x >>= 8;
+    }
+  }
+
+  // header
+  _start[tos] = 0x15;
+  ValueLength x = _pos - tos;
+  for (unsigned int i = 1; i <= 4; i++) {
+    _start[tos + i] = x & 0xff;
+    x >>= 8;
+  }
+  x = n;
+  for (unsigned int i = 5; i <= 8; i++) {
+    _start[tos + i] = x & 0xff;
+    x >>= 8;
+  }
+  _start[tos + 9] = VELOCYPACK_HASH_ID;
+  _start[tos + 10] = slotBits;
+
+  if (options->checkAttributeUniqueness && n > 1) {
+    checkAttributeUniqueness(Slice(_start + tos));
+  }
+
+  _stack.pop_back();
+  return true;
+}
+
 Builder& Builder::close() {
   if (VELOCYPACK_UNLIKELY(isClosed())) {
     throw Exception(Exception::BuilderNeedOpenCompound);
@@ -378,10 +514,18 @@ Builder& Builder::close() {
   // From now on index.size() > 0
   VELOCYPACK_ASSERT(index.size() > 0);
 
-  // check if we can use the compact Array / Object format
-  if (head == 0x13 || head == 0x14 ||
-      (head == 0x06 && options->buildUnindexedArrays) ||
-      (head == 0x0b && (options->buildUnindexedObjects || index.size() == 1))) {
+  // check if we can use the compact Array / Object format. canonical
+  // values only use it for Objects with a single member, like the default
+  // options do
+  bool useCompact;
+  if (VELOCYPACK_UNLIKELY(options->buildCanonical)) {
+    useCompact = (!isArray && index.size() == 1);
+  } else {
+    useCompact = (head == 0x13 || head == 0x14 ||
+                  (head == 0x06 && options->buildUnindexedArrays) ||
+                  (head == 0x0b && (options->buildUnindexedObjects || index.size() == 1)));
+  }
+  if (useCompact) {
     if (closeCompactArrayOrObject(tos, isArray, index)) {
       return *this;
     }
@@ -393,6 +537,15 @@ Builder& Builder::close() {
     return *this;
   }
 
+  if (options->buildHashedObjects && !options->buildCanonical &&
+      index.size() >= options->hashedObjectMinLength &&
+      index.size() > 1) {
+    if (closeHashedObject(tos, index)) {
+      return *this;
+    }
+    // fall through to a regular Object if the hash table did not fit
+  }
+
   // fix head byte in case a compact Array / Object was originally requested
   _start[tos] = 0x0b;
 
@@ -436,6 +589,9 @@ Builder& Builder::close() {
   // Object
   if (index.size() >= 2) {
     sortObjectIndex(_start + tos, index);
+    if (VELOCYPACK_UNLIKELY(options->buildCanonical)) {
+      sortObjectData(_start + tos, index);
+    }
   }
   for (size_t i = 0; i < index.size(); ++i) {
     uint64_t x = index[i];
@@ -499,7 +655,7 @@ bool Builder::hasKey(std::string const& key) const {
   }
   for (size_t i = 0; i < index.size(); ++i) {
     Slice s(_start + tos + index[i]);
-    if (s.makeKey().isEqualString(key)) {
+    if (translateKey(s).isEqualString(key)) {
       return true;
     }
   }
@@ -521,7 +677,7 @@ Slice Builder::getKey(std::string const& key) const {
   }
   for (size_t i = 0; i < index.size(); ++i) {
     Slice s(_start + tos + index[i]);
-    if (s.makeKey().isEqualString(key)) {
+    if (translateKey(s).isEqualString(key)) {
       return Slice(s.start() + s.byteSize());
     }
   }
@@ -573,6 +729,10 @@ uint8_t* Builder::set(Value const& item) {
           throw Exception(Exception::BuilderUnexpectedValue,
                           "Must give number for ValueType::Double");
       }
+      if (VELOCYPACK_UNLIKELY(options->buildCanonical)) {
+        addCanonicalDouble(v);
+        break;
+      }
       reserve(1 + sizeof(double));
       appendByteUnchecked(0x1b);
       memcpy(&x, &v, sizeof(double));
@@ -589,6 +749,11 @@ uint8_t* Builder::set(Value const& item) {
         throw Exception(Exception::BuilderUnexpectedValue,
                         "Must give void pointer for ValueType::External");
       }
+      if (VELOCYPACK_UNLIKELY(options->buildCanonical)) {
+        // inline the referenced value
+        return setCanonical(
+            Slice(static_cast<uint8_t const*>(item.getExternal())).resolveExternals());
+      }
       reserve(1 + sizeof(void*));
       // store pointer. this doesn't need to be portable
       appendByteUnchecked(0x1d);
@@ -787,6 +952,16 @@ uint8_t* Builder::set(Value const& item) {
 }
 
 uint8_t* Builder::set(Slice const& item) {
+  if (VELOCYPACK_UNLIKELY(options->buildCanonical)) {
+    Slice value = item.resolveExternals();
+    if (!_keyWritten && !value.isString() && isOpenObject()) {
+      // expand translated attribute names
+      value = translateKey(value);
+    }
+    checkKeyIsString(value.isString());
+    return setCanonical(value);
+  }
+
   checkKeyIsString(item.isString());
 
   ValueLength const l = item.byteSize();
@@ -796,6 +971,113 @@ uint8_t* Builder::set(Slice const& item) {
   return _start + _pos - l;
 }
 
+uint8_t* Builder::setCanonical(Slice const& item) {
+  VELOCYPACK_ASSERT(!item.isExternal());
+  auto const oldPos = _pos;
+
+  switch (item.type()) {
+    case ValueType::Int:
+    case ValueType::SmallInt: {
+      addInt(item.getIntUnchecked());
+      break;
+    }
+    case ValueType::UInt: {
+      addUInt(item.getUIntUnchecked());
+      break;
+    }
+    case ValueType::Double: {
+      addCanonicalDouble(item.getDouble());
+      break;
+    }
+    case ValueType::String: {
+      ValueLength length;
+      char const* p = item.getStringUnchecked(length);
+      if (item.head() == 0xbf && length <= 126) {
+        // long string format used for a short string
+        reserve(1 + length);
+        appendByteUnchecked(static_cast<uint8_t>(0x40 + length));
+        memcpy(_start + _pos, p, checkOverflow(length));
+        advance(length);
+      } else {
+        ValueLength const l = item.byteSize();
+        reserve(l);
+        memcpy(_start + _pos, item.start(), checkOverflow(l));
+        advance(l);
+      }
+      break;
+    }
+    case ValueType::Binary: {
+      // use the smallest possible length field
+      ValueLength length;
+      uint8_t const* p = item.getBinary(length);
+      reserve(9 + length);
+      appendUInt(length, 0xbf);
+      memcpy(_start + _pos, p, checkOverflow(length));
+      advance(length);
+      break;
+    }
+    case ValueType::Array: {
+      addCompoundValue(0x06);
+      ArrayIterator it(item);
+      while (it.valid()) {
+        add(it.value());
+        it.next();
+      }
+      close();
+      break;
+    }
+    case ValueType::Object: {
+      // members are brought into key order by close()
+      addCompoundValue(0x0b);
+      ObjectIterator it(item, true);
+      while (it.valid()) {
+        add(it.key(true));
+        add(it.value());
+        it.next();
+      }
+      close();
+      break;
+    }
+    default: {
+      ValueLength const l = item.byteSize();
+      reserve(l);
+      memcpy(_start + _pos, item.start(), checkOverflow(l));
+      advance(l);
+      break;
+    }
+  }
+
+  return _start + oldPos;
+}
+
+void Builder::addCanonicalDouble(double v) {
+  if (v >= -9223372036854775808.0 && v < 9223372036854775808.0) {
+    int64_t const i = static_cast<int64_t>(v);
+    if (static_cast<double>(i) == v) {
+      // integral value, this also turns -0.0 into 0
+      addInt(i);
+      return;
+    }
+  } else if (v >= 0.0 && v < 18446744073709551616.0) {
+    uint64_t const u = static_cast<uint64_t>(v);
+    if (static_cast<double>(u) == v) {
+      addUInt(u);
+      return;
+    }
+  }
+
+  uint64_t dv;
+  if (v != v) {
+    // use the same NaN for all NaN values
+    dv = 0x7ff8000000000000ULL;
+  } else {
+    memcpy(&dv, &v, sizeof(double));
+  }
+  reserve(1 + sizeof(double));
+  appendByteUnchecked(0x1b);
+  appendLengthUnchecked<sizeof(double)>(dv);
+}
+
 uint8_t* Builder::set(ValuePair const& pair) {
   // This method builds a single further VPack item at the current
   // append position. This is the case for ValueType::String,
@@ -849,7 +1131,7 @@ void Builder::checkAttributeUniqueness(Slice const& obj) const {
 
   if (obj.isSorted()) {
     // object attributes are sorted
-    Slice previous = obj.keyAt(0);
+    Slice previous = translateKey(obj.keyAt(0, false));
     ValueLength len;
     char const* p = previous.getString(len);
   
@@ -857,8 +1139,8 @@ void Builder::checkAttributeUniqueness(Slice const& obj) const {
 
     // compare each two adjacent attribute names
     for (ValueLength i = 1; i < n; ++i) {
-      Slice current = obj.keyAt(i);
-      // keyAt() guarantees a string as returned type
+      Slice current = translateKey(obj.keyAt(i, false));
+      // translateKey() guarantees a string as returned type
       VELOCYPACK_ASSERT(current.isString());
 
       ValueLength len2;
@@ -877,8 +1159,8 @@ void Builder::checkAttributeUniqueness(Slice const& obj) const {
     ObjectIterator it(obj, true);
 
     while (it.valid()) {
-      Slice const key = it.key(true);
-      // key() guarantees a String as returned type
+      Slice const key = translateKey(it.key(false));
+      // translateKey() guarantees a String as returned type
       VELOCYPACK_ASSERT(key.isString());
       if (!keys.emplace(StringRef(key)).second) {
         throw Exception(Exception::DuplicateAttributeName);
@@ -530,3 +530,17 @@ Builder Collection::sort(
   return b;
 }
 
+
+static Options makeCanonicalOptions() {
+  Options options;
+  options.buildCanonical = true;
+  return options;
+}
+
+Builder Collection::canonicalize(Slice const& slice) {
+  static Options const canonicalOptions = makeCanonicalOptions();
+
+  Builder b(&canonicalOptions);
+  b.add(slice);
+  return b;
+}
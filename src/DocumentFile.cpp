@@ -0,0 +1,231 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/DocumentFile.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Sink.h"
+#include "velocypack/Validator.h"
+
+using namespace arangodb::velocypack;
+
+namespace {
+
+char const Magic[4] = { 'V', 'P', 'K', 'F' };
+
+void appendLittleEndian(Sink* sink, uint64_t value, int length) {
+  char buffer[8];
+  for (int i = 0; i < length; ++i) {
+    buffer[i] = static_cast<char>(value & 0xff);
+    value >>= 8;
+  }
+  sink->append(buffer, length);
+}
+
+#ifndef _WIN32
+int adviceFor(DocumentFile::AccessPattern pattern) {
+  switch (pattern) {
+    case DocumentFile::SequentialAccess:
+      return MADV_SEQUENTIAL;
+    case DocumentFile::RandomAccess:
+      return MADV_RANDOM;
+    default:
+      return MADV_NORMAL;
+  }
+}
+#endif
+
+}  // namespace
+
+uint32_t const DocumentFile::Version = 1;
+ValueLength const DocumentFile::HeaderSize = 8;
+ValueLength const DocumentFile::FooterSize = 16;
+
+DocumentFile::DocumentFile(std::string const& filename, AccessPattern pattern)
+    : _mapping(nullptr), _mappingSize(0), _data(nullptr), _tableOffset(0), _size(0) {
+#ifdef _WIN32
+  std::ifstream ifs(filename, std::ifstream::in | std::ifstream::binary);
+  if (!ifs.is_open()) {
+    throw Exception(Exception::IOError,
+                    "Cannot open document file '" + filename + "'");
+  }
+  char buffer[32768];
+  while (ifs.good()) {
+    ifs.read(&buffer[0], sizeof(buffer));
+    _buffer.append(buffer, checkOverflow(ifs.gcount()));
+  }
+  load(reinterpret_cast<uint8_t const*>(_buffer.data()), _buffer.size());
+  (void) pattern;
+#else
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd == -1) {
+    throw Exception(Exception::IOError,
+                    "Cannot open document file '" + filename + "'");
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw Exception(Exception::IOError,
+                    "Cannot stat document file '" + filename + "'");
+  }
+  if (static_cast<ValueLength>(st.st_size) < HeaderSize + FooterSize) {
+    ::close(fd);
+    throw Exception(Exception::InvalidDocumentFile,
+                    "Document file '" + filename + "' is too short");
+  }
+  _mappingSize = static_cast<size_t>(st.st_size);
+  void* mapping = ::mmap(nullptr, _mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    throw Exception(Exception::IOError,
+                    "Cannot map document file '" + filename + "'");
+  }
+  _mapping = mapping;
+  advise(pattern);
+  try {
+    load(static_cast<uint8_t const*>(_mapping), _mappingSize);
+  } catch (...) {
+    ::munmap(_mapping, _mappingSize);
+    throw;
+  }
+
+  // the offset table is read on every access, so ask for it to be paged
+  // in right away
+  size_t const pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+  size_t const tableStart = static_cast<size_t>(_tableOffset) & ~(pageSize - 1);
+  ::madvise(static_cast<char*>(_mapping) + tableStart,
+            _mappingSize - tableStart, MADV_WILLNEED);
+#endif
+}
+
+DocumentFile::DocumentFile(uint8_t const* data, ValueLength length)
+    : _mapping(nullptr), _mappingSize(0), _data(nullptr), _tableOffset(0), _size(0) {
+  load(data, length);
+}
+
+DocumentFile::~DocumentFile() {
+#ifndef _WIN32
+  if (_mapping != nullptr) {
+    ::munmap(_mapping, _mappingSize);
+  }
+#endif
+}
+
+Slice DocumentFile::at(ValueLength index) const {
+  if (index >= _size) {
+    throw Exception(Exception::IndexOutOfBounds);
+  }
+  ValueLength const start = offset(index);
+  ValueLength const end = (index + 1 < _size) ? offset(index + 1) : _tableOffset;
+  if (start < HeaderSize || start >= end || end > _tableOffset) {
+    throw Exception(Exception::InvalidDocumentFile,
+                    "Invalid offset of document " + std::to_string(index));
+  }
+
+  // the document must fill the space up to the next one exactly
+  Validator validator;
+  try {
+    validator.validateFraming(_data + start, checkOverflow(end - start));
+  } catch (Exception const& ex) {
+    throw Exception(Exception::InvalidDocumentFile, ex.what());
+  }
+  return Slice(_data + start);
+}
+
+void DocumentFile::advise(AccessPattern pattern) const {
+#ifndef _WIN32
+  if (_mapping != nullptr) {
+    ::madvise(_mapping, _mappingSize, adviceFor(pattern));
+  }
+#else
+  (void) pattern;
+#endif
+}
+
+void DocumentFile::load(uint8_t const* data, ValueLength length) {
+  if (length < HeaderSize + FooterSize || memcmp(data, Magic, sizeof(Magic)) != 0) {
+    throw Exception(Exception::InvalidDocumentFile,
+                    "Invalid document file header");
+  }
+  uint32_t const version = readIntegerFixed<uint32_t, 4>(data + 4);
+  if (version != Version) {
+    throw Exception(Exception::InvalidDocumentFile,
+                    "Unsupported document file version " +
+                        std::to_string(version));
+  }
+  ValueLength const size = readIntegerFixed<ValueLength, 8>(data + length - 16);
+  ValueLength const tableOffset = readIntegerFixed<ValueLength, 8>(data + length - 8);
+  if (tableOffset < HeaderSize || tableOffset > length - FooterSize ||
+      (length - FooterSize - tableOffset) / 8 != size ||
+      (length - FooterSize - tableOffset) % 8 != 0) {
+    throw Exception(Exception::InvalidDocumentFile,
+                    "Invalid document file offset table");
+  }
+  _data = data;
+  _tableOffset = tableOffset;
+  _size = size;
+}
+
+DocumentFileWriter::DocumentFileWriter(Sink* sink)
+    : _sink(sink), _position(DocumentFile::HeaderSize), _finished(false) {
+  _sink->append(Magic, sizeof(Magic));
+  appendLittleEndian(_sink, DocumentFile::Version, 4);
+}
+
+ValueLength DocumentFileWriter::add(Slice document) {
+  if (_finished) {
+    throw Exception(Exception::InternalError, "DocumentFileWriter is already finished");
+  }
+  document = document.resolveExternals();
+  ValueLength const byteSize = document.byteSize();
+  _sink->append(document.startAs<char>(), byteSize);
+  _offsets.push_back(_position);
+  _position += byteSize;
+  return _offsets.size() - 1;
+}
+
+void DocumentFileWriter::finish() {
+  if (_finished) {
+    throw Exception(Exception::InternalError, "DocumentFileWriter is already finished");
+  }
+  _finished = true;
+  _sink->reserve(8 * _offsets.size() + DocumentFile::FooterSize);
+  for (auto const& it : _offsets) {
+    appendLittleEndian(_sink, it, 8);
+  }
+  appendLittleEndian(_sink, _offsets.size(), 8);
+  appendLittleEndian(_sink, _position, 8);
+}
@@ -24,189 +24,117 @@
 /// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "velocypack/velocypack-common.h"
+#include "velocypack/AttributeTranslator.h"
 #include "velocypack/Dumper.h"
 #include "velocypack/Iterator.h"
 #include "velocypack/ValueType.h"
+#include "asm-functions.h"
 
 using namespace arangodb::velocypack;
 
-// forward for fpconv function declared elsewhere
+// forward for fpconv functions declared elsewhere
 namespace arangodb {
 namespace velocypack {
 int fpconv_dtoa(double fp, char dest[24]);
+int fpconv_dtoa_shortest(double fp, char dest[24]);
 }
 };
 
-void Dumper::appendUInt(uint64_t v) {
-  if (10000000000000000000ULL <= v) {
-    _sink->push_back('0' + (v / 10000000000000000000ULL) % 10);
-  }
-  if (1000000000000000000ULL <= v) {
-    _sink->push_back('0' + (v / 1000000000000000000ULL) % 10);
-  }
-  if (100000000000000000ULL <= v) {
-    _sink->push_back('0' + (v / 100000000000000000ULL) % 10);
-  }
-  if (10000000000000000ULL <= v) {
-    _sink->push_back('0' + (v / 10000000000000000ULL) % 10);
-  }
-  if (1000000000000000ULL <= v) {
-    _sink->push_back('0' + (v / 1000000000000000ULL) % 10);
-  }
-  if (100000000000000ULL <= v) {
-    _sink->push_back('0' + (v / 100000000000000ULL) % 10);
-  }
-  if (10000000000000ULL <= v) {
-    _sink->push_back('0' + (v / 10000000000000ULL) % 10);
-  }
-  if (1000000000000ULL <= v) {
-    _sink->push_back('0' + (v / 1000000000000ULL) % 10);
-  }
-  if (100000000000ULL <= v) {
-    _sink->push_back('0' + (v / 100000000000ULL) % 10);
-  }
-  if (10000000000ULL <= v) {
-    _sink->push_back('0' + (v / 10000000000ULL) % 10);
-  }
-  if (1000000000ULL <= v) {
-    _sink->push_back('0' + (v / 1000000000ULL) % 10);
-  }
-  if (100000000ULL <= v) {
-    _sink->push_back('0' + (v / 100000000ULL) % 10);
-  }
-  if (10000000ULL <= v) {
-    _sink->push_back('0' + (v / 10000000ULL) % 10);
-  }
-  if (1000000ULL <= v) {
-    _sink->push_back('0' + (v / 1000000ULL) % 10);
-  }
-  if (100000ULL <= v) {
-    _sink->push_back('0' + (v / 100000ULL) % 10);
-  }
-  if (10000ULL <= v) {
-    _sink->push_back('0' + (v / 10000ULL) % 10);
-  }
-  if (1000ULL <= v) {
-    _sink->push_back('0' + (v / 1000ULL) % 10);
-  }
-  if (100ULL <= v) {
-    _sink->push_back('0' + (v / 100ULL) % 10);
-  }
-  if (10ULL <= v) {
-    _sink->push_back('0' + (v / 10ULL) % 10);
-  }
+namespace {
+
+// the two-digit decimal representations of 0 to 99
+char const DigitPairs[201] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
 
-  _sink->push_back('0' + (v % 10));
+inline int countDigits(uint64_t v) {
+  int n = 1;
+  while (true) {
+    if (v < 10) {
+      return n;
+    }
+    if (v < 100) {
+      return n + 1;
+    }
+    if (v < 1000) {
+      return n + 2;
+    }
+    if (v < 10000) {
+      return n + 3;
+    }
+    v /= 10000;
+    n += 4;
+  }
 }
 
-void Dumper::appendDouble(double v) {
-  char temp[24];
-  int len = fpconv_dtoa(v, &temp[0]);
-  _sink->append(&temp[0], static_cast<ValueLength>(len));
+// writes the decimal digits of v backwards, ending right before end,
+// two digits per division
+inline void writeDigits(uint64_t v, char* end) {
+  while (v >= 100) {
+    uint64_t const i = (v % 100) * 2;
+    v /= 100;
+    end -= 2;
+    end[0] = DigitPairs[i];
+    end[1] = DigitPairs[i + 1];
+  }
+  if (v >= 10) {
+    end[-2] = DigitPairs[v * 2];
+    end[-1] = DigitPairs[v * 2 + 1];
+  } else {
+    end[-1] = static_cast<char>('0' + v);
+  }
 }
 
-void Dumper::dumpUnicodeCharacter(uint16_t value) {
-  _sink->append("\\u", 2);
-  
-  uint16_t p;
-  p = (value & 0xf000U) >> 12;
-  _sink->push_back((p < 10) ? ('0' + p) : ('A' + p - 10));
+// Arrays smaller than this are dumped on a single thread by dumpParallel()
+ValueLength const ParallelMinSize = 256 * 1024;
 
-  p = (value & 0x0f00U) >> 8;
-  _sink->push_back((p < 10) ? ('0' + p) : ('A' + p - 10));
+// translated attribute names with ids up to this value are cached by the
+// Dumper. ids are usually small and dense
+uint64_t const MaxCachedKeyId = 65536;
 
-  p = (value & 0x00f0U) >> 4;
-  _sink->push_back((p < 10) ? ('0' + p) : ('A' + p - 10));
-  
-  p = (value & 0x000fU);
-  _sink->push_back((p < 10) ? ('0' + p) : ('A' + p - 10));
-}
+// number of chunks per thread in dumpParallel(). more chunks than threads
+// even out the differences in the time needed for the chunks
+size_t const ParallelChunksPerThread = 8;
 
-void Dumper::dumpInteger(Slice const* slice) {
-  VELOCYPACK_ASSERT(slice->isInteger());
+}  // namespace
 
-  if (slice->isType(ValueType::UInt)) {
-    uint64_t v = slice->getUIntUnchecked();
+void Dumper::dumpUInt(uint64_t v) {
+  // at most 20 digits, written directly into the local buffer
+  ensure(20);
+  int const n = countDigits(v);
+  writeDigits(v, _pos + n);
+  _pos += n;
+}
 
-    appendUInt(v);
-  } else if (slice->isType(ValueType::Int)) {
-    int64_t v = slice->getIntUnchecked();
-    if (v == INT64_MIN) {
-      _sink->append("-9223372036854775808", 20);
-      return;
-    }
-    if (v < 0) {
-      _sink->push_back('-');
-      v = -v;
-    }
+void Dumper::dumpDouble(double v) {
+  char temp[24];
+  int len = (options->doubleFormat == Options::ShortestDoubleFormat)
+                ? fpconv_dtoa_shortest(v, &temp[0])
+                : fpconv_dtoa(v, &temp[0]);
+  put(&temp[0], static_cast<size_t>(len));
+}
 
-    if (1000000000000000000LL <= v) {
-      _sink->push_back('0' + (v / 1000000000000000000LL) % 10);
-    }
-    if (100000000000000000LL <= v) {
-      _sink->push_back('0' + (v / 100000000000000000LL) % 10);
-    }
-    if (10000000000000000LL <= v) {
-      _sink->push_back('0' + (v / 10000000000000000LL) % 10);
-    }
-    if (1000000000000000LL <= v) {
-      _sink->push_back('0' + (v / 1000000000000000LL) % 10);
-    }
-    if (100000000000000LL <= v) {
-      _sink->push_back('0' + (v / 100000000000000LL) % 10);
-    }
-    if (10000000000000LL <= v) {
-      _sink->push_back('0' + (v / 10000000000000LL) % 10);
-    }
-    if (1000000000000LL <= v) {
-      _sink->push_back('0' + (v / 1000000000000LL) % 10);
-    }
-    if (100000000000LL <= v) {
-      _sink->push_back('0' + (v / 100000000000LL) % 10);
-    }
-    if (10000000000LL <= v) {
-      _sink->push_back('0' + (v / 10000000000LL) % 10);
-    }
-    if (1000000000LL <= v) {
-      _sink->push_back('0' + (v / 1000000000LL) % 10);
-    }
-    if (100000000LL <= v) {
-      _sink->push_back('0' + (v / 100000000LL) % 10);
-    }
-    if (10000000LL <= v) {
-      _sink->push_back('0' + (v / 10000000LL) % 10);
-    }
-    if (1000000LL <= v) {
-      _sink->push_back('0' + (v / 1000000LL) % 10);
-    }
-    if (100000LL <= v) {
-      _sink->push_back('0' + (v / 100000LL) % 10);
-    }
-    if (10000LL <= v) {
-      _sink->push_back('0' + (v / 10000LL) % 10);
-    }
-    if (1000LL <= v) {
-      _sink->push_back('0' + (v / 1000LL) % 10);
-    }
-    if (100LL <= v) {
-      _sink->push_back('0' + (v / 100LL) % 10);
-    }
-    if (10LL <= v) {
-      _sink->push_back('0' + (v / 10LL) % 10);
-    }
+void Dumper::dumpUnicodeCharacter(uint16_t value) {
+  static char const HexDigits[] = "0123456789ABCDEF";
 
-    _sink->push_back('0' + (v % 10));
-  } else if (slice->isType(ValueType::SmallInt)) {
-    int64_t v = slice->getSmallIntUnchecked();
-    if (v < 0) {
-      _sink->push_back('-');
-      v = -v;
-    }
-    _sink->push_back('0' + static_cast<char>(v));
-  }
+  char buffer[6] = { '\\', 'u', HexDigits[(value & 0xf000U) >> 12],
+                     HexDigits[(value & 0x0f00U) >> 8],
+                     HexDigits[(value & 0x00f0U) >> 4],
+                     HexDigits[value & 0x000fU] };
+  put(buffer, 6);
 }
 
 void Dumper::dumpString(char const* src, ValueLength len) {
@@ -243,49 +171,78 @@ void Dumper::dumpString(char const* src, ValueLength len) {
       0,    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
       0,    0,   0,   0};
 
-  _sink->reserve(len);
+  // with limited output, only as much of the string is looked at as can
+  // still be part of the output. the cut is made at the start of a UTF-8
+  // sequence, and the limit is lowered to the end of the cut string, so
+  // that nothing else gets appended
+  bool cut = false;
+  if (_maxBytes != 0) {
+    ValueLength const size = outputSize();
+    ValueLength const remaining = (size < _maxBytes) ? _maxBytes - size : 0;
+    if (len > remaining) {
+      len = cutOutput(src, static_cast<size_t>(remaining));
+      cut = true;
+    }
+  }
 
   uint8_t const* p = reinterpret_cast<uint8_t const*>(src);
   uint8_t const* e = p + len;
+
+  // runs of bytes that need no escaping are found with the (vectorized)
+  // scan functions and appended in one go. multi-byte UTF-8 sequences only
+  // need to be looked at when they are escaped (escapeUnicode), otherwise
+  // they are part of the runs, and the only thing left to check is that
+  // the string does not end in the middle of a sequence
+  bool const escapeUnicode = options->escapeUnicode;
+  if (!escapeUnicode) {
+    for (uint8_t const* q = (len > 3 ? e - 3 : p); q < e; ++q) {
+      uint8_t c = *q;
+      if (((c & 0xe0U) == 0xc0U && q + 1 >= e) ||
+          ((c & 0xf0U) == 0xe0U && q + 2 >= e) ||
+          ((c & 0xf8U) == 0xf0U && q + 3 >= e)) {
+        throw Exception(Exception::InvalidUtf8Sequence);
+      }
+    }
+  }
+
   while (p < e) {
     uint8_t c = *p;
+    char esc = EscapeTable[c];
 
-    if ((c & 0x80U) == 0) {
-      // check for control characters
-      char esc = EscapeTable[c];
+    if (esc == 0 && ((c & 0x80U) == 0 || !escapeUnicode)) {
+      size_t n = escapeUnicode ? JSONStringEscapeScanCheckUtf8(p, e - p)
+                               : JSONStringEscapeScan(p, e - p);
+      put(reinterpret_cast<char const*>(p), n);
+      p += n;
+      continue;
+    }
 
-      if (esc) {
-        if (c != '/' || options->escapeForwardSlashes) {
-          // escape forward slashes only when requested
-          _sink->push_back('\\');
-        }
-        _sink->push_back(static_cast<char>(esc));
+    if ((c & 0x80U) == 0) {
+      // control characters and the like
+      if (c != '/' || options->escapeForwardSlashes) {
+        // escape forward slashes only when requested
+        put('\\');
+      }
+      put(static_cast<char>(esc));
 
-        if (esc == 'u') {
-          uint16_t i1 = (((uint16_t)c) & 0xf0U) >> 4;
-          uint16_t i2 = (((uint16_t)c) & 0x0fU);
+      if (esc == 'u') {
+        uint16_t i1 = (((uint16_t)c) & 0xf0U) >> 4;
+        uint16_t i2 = (((uint16_t)c) & 0x0fU);
 
-          _sink->append("00", 2);
-          _sink->push_back(
-              static_cast<char>((i1 < 10) ? ('0' + i1) : ('A' + i1 - 10)));
-          _sink->push_back(
-              static_cast<char>((i2 < 10) ? ('0' + i2) : ('A' + i2 - 10)));
-        }
-      } else {
-        _sink->push_back(static_cast<char>(c));
+        put("00", 2);
+        put(
+            static_cast<char>((i1 < 10) ? ('0' + i1) : ('A' + i1 - 10)));
+        put(
+            static_cast<char>((i2 < 10) ? ('0' + i2) : ('A' + i2 - 10)));
       }
     } else if ((c & 0xe0U) == 0xc0U) {
       // two-byte sequence
       if (p + 1 >= e) {
         throw Exception(Exception::InvalidUtf8Sequence);
       }
-      
-      if (options->escapeUnicode) {
-        uint16_t value = ((((uint16_t) *p & 0x1fU) << 6) | ((uint16_t) *(p + 1) & 0x3fU));
-        dumpUnicodeCharacter(value);
-      } else {
-        _sink->append(reinterpret_cast<char const*>(p), 2);
-      }
+
+      uint16_t value = ((((uint16_t) *p & 0x1fU) << 6) | ((uint16_t) *(p + 1) & 0x3fU));
+      dumpUnicodeCharacter(value);
       ++p;
     } else if ((c & 0xf0U) == 0xe0U) {
       // three-byte sequence
@@ -293,12 +250,8 @@ void Dumper::dumpString(char const* src, ValueLength len) {
         throw Exception(Exception::InvalidUtf8Sequence);
       }
 
-      if (options->escapeUnicode) {
-        uint16_t value = ((((uint16_t) *p & 0x0fU) << 12) | (((uint16_t) *(p + 1) & 0x3fU) << 6) | ((uint16_t) *(p + 2) & 0x3fU));
-        dumpUnicodeCharacter(value);
-      } else {
-        _sink->append(reinterpret_cast<char const*>(p), 3);
-      }
+      uint16_t value = ((((uint16_t) *p & 0x0fU) << 12) | (((uint16_t) *(p + 1) & 0x3fU) << 6) | ((uint16_t) *(p + 2) & 0x3fU));
+      dumpUnicodeCharacter(value);
       p += 2;
     } else if ((c & 0xf8U) == 0xf0U) {
       // four-byte sequence
@@ -306,164 +259,610 @@ void Dumper::dumpString(char const* src, ValueLength len) {
         throw Exception(Exception::InvalidUtf8Sequence);
       }
 
-      if (options->escapeUnicode) {
-        uint32_t value = ((((uint32_t) *p & 0x0fU) << 18) | (((uint32_t) *(p + 1) & 0x3fU) << 12) | (((uint32_t) *(p + 2) & 0x3fU) << 6) | ((uint32_t) *(p + 3) & 0x3fU));
-        // construct the surrogate pairs
-        value -= 0x10000U;
-        uint16_t high = (uint16_t) (((value & 0xffc00U) >> 10) + 0xd800);
-        dumpUnicodeCharacter(high);
-        uint16_t low = (value & 0x3ffU) + 0xdc00U;
-        dumpUnicodeCharacter(low);
-      } else {
-        _sink->append(reinterpret_cast<char const*>(p), 4);
-      }
+      uint32_t value = ((((uint32_t) *p & 0x0fU) << 18) | (((uint32_t) *(p + 1) & 0x3fU) << 12) | (((uint32_t) *(p + 2) & 0x3fU) << 6) | ((uint32_t) *(p + 3) & 0x3fU));
+      // construct the surrogate pairs
+      value -= 0x10000U;
+      uint16_t high = (uint16_t) (((value & 0xffc00U) >> 10) + 0xd800);
+      dumpUnicodeCharacter(high);
+      uint16_t low = (value & 0x3ffU) + 0xdc00U;
+      dumpUnicodeCharacter(low);
       p += 3;
     }
 
     ++p;
   }
+
+  if (cut && outputSize() < _maxBytes) {
+    _maxBytes = outputSize();
+  }
+}
+
+void Dumper::beginDump() {
+  _written = 0;
+  _maxBytes = options->dumpMaxBytes;
+  _maxDepth = (options->dumpMaxDepth == 0) ? UINT64_MAX : options->dumpMaxDepth;
+  _maxElements = (options->dumpMaxElements == 0) ? UINT64_MAX : options->dumpMaxElements;
+  _depth = 0;
+  _active = true;
+  checkKeyCache();
+}
+
+void Dumper::dumpTopLevel(Slice const* slice) {
+  if (_active) {
+    // called by a custom type handler. the limits of the outer dump apply
+    dumpValue(slice);
+    flush();
+    return;
+  }
+
+  beginDump();
+
+  try {
+    dumpValue(slice);
+  } catch (...) {
+    // discard the partial output still buffered, so that it is neither
+    // written nor counted by the next dump
+    _pos = _buffer;
+    _written = 0;
+    _maxBytes = 0;
+    _active = false;
+    throw;
+  }
+
+  bool const cut = truncated() && outputSize() > _maxBytes;
+  flush();
+  _maxBytes = 0;
+  _active = false;
+  if (cut) {
+    put("...", 3);
+  }
+  flush();
+}
+
+size_t Dumper::cutOutput(char const* p, size_t len) {
+  // do not cut in the middle of a UTF-8 sequence
+  while (len > 0 && (static_cast<uint8_t>(p[len]) & 0xc0U) == 0x80U) {
+    --len;
+  }
+  return len;
+}
+
+void Dumper::dumpElided(ValueLength n) {
+  put("...(", 4);
+  dumpUInt(n);
+  put(" more)", 6);
 }
 
-void Dumper::dumpValue(Slice const* slice, Slice const* base) {
-  if (base == nullptr) {
-    base = slice;
-    VELOCYPACK_ASSERT(base != nullptr);
+void Dumper::dumpArray(Slice const* slice) {
+  ValueLength const n = slice->length();
+  if (n > 0 && _depth >= _maxDepth) {
+    put("[...]", 5);
+    return;
   }
 
-  switch (slice->type()) {
-    case ValueType::Null: {
-      _sink->append("null", 4);
-      break;
+  uint8_t const* p = nullptr;
+  if (n > 0) {
+    uint8_t const h = slice->head();
+    if (h == 0x13) {
+      p = slice->at(0).start();
+    } else {
+      p = slice->begin() + slice->findDataOffset(h);
     }
+  }
 
-    case ValueType::Bool: {
-      if (slice->getBool()) {
-        _sink->append("true", 4);
-      } else {
-        _sink->append("false", 5);
+  ++_depth;
+  put('[');
+  if (options->prettyPrint) {
+    put('\n');
+    ++_indentation;
+    dumpArrayMembers(slice, p, 0, n);
+    --_indentation;
+    indent();
+  } else {
+    dumpArrayMembers(slice, p, 0, n);
+  }
+  put(']');
+  --_depth;
+}
+
+void Dumper::dumpArrayMembers(Slice const* slice, uint8_t const* p,
+                              ValueLength from, ValueLength to) {
+  // the members are decoded one after the other in storage order. members
+  // of arrays without index table (0x02 to 0x05) all have the same size,
+  // so their size is only determined once
+  if (from >= to) {
+    return;
+  }
+  ValueLength const n = slice->length();
+  ValueLength const stride = (slice->head() <= 0x05) ? Slice(p).byteSize() : 0;
+
+  if (options->prettyPrint) {
+    for (ValueLength i = from; i < to && !truncated(); ++i) {
+      indent();
+      if (i == _maxElements) {
+        dumpElided(n - i);
+        put('\n');
+        break;
       }
-      break;
+      Slice const value(p);
+      dumpValue(&value, slice);
+      if (i + 1 < n) {
+        put(',');
+      }
+      put('\n');
+      p += (stride != 0) ? stride : value.byteSize();
     }
-
-    case ValueType::Array: {
-      ArrayIterator it(*slice);
-      _sink->push_back('[');
-      if (options->prettyPrint) {
-        _sink->push_back('\n');
-        ++_indentation;
-        while (it.valid()) {
-          indent();
-          dumpValue(it.value(), slice);
-          if (!it.isLast()) {
-            _sink->push_back(',');
-          }
-          _sink->push_back('\n');
-          it.next();
-        }
-        --_indentation;
-        indent();
-      } else {
-        while (it.valid()) {
-          if (!it.isFirst()) {
-            _sink->push_back(',');
-          }
-          dumpValue(it.value(), slice);
-          it.next();
-        }
+  } else {
+    for (ValueLength i = from; i < to && !truncated(); ++i) {
+      if (i > 0) {
+        put(',');
+      }
+      if (i == _maxElements) {
+        dumpElided(n - i);
+        break;
       }
-      _sink->push_back(']');
-      break;
+      Slice const value(p);
+      dumpValue(&value, slice);
+      p += (stride != 0) ? stride : value.byteSize();
     }
+  }
+}
 
-    case ValueType::Object: {
-      ObjectIterator it(*slice);
-      _sink->push_back('{');
-      if (options->prettyPrint) {
-        _sink->push_back('\n');
-        ++_indentation;
-        while (it.valid()) {
-          indent();
-          dumpValue(it.key(true), slice);
-          _sink->append(" : ", 3);
-          dumpValue(it.value(), slice);
-          if (!it.isLast()) {
-            _sink->push_back(',');
-          }
-          _sink->push_back('\n');
-          it.next();
-        }
-        --_indentation;
-        indent();
-      } else {
-        while (it.valid()) {
-          if (!it.isFirst()) {
-            _sink->push_back(',');
-          }
-          dumpValue(it.key(true), slice);
-          _sink->push_back(':');
-          dumpValue(it.value(), slice);
-          it.next();
-        }
+void Dumper::dumpObject(Slice const* slice) {
+  // sequential iteration walks the members in storage order instead
+  // of jumping around via the index table
+  ObjectIterator it(*slice, !options->dumpAttributesInIndexOrder);
+  if (it.size() > 0 && _depth >= _maxDepth) {
+    put("{...}", 5);
+    return;
+  }
+
+  ++_depth;
+  put('{');
+  if (options->prettyPrint) {
+    put('\n');
+    ++_indentation;
+    while (it.valid() && !truncated()) {
+      indent();
+      if (it.index() == _maxElements) {
+        dumpElided(it.size() - it.index());
+        put('\n');
+        break;
+      }
+      dumpKey(it.key(false));
+      put(" : ", 3);
+      dumpValue(it.value(), slice);
+      if (!it.isLast()) {
+        put(',');
+      }
+      put('\n');
+      it.next();
+    }
+    --_indentation;
+    indent();
+  } else {
+    while (it.valid() && !truncated()) {
+      if (!it.isFirst()) {
+        put(',');
       }
-      _sink->push_back('}');
-      break;
+      if (it.index() == _maxElements) {
+        dumpElided(it.size() - it.index());
+        break;
+      }
+      dumpKey(it.key(false));
+      put(':');
+      dumpValue(it.value(), slice);
+      it.next();
     }
+  }
+  put('}');
+  --_depth;
+}
+
+void Dumper::checkKeyCache() {
+  AttributeTranslator const* translator = AttributeTranslator::current();
+  uint64_t const generation = (translator != nullptr) ? translator->generation() : 0;
+  if (translator != _keyTranslator || generation != _keyGeneration ||
+      options->escapeForwardSlashes != _keyEscapeForwardSlashes ||
+      options->escapeUnicode != _keyEscapeUnicode) {
+    _keys.clear();
+    _keyData.clear();
+    _keyTranslator = translator;
+    _keyGeneration = generation;
+    _keyEscapeForwardSlashes = options->escapeForwardSlashes;
+    _keyEscapeUnicode = options->escapeUnicode;
+  }
+}
 
-    case ValueType::Double: {
-      double const v = slice->getDouble();
-      if (std::isnan(v) || !std::isfinite(v)) {
-        handleUnsupportedType(slice);
-      } else {
-        appendDouble(v);
+void Dumper::dumpKey(Slice const& key) {
+  uint8_t const h = key.head();
+  if (((h >= 0x28 && h <= 0x2f) || (h >= 0x30 && h <= 0x39)) &&
+      _keyTranslator != nullptr) {
+    uint64_t const id = key.getUIntUnchecked();
+    if (id < _keys.size() && _keys[id].length != 0) {
+      put(_keyData.data() + _keys[id].offset, _keys[id].length);
+      return;
+    }
+    uint8_t const* translated = _keyTranslator->translate(id);
+    if (id < MaxCachedKeyId && translated != nullptr &&
+        _keyData.size() < UINT32_MAX / 2) {
+      // dump the key into the cache first, using the same options
+      ValueLength len;
+      char const* p = Slice(translated).getString(len);
+      StringSink keySink(&_keyData);
+      Dumper keyDumper(&keySink, options);
+      size_t const offset = _keyData.size();
+      keyDumper.appendString(p, len);
+
+      if (id >= _keys.size()) {
+        _keys.resize(static_cast<size_t>(id) + 1, CachedKey{0, 0});
       }
-      break;
+      _keys[id].offset = static_cast<uint32_t>(offset);
+      _keys[id].length = static_cast<uint32_t>(_keyData.size() - offset);
+      put(_keyData.data() + offset, _keys[id].length);
+      return;
     }
+  }
+  Slice const translated = key.makeKey();
+  dumpValue(&translated);
+}
 
-    case ValueType::Int:
-    case ValueType::UInt:
-    case ValueType::SmallInt: {
-      dumpInteger(slice);
-      break;
-    }
+void Dumper::dumpNullValue(Slice const*, Slice const*) {
+  put("null", 4);
+}
 
-    case ValueType::String: {
-      ValueLength len;
-      char const* p = slice->getString(len);
-      _sink->reserve(2 + len);
-      _sink->push_back('"');
-      dumpString(p, len);
-      _sink->push_back('"');
-      break;
+void Dumper::dumpFalseValue(Slice const*, Slice const*) {
+  put("false", 5);
+}
+
+void Dumper::dumpTrueValue(Slice const*, Slice const*) {
+  put("true", 4);
+}
+
+void Dumper::dumpArrayValue(Slice const* slice, Slice const*) {
+  dumpArray(slice);
+}
+
+void Dumper::dumpObjectValue(Slice const* slice, Slice const*) {
+  dumpObject(slice);
+}
+
+void Dumper::dumpDoubleValue(Slice const* slice, Slice const*) {
+  double const v = slice->getDouble();
+  if (std::isnan(v) || !std::isfinite(v)) {
+    handleUnsupportedType(slice);
+  } else {
+    dumpDouble(v);
+  }
+}
+
+void Dumper::dumpIntValue(Slice const* slice, Slice const*) {
+  int64_t const v = slice->getIntUnchecked();
+  if (v < 0) {
+    ensure(21);
+    *_pos++ = '-';
+    // negating in unsigned arithmetic also works for INT64_MIN
+    dumpUInt(0 - static_cast<uint64_t>(v));
+  } else {
+    dumpUInt(static_cast<uint64_t>(v));
+  }
+}
+
+void Dumper::dumpUIntValue(Slice const* slice, Slice const*) {
+  dumpUInt(slice->getUIntUnchecked());
+}
+
+void Dumper::dumpSmallIntValue(Slice const* slice, Slice const*) {
+  // a single digit from -6 to 9, known from the head byte
+  uint8_t const h = slice->head();
+  if (h >= 0x3a) {
+    ensure(2);
+    *_pos++ = '-';
+    *_pos++ = static_cast<char>('0' + 0x40 - h);
+  } else {
+    put(static_cast<char>('0' + h - 0x30));
+  }
+}
+
+void Dumper::dumpShortStringValue(Slice const* slice, Slice const*) {
+  put('"');
+  dumpString(reinterpret_cast<char const*>(slice->start() + 1),
+             slice->head() - 0x40);
+  put('"');
+}
+
+void Dumper::dumpLongStringValue(Slice const* slice, Slice const*) {
+  ValueLength len;
+  char const* p = slice->getString(len);
+  put('"');
+  dumpString(p, len);
+  put('"');
+}
+
+void Dumper::dumpExternalValue(Slice const* slice, Slice const* base) {
+  Slice const external(slice->getExternal());
+  dumpValue(&external, base);
+}
+
+void Dumper::dumpUnsupportedValue(Slice const* slice, Slice const*) {
+  handleUnsupportedType(slice);
+}
+
+void Dumper::dumpBCDValue(Slice const*, Slice const*) {
+  // TODO
+  throw Exception(Exception::NotImplemented);
+}
+
+void Dumper::dumpCustomValue(Slice const* slice, Slice const* base) {
+  if (options->customTypeHandler == nullptr) {
+    throw Exception(Exception::NeedCustomTypeHandler);
+  }
+  // the handler may write to the sink directly
+  flush();
+  options->customTypeHandler->dump(*slice, this, *base);
+}
+
+using D = Dumper;
+
+Dumper::ValueHandler const Dumper::ValueHandlers[256] = {
+    /* 0x00 */ &D::dumpUnsupportedValue,  /* 0x01 */ &D::dumpArrayValue,
+    /* 0x02 */ &D::dumpArrayValue,        /* 0x03 */ &D::dumpArrayValue,
+    /* 0x04 */ &D::dumpArrayValue,        /* 0x05 */ &D::dumpArrayValue,
+    /* 0x06 */ &D::dumpArrayValue,        /* 0x07 */ &D::dumpArrayValue,
+    /* 0x08 */ &D::dumpArrayValue,        /* 0x09 */ &D::dumpArrayValue,
+    /* 0x0a */ &D::dumpObjectValue,       /* 0x0b */ &D::dumpObjectValue,
+    /* 0x0c */ &D::dumpObjectValue,       /* 0x0d */ &D::dumpObjectValue,
+    /* 0x0e */ &D::dumpObjectValue,       /* 0x0f */ &D::dumpObjectValue,
+    /* 0x10 */ &D::dumpObjectValue,       /* 0x11 */ &D::dumpObjectValue,
+    /* 0x12 */ &D::dumpObjectValue,       /* 0x13 */ &D::dumpArrayValue,
+    /* 0x14 */ &D::dumpObjectValue,       /* 0x15 */ &D::dumpObjectValue,
+    /* 0x16 */ &D::dumpUnsupportedValue,  /* 0x17 */ &D::dumpUnsupportedValue,
+    /* 0x18 */ &D::dumpNullValue,         /* 0x19 */ &D::dumpFalseValue,
+    /* 0x1a */ &D::dumpTrueValue,         /* 0x1b */ &D::dumpDoubleValue,
+    /* 0x1c */ &D::dumpUnsupportedValue,  /* 0x1d */ &D::dumpExternalValue,
+    /* 0x1e */ &D::dumpUnsupportedValue,  /* 0x1f */ &D::dumpUnsupportedValue,
+    /* 0x20 */ &D::dumpIntValue,          /* 0x21 */ &D::dumpIntValue,
+    /* 0x22 */ &D::dumpIntValue,          /* 0x23 */ &D::dumpIntValue,
+    /* 0x24 */ &D::dumpIntValue,          /* 0x25 */ &D::dumpIntValue,
+    /* 0x26 */ &D::dumpIntValue,          /* 0x27 */ &D::dumpIntValue,
+    /* 0x28 */ &D::dumpUIntValue,         /* 0x29 */ &D::dumpUIntValue,
+    /* 0x2a */ &D::dumpUIntValue,         /* 0x2b */ &D::dumpUIntValue,
+    /* 0x2c */ &D::dumpUIntValue,         /* 0x2d */ &D::dumpUIntValue,
+    /* 0x2e */ &D::dumpUIntValue,         /* 0x2f */ &D::dumpUIntValue,
+    /* 0x30 */ &D::dumpSmallIntValue,     /* 0x31 */ &D::dumpSmallIntValue,
+    /* 0x32 */ &D::dumpSmallIntValue,     /* 0x33 */ &D::dumpSmallIntValue,
+    /* 0x34 */ &D::dumpSmallIntValue,     /* 0x35 */ &D::dumpSmallIntValue,
+    /* 0x36 */ &D::dumpSmallIntValue,     /* 0x37 */ &D::dumpSmallIntValue,
+    /* 0x38 */ &D::dumpSmallIntValue,     /* 0x39 */ &D::dumpSmallIntValue,
+    /* 0x3a */ &D::dumpSmallIntValue,     /* 0x3b */ &D::dumpSmallIntValue,
+    /* 0x3c */ &D::dumpSmallIntValue,     /* 0x3d */ &D::dumpSmallIntValue,
+    /* 0x3e */ &D::dumpSmallIntValue,     /* 0x3f */ &D::dumpSmallIntValue,
+    /* 0x40 */ &D::dumpShortStringValue,  /* 0x41 */ &D::dumpShortStringValue,
+    /* 0x42 */ &D::dumpShortStringValue,  /* 0x43 */ &D::dumpShortStringValue,
+    /* 0x44 */ &D::dumpShortStringValue,  /* 0x45 */ &D::dumpShortStringValue,
+    /* 0x46 */ &D::dumpShortStringValue,  /* 0x47 */ &D::dumpShortStringValue,
+    /* 0x48 */ &D::dumpShortStringValue,  /* 0x49 */ &D::dumpShortStringValue,
+    /* 0x4a */ &D::dumpShortStringValue,  /* 0x4b */ &D::dumpShortStringValue,
+    /* 0x4c */ &D::dumpShortStringValue,  /* 0x4d */ &D::dumpShortStringValue,
+    /* 0x4e */ &D::dumpShortStringValue,  /* 0x4f */ &D::dumpShortStringValue,
+    /* 0x50 */ &D::dumpShortStringValue,  /* 0x51 */ &D::dumpShortStringValue,
+    /* 0x52 */ &D::dumpShortStringValue,  /* 0x53 */ &D::dumpShortStringValue,
+    /* 0x54 */ &D::dumpShortStringValue,  /* 0x55 */ &D::dumpShortStringValue,
+    /* 0x56 */ &D::dumpShortStringValue,  /* 0x57 */ &D::dumpShortStringValue,
+    /* 0x58 */ &D::dumpShortStringValue,  /* 0x59 */ &D::dumpShortStringValue,
+    /* 0x5a */ &D::dumpShortStringValue,  /* 0x5b */ &D::dumpShortStringValue,
+    /* 0x5c */ &D::dumpShortStringValue,  /* 0x5d */ &D::dumpShortStringValue,
+    /* 0x5e */ &D::dumpShortStringValue,  /* 0x5f */ &D::dumpShortStringValue,
+    /* 0x60 */ &D::dumpShortStringValue,  /* 0x61 */ &D::dumpShortStringValue,
+    /* 0x62 */ &D::dumpShortStringValue,  /* 0x63 */ &D::dumpShortStringValue,
+    /* 0x64 */ &D::dumpShortStringValue,  /* 0x65 */ &D::dumpShortStringValue,
+    /* 0x66 */ &D::dumpShortStringValue,  /* 0x67 */ &D::dumpShortStringValue,
+    /* 0x68 */ &D::dumpShortStringValue,  /* 0x69 */ &D::dumpShortStringValue,
+    /* 0x6a */ &D::dumpShortStringValue,  /* 0x6b */ &D::dumpShortStringValue,
+    /* 0x6c */ &D::dumpShortStringValue,  /* 0x6d */ &D::dumpShortStringValue,
+    /* 0x6e */ &D::dumpShortStringValue,  /* 0x6f */ &D::dumpShortStringValue,
+    /* 0x70 */ &D::dumpShortStringValue,  /* 0x71 */ &D::dumpShortStringValue,
+    /* 0x72 */ &D::dumpShortStringValue,  /* 0x73 */ &D::dumpShortStringValue,
+    /* 0x74 */ &D::dumpShortStringValue,  /* 0x75 */ &D::dumpShortStringValue,
+    /* 0x76 */ &D::dumpShortStringValue,  /* 0x77 */ &D::dumpShortStringValue,
+    /* 0x78 */ &D::dumpShortStringValue,  /* 0x79 */ &D::dumpShortStringValue,
+    /* 0x7a */ &D::dumpShortStringValue,  /* 0x7b */ &D::dumpShortStringValue,
+    /* 0x7c */ &D::dumpShortStringValue,  /* 0x7d */ &D::dumpShortStringValue,
+    /* 0x7e */ &D::dumpShortStringValue,  /* 0x7f */ &D::dumpShortStringValue,
+    /* 0x80 */ &D::dumpShortStringValue,  /* 0x81 */ &D::dumpShortStringValue,
+    /* 0x82 */ &D::dumpShortStringValue,  /* 0x83 */ &D::dumpShortStringValue,
+    /* 0x84 */ &D::dumpShortStringValue,  /* 0x85 */ &D::dumpShortStringValue,
+    /* 0x86 */ &D::dumpShortStringValue,  /* 0x87 */ &D::dumpShortStringValue,
+    /* 0x88 */ &D::dumpShortStringValue,  /* 0x89 */ &D::dumpShortStringValue,
+    /* 0x8a */ &D::dumpShortStringValue,  /* 0x8b */ &D::dumpShortStringValue,
+    /* 0x8c */ &D::dumpShortStringValue,  /* 0x8d */ &D::dumpShortStringValue,
+    /* 0x8e */ &D::dumpShortStringValue,  /* 0x8f */ &D::dumpShortStringValue,
+    /* 0x90 */ &D::dumpShortStringValue,  /* 0x91 */ &D::dumpShortStringValue,
+    /* 0x92 */ &D::dumpShortStringValue,  /* 0x93 */ &D::dumpShortStringValue,
+    /* 0x94 */ &D::dumpShortStringValue,  /* 0x95 */ &D::dumpShortStringValue,
+    /* 0x96 */ &D::dumpShortStringValue,  /* 0x97 */ &D::dumpShortStringValue,
+    /* 0x98 */ &D::dumpShortStringValue,  /* 0x99 */ &D::dumpShortStringValue,
+    /* 0x9a */ &D::dumpShortStringValue,  /* 0x9b */ &D::dumpShortStringValue,
+    /* 0x9c */ &D::dumpShortStringValue,  /* 0x9d */ &D::dumpShortStringValue,
+    /* 0x9e */ &D::dumpShortStringValue,  /* 0x9f */ &D::dumpShortStringValue,
+    /* 0xa0 */ &D::dumpShortStringValue,  /* 0xa1 */ &D::dumpShortStringValue,
+    /* 0xa2 */ &D::dumpShortStringValue,  /* 0xa3 */ &D::dumpShortStringValue,
+    /* 0xa4 */ &D::dumpShortStringValue,  /* 0xa5 */ &D::dumpShortStringValue,
+    /* 0xa6 */ &D::dumpShortStringValue,  /* 0xa7 */ &D::dumpShortStringValue,
+    /* 0xa8 */ &D::dumpShortStringValue,  /* 0xa9 */ &D::dumpShortStringValue,
+    /* 0xaa */ &D::dumpShortStringValue,  /* 0xab */ &D::dumpShortStringValue,
+    /* 0xac */ &D::dumpShortStringValue,  /* 0xad */ &D::dumpShortStringValue,
+    /* 0xae */ &D::dumpShortStringValue,  /* 0xaf */ &D::dumpShortStringValue,
+    /* 0xb0 */ &D::dumpShortStringValue,  /* 0xb1 */ &D::dumpShortStringValue,
+    /* 0xb2 */ &D::dumpShortStringValue,  /* 0xb3 */ &D::dumpShortStringValue,
+    /* 0xb4 */ &D::dumpShortStringValue,  /* 0xb5 */ &D::dumpShortStringValue,
+    /* 0xb6 */ &D::dumpShortStringValue,  /* 0xb7 */ &D::dumpShortStringValue,
+    /* 0xb8 */ &D::dumpShortStringValue,  /* 0xb9 */ &D::dumpShortStringValue,
+    /* 0xba */ &D::dumpShortStringValue,  /* 0xbb */ &D::dumpShortStringValue,
+    /* 0xbc */ &D::dumpShortStringValue,  /* 0xbd */ &D::dumpShortStringValue,
+    /* 0xbe */ &D::dumpShortStringValue,  /* 0xbf */ &D::dumpLongStringValue,
+    /* 0xc0 */ &D::dumpUnsupportedValue,  /* 0xc1 */ &D::dumpUnsupportedValue,
+    /* 0xc2 */ &D::dumpUnsupportedValue,  /* 0xc3 */ &D::dumpUnsupportedValue,
+    /* 0xc4 */ &D::dumpUnsupportedValue,  /* 0xc5 */ &D::dumpUnsupportedValue,
+    /* 0xc6 */ &D::dumpUnsupportedValue,  /* 0xc7 */ &D::dumpUnsupportedValue,
+    /* 0xc8 */ &D::dumpBCDValue,          /* 0xc9 */ &D::dumpBCDValue,
+    /* 0xca */ &D::dumpBCDValue,          /* 0xcb */ &D::dumpBCDValue,
+    /* 0xcc */ &D::dumpBCDValue,          /* 0xcd */ &D::dumpBCDValue,
+    /* 0xce */ &D::dumpBCDValue,          /* 0xcf */ &D::dumpBCDValue,
+    /* 0xd0 */ &D::dumpBCDValue,          /* 0xd1 */ &D::dumpBCDValue,
+    /* 0xd2 */ &D::dumpBCDValue,          /* 0xd3 */ &D::dumpBCDValue,
+    /* 0xd4 */ &D::dumpBCDValue,          /* 0xd5 */ &D::dumpBCDValue,
+    /* 0xd6 */ &D::dumpBCDValue,          /* 0xd7 */ &D::dumpBCDValue,
+    /* 0xd8 */ &D::dumpUnsupportedValue,  /* 0xd9 */ &D::dumpUnsupportedValue,
+    /* 0xda */ &D::dumpUnsupportedValue,  /* 0xdb */ &D::dumpUnsupportedValue,
+    /* 0xdc */ &D::dumpUnsupportedValue,  /* 0xdd */ &D::dumpUnsupportedValue,
+    /* 0xde */ &D::dumpUnsupportedValue,  /* 0xdf */ &D::dumpUnsupportedValue,
+    /* 0xe0 */ &D::dumpUnsupportedValue,  /* 0xe1 */ &D::dumpUnsupportedValue,
+    /* 0xe2 */ &D::dumpUnsupportedValue,  /* 0xe3 */ &D::dumpUnsupportedValue,
+    /* 0xe4 */ &D::dumpUnsupportedValue,  /* 0xe5 */ &D::dumpUnsupportedValue,
+    /* 0xe6 */ &D::dumpUnsupportedValue,  /* 0xe7 */ &D::dumpUnsupportedValue,
+    /* 0xe8 */ &D::dumpUnsupportedValue,  /* 0xe9 */ &D::dumpUnsupportedValue,
+    /* 0xea */ &D::dumpUnsupportedValue,  /* 0xeb */ &D::dumpUnsupportedValue,
+    /* 0xec */ &D::dumpUnsupportedValue,  /* 0xed */ &D::dumpUnsupportedValue,
+    /* 0xee */ &D::dumpUnsupportedValue,  /* 0xef */ &D::dumpUnsupportedValue,
+    /* 0xf0 */ &D::dumpCustomValue,       /* 0xf1 */ &D::dumpCustomValue,
+    /* 0xf2 */ &D::dumpCustomValue,       /* 0xf3 */ &D::dumpCustomValue,
+    /* 0xf4 */ &D::dumpCustomValue,       /* 0xf5 */ &D::dumpCustomValue,
+    /* 0xf6 */ &D::dumpCustomValue,       /* 0xf7 */ &D::dumpCustomValue,
+    /* 0xf8 */ &D::dumpCustomValue,       /* 0xf9 */ &D::dumpCustomValue,
+    /* 0xfa */ &D::dumpCustomValue,       /* 0xfb */ &D::dumpCustomValue,
+    /* 0xfc */ &D::dumpCustomValue,       /* 0xfd */ &D::dumpCustomValue,
+    /* 0xfe */ &D::dumpCustomValue,       /* 0xff */ &D::dumpCustomValue};
+
+void Dumper::dumpParallel(Slice const& slice, Sink* sink,
+                          Options const* options, size_t concurrency) {
+  Dumper dumper(sink, options);
+
+  if (concurrency == 0) {
+    concurrency = std::thread::hardware_concurrency();
+  }
+  if (concurrency <= 1 || !slice.isArray() || slice.length() < 2 ||
+      slice.byteSize() < ParallelMinSize || options->dumpMaxBytes != 0 ||
+      options->dumpMaxDepth != 0 || options->dumpMaxElements != 0) {
+    dumper.dump(slice);
+    return;
+  }
+
+  // chunk c holds the members from first[c] to first[c + 1], with the
+  // first one starting at start[c]
+  ValueLength const n = slice.length();
+  size_t const chunks = static_cast<size_t>(
+      (std::min)(n, static_cast<ValueLength>(concurrency * ParallelChunksPerThread)));
+  concurrency = (std::min)(concurrency, chunks);
+
+  std::vector<ValueLength> first(chunks + 1);
+  for (size_t c = 0; c <= chunks; ++c) {
+    first[c] = n * c / chunks;
+  }
+  std::vector<uint8_t const*> start(chunks);
+  if (slice.head() == 0x13) {
+    // no index table, the chunk starts are found by walking the members
+    uint8_t const* p = slice.at(0).start();
+    size_t c = 0;
+    for (ValueLength i = 0; c < chunks; ++i) {
+      if (i == first[c]) {
+        start[c++] = p;
+      }
+      p += Slice(p).byteSize();
     }
-    
-    case ValueType::External: {
-      Slice const external(slice->getExternal());
-      dumpValue(&external, base);
-      break;
+  } else {
+    for (size_t c = 0; c < chunks; ++c) {
+      start[c] = slice.at(first[c]).start();
     }
+  }
 
-    case ValueType::UTCDate: 
-    case ValueType::None: 
-    case ValueType::Binary: 
-    case ValueType::Illegal:
-    case ValueType::MinKey:
-    case ValueType::MaxKey: {
-      handleUnsupportedType(slice);
-      break;
+  // the workers take the next chunk that is not yet taken, while the
+  // calling thread hands the finished chunks over to the sink in order
+  std::vector<std::string> output(chunks);
+  std::vector<bool> done(chunks, false);
+  std::atomic<size_t> next(0);
+  std::atomic<bool> failed(false);
+  std::exception_ptr error;
+  std::mutex mutex;
+  std::condition_variable finished;
+  AttributeTranslator* translator = AttributeTranslator::current();
+
+  auto work = [&]() {
+    AttributeTranslatorThreadScope scope(translator);
+    while (!failed.load()) {
+      size_t const c = next++;
+      if (c >= chunks) {
+        break;
+      }
+      try {
+        StringSink chunkSink(&output[c]);
+        Dumper chunkDumper(&chunkSink, options);
+        // the members are dumped as if inside the top-level Array, so that
+        // custom type handlers see an active dump
+        chunkDumper.beginDump();
+        chunkDumper._indentation = options->prettyPrint ? 1 : 0;
+        chunkDumper._depth = 1;
+        chunkDumper.dumpArrayMembers(&slice, start[c], first[c], first[c + 1]);
+        chunkDumper.flush();
+      } catch (...) {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+        failed = true;
+      }
+      {
+        std::lock_guard<std::mutex> guard(mutex);
+        done[c] = true;
+      }
+      finished.notify_all();
+    }
+  };
+
+  // written before any thread is started, so that a throwing sink cannot
+  // leave joinable threads behind
+  sink->reserve(slice.byteSize());
+  sink->append(options->prettyPrint ? "[\n" : "[");
+
+  std::vector<std::thread> threads;
+  auto joinAll = [&]() {
+    for (auto& it : threads) {
+      it.join();
     }
+  };
 
-    case ValueType::BCD: {
-      // TODO
-      throw Exception(Exception::NotImplemented);
+  try {
+    for (size_t i = 0; i < concurrency; ++i) {
+      threads.emplace_back(work);
     }
+  } catch (...) {
+    failed = true;
+    joinAll();
+    throw;
+  }
 
-    case ValueType::Custom: {
-      if (options->customTypeHandler == nullptr) {
-        throw Exception(Exception::NeedCustomTypeHandler);
-      } else {
-        options->customTypeHandler->dump(*slice, this, *base);
+  for (size_t c = 0; c < chunks; ++c) {
+    std::string chunk;
+    {
+      std::unique_lock<std::mutex> guard(mutex);
+      finished.wait(guard, [&]() { return done[c] || failed.load(); });
+      if (failed.load()) {
+        break;
       }
-      break;
+      chunk.swap(output[c]);
+    }
+    try {
+      sink->append(chunk);
+    } catch (...) {
+      failed = true;
+      joinAll();
+      throw;
     }
   }
+  joinAll();
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  sink->push_back(']');
 }
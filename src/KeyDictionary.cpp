@@ -0,0 +1,203 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/KeyDictionary.h"
+#include "velocypack/Builder.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Validator.h"
+
+using namespace arangodb::velocypack;
+
+namespace {
+
+char const Magic[4] = { 'V', 'P', 'K', 'D' };
+
+// CRC-32 (IEEE 802.3). dictionaries are small and only checked once when
+// loading, so the bitwise variant is good enough
+uint32_t crc32(uint8_t const* data, ValueLength length) {
+  uint32_t crc = 0xffffffffUL;
+  for (ValueLength i = 0; i < length; ++i) {
+    crc ^= data[i];
+    for (int j = 0; j < 8; ++j) {
+      crc = (crc >> 1) ^ (0xedb88320UL & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+void appendLittleEndian(std::string& out, uint64_t value, int length) {
+  for (int i = 0; i < length; ++i) {
+    out.push_back(static_cast<char>(value & 0xff));
+    value >>= 8;
+  }
+}
+
+}  // namespace
+
+uint32_t const KeyDictionary::Version = 1;
+ValueLength const KeyDictionary::HeaderSize = 24;
+
+KeyDictionary::KeyDictionary(std::string const& filename)
+    : _mapping(nullptr), _mappingSize(0) {
+#ifdef _WIN32
+  std::ifstream ifs(filename, std::ifstream::in | std::ifstream::binary);
+  if (!ifs.is_open()) {
+    throw Exception(Exception::IOError,
+                    "Cannot open key dictionary file '" + filename + "'");
+  }
+  char buffer[32768];
+  while (ifs.good()) {
+    ifs.read(&buffer[0], sizeof(buffer));
+    _buffer.append(buffer, checkOverflow(ifs.gcount()));
+  }
+  load(reinterpret_cast<uint8_t const*>(_buffer.data()), _buffer.size());
+#else
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd == -1) {
+    throw Exception(Exception::IOError,
+                    "Cannot open key dictionary file '" + filename + "'");
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw Exception(Exception::IOError,
+                    "Cannot stat key dictionary file '" + filename + "'");
+  }
+  if (static_cast<ValueLength>(st.st_size) < HeaderSize) {
+    ::close(fd);
+    throw Exception(Exception::InvalidKeyDictionary,
+                    "Key dictionary file '" + filename + "' is too short");
+  }
+  _mappingSize = static_cast<size_t>(st.st_size);
+  void* mapping = ::mmap(nullptr, _mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    throw Exception(Exception::IOError,
+                    "Cannot map key dictionary file '" + filename + "'");
+  }
+  _mapping = mapping;
+  try {
+    load(static_cast<uint8_t const*>(_mapping), _mappingSize);
+  } catch (...) {
+    ::munmap(_mapping, _mappingSize);
+    throw;
+  }
+#endif
+}
+
+KeyDictionary::KeyDictionary(uint8_t const* data, ValueLength length)
+    : _buffer(reinterpret_cast<char const*>(data), checkOverflow(length)),
+      _mapping(nullptr),
+      _mappingSize(0) {
+  load(reinterpret_cast<uint8_t const*>(_buffer.data()), _buffer.size());
+}
+
+KeyDictionary::~KeyDictionary() {
+#ifndef _WIN32
+  if (_mapping != nullptr) {
+    ::munmap(_mapping, _mappingSize);
+  }
+#endif
+}
+
+void KeyDictionary::load(uint8_t const* data, ValueLength length) {
+  if (length < HeaderSize || memcmp(data, Magic, sizeof(Magic)) != 0) {
+    throw Exception(Exception::InvalidKeyDictionary,
+                    "Invalid key dictionary header");
+  }
+  uint32_t const version = readIntegerFixed<uint32_t, 4>(data + 4);
+  if (version != Version) {
+    throw Exception(Exception::InvalidKeyDictionary,
+                    "Unsupported key dictionary version " +
+                        std::to_string(version));
+  }
+  ValueLength const size = readIntegerFixed<ValueLength, 8>(data + 8);
+  if (size != length - HeaderSize) {
+    throw Exception(Exception::InvalidKeyDictionary,
+                    "Invalid key dictionary length");
+  }
+  uint8_t const* payload = data + HeaderSize;
+  if (crc32(payload, size) != readIntegerFixed<uint32_t, 4>(data + 16)) {
+    throw Exception(Exception::InvalidKeyDictionary,
+                    "Key dictionary checksum mismatch");
+  }
+
+  Validator validator;
+  try {
+    validator.validate(payload, checkOverflow(size));
+  } catch (Exception const& ex) {
+    throw Exception(Exception::InvalidKeyDictionary, ex.what());
+  }
+  _translator.load(Slice(payload));
+}
+
+std::string KeyDictionary::serialize(AttributeTranslator const& translator) {
+  Slice dictionary = translator.dictionary();
+  if (dictionary.isNone()) {
+    // translator without any keys
+    dictionary = Slice::emptyObjectSlice();
+  }
+  ValueLength const size = dictionary.byteSize();
+
+  std::string result;
+  result.reserve(checkOverflow(HeaderSize + size));
+  result.append(Magic, sizeof(Magic));
+  appendLittleEndian(result, Version, 4);
+  appendLittleEndian(result, size, 8);
+  appendLittleEndian(result, crc32(dictionary.start(), size), 4);
+  appendLittleEndian(result, 0, 4);
+  result.append(dictionary.startAs<char>(), checkOverflow(size));
+  return result;
+}
+
+void KeyDictionary::save(AttributeTranslator const& translator,
+                         std::string const& filename) {
+  std::string const data = serialize(translator);
+
+  std::ofstream ofs(filename, std::ofstream::out | std::ofstream::binary |
+                                  std::ofstream::trunc);
+  if (!ofs.is_open()) {
+    throw Exception(Exception::IOError,
+                    "Cannot write key dictionary file '" + filename + "'");
+  }
+  ofs.write(data.data(), data.size());
+  ofs.close();
+  if (ofs.fail()) {
+    throw Exception(Exception::IOError,
+                    "Cannot write key dictionary file '" + filename + "'");
+  }
+}
@@ -0,0 +1,513 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/KeyEncoder.h"
+#include "velocypack/Compare.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Iterator.h"
+#include "velocypack/Value.h"
+#include "velocypack/ValueType.h"
+
+using namespace arangodb::velocypack;
+
+namespace {
+
+// the tags are ordered like the type groups in NormalizedCompare::typeOrder()
+// and must never change, as encoded keys are persisted
+enum KeyTag : uint8_t {
+  TagEnd = 0x00,  // end of an array
+  TagMinKey = 0x08,
+  TagNone = 0x10,
+  TagIllegal = 0x11,
+  TagNull = 0x18,
+  TagFalse = 0x20,
+  TagTrue = 0x21,
+  TagNegativeInfinity = 0x28,
+  TagNegative = 0x29,
+  TagZero = 0x2a,
+  TagPositive = 0x2b,
+  TagPositiveInfinity = 0x2c,
+  TagNaN = 0x2d,
+  TagUTCDate = 0x50,
+  TagString = 0x60,
+  TagBinary = 0x68,
+  TagArray = 0x70,
+  TagObject = 0x78,
+  TagMaxKey = 0xf0
+};
+
+// markers inside objects. NormalizedCompare treats a missing attribute as
+// None, so an attribute is greater than a missing one unless its value is
+// less than None (MinKey). the keys of attributes with a value greater than
+// None are stored inverted, so that a smaller key sorts higher
+enum ObjectMarker : uint8_t {
+  MarkerLessThanNone = 0x01,
+  MarkerEnd = 0x02,
+  MarkerGreaterThanNone = 0x03
+};
+
+// numbers are stored as sign tag, biased binary exponent (2 bytes) and
+// the 64 bits following the leading one bit, all big endian. for negative
+// numbers, exponent and mantissa are inverted
+int const ExponentBias = 1100;
+ValueLength const NumberLength = 1 + 2 + 8;
+
+// position of the highest set bit
+inline int highestBit(uint64_t value) noexcept {
+  VELOCYPACK_ASSERT(value != 0);
+  int result = 0;
+  for (int shift = 32; shift > 0; shift >>= 1) {
+    if (value >> shift) {
+      value >>= shift;
+      result += shift;
+    }
+  }
+  return result;
+}
+
+void appendBigEndian(std::string& result, uint64_t value, int length) {
+  for (int i = length - 1; i >= 0; --i) {
+    result.push_back(static_cast<char>((value >> (i * 8)) & 0xff));
+  }
+}
+
+uint64_t readBigEndian(uint8_t const* p, int length) noexcept {
+  uint64_t value = 0;
+  for (int i = 0; i < length; ++i) {
+    value = (value << 8) | p[i];
+  }
+  return value;
+}
+
+// appends a number with the magnitude 1.mantissa * 2^exponent
+void appendNumber(std::string& result, bool negative, int exponent,
+                  uint64_t mantissa) {
+  uint64_t e = static_cast<uint64_t>(exponent + ExponentBias);
+  if (negative) {
+    result.push_back(static_cast<char>(TagNegative));
+    e = ~e;
+    mantissa = ~mantissa;
+  } else {
+    result.push_back(static_cast<char>(TagPositive));
+  }
+  appendBigEndian(result, e, 2);
+  appendBigEndian(result, mantissa, 8);
+}
+
+void appendInteger(std::string& result, bool negative, uint64_t magnitude) {
+  if (magnitude == 0) {
+    result.push_back(static_cast<char>(TagZero));
+    return;
+  }
+  int const bit = highestBit(magnitude);
+  appendNumber(result, negative, bit,
+               bit == 0 ? 0 : (magnitude << (64 - bit)));
+}
+
+void appendDouble(std::string& result, double value) {
+  if (value != value) {
+    result.push_back(static_cast<char>(TagNaN));
+    return;
+  }
+  if (value == 0.0) {
+    result.push_back(static_cast<char>(TagZero));
+    return;
+  }
+  if (std::isinf(value)) {
+    result.push_back(static_cast<char>(value < 0.0 ? TagNegativeInfinity
+                                                   : TagPositiveInfinity));
+    return;
+  }
+
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  bool const negative = (bits >> 63) != 0;
+  int const biased = static_cast<int>((bits >> 52) & 0x7ff);
+  uint64_t fraction = bits & 0xfffffffffffffULL;
+
+  if (biased == 0) {
+    // subnormal number: normalize it
+    int const bit = highestBit(fraction);
+    appendNumber(result, negative, bit - 1074,
+                 bit == 0 ? 0 : (fraction << (64 - bit)));
+  } else {
+    appendNumber(result, negative, biased - 1023, fraction << 12);
+  }
+}
+
+// appends bytes, escaping 0x00 as 0x00 0xff and terminating the sequence
+// with 0x00 0x01. this keeps the lexicographical order of byte sequences,
+// including the rule that a prefix sorts before the longer sequence
+void appendEscaped(std::string& result, uint8_t const* p, ValueLength length,
+                   bool invert) {
+  uint8_t const mask = invert ? 0xff : 0x00;
+  uint8_t const* end = p + length;
+  while (p < end) {
+    uint8_t const* zero = static_cast<uint8_t const*>(
+        memchr(p, 0, checkOverflow(end - p)));
+    uint8_t const* stop = (zero == nullptr) ? end : zero;
+    if (invert) {
+      while (p < stop) {
+        result.push_back(static_cast<char>(*p++ ^ mask));
+      }
+    } else {
+      result.append(reinterpret_cast<char const*>(p), checkOverflow(stop - p));
+      p = stop;
+    }
+    if (zero != nullptr) {
+      result.push_back(static_cast<char>(0x00 ^ mask));
+      result.push_back(static_cast<char>(0xff ^ mask));
+      ++p;
+    }
+  }
+  result.push_back(static_cast<char>(0x00 ^ mask));
+  result.push_back(static_cast<char>(0x01 ^ mask));
+}
+
+void encodeValue(Slice slice, std::string& result);
+
+void encodeObject(Slice slice, std::string& result) {
+  result.push_back(static_cast<char>(TagObject));
+  for (auto const& member : NormalizedCompare::sortedMembers(slice)) {
+    Slice value = member.value.resolveExternals();
+    if (value.isNone()) {
+      // equal to a missing attribute
+      continue;
+    }
+    bool const lessThanNone = value.isMinKey();
+    result.push_back(static_cast<char>(lessThanNone ? MarkerLessThanNone
+                                                    : MarkerGreaterThanNone));
+    appendEscaped(result, reinterpret_cast<uint8_t const*>(member.key),
+                  member.keyLength, !lessThanNone);
+    encodeValue(value, result);
+  }
+  result.push_back(static_cast<char>(MarkerEnd));
+}
+
+void encodeValue(Slice slice, std::string& result) {
+  slice = slice.resolveExternals();
+
+  switch (slice.type()) {
+    case ValueType::None:
+      result.push_back(static_cast<char>(TagNone));
+      break;
+    case ValueType::Illegal:
+      result.push_back(static_cast<char>(TagIllegal));
+      break;
+    case ValueType::Null:
+      result.push_back(static_cast<char>(TagNull));
+      break;
+    case ValueType::Bool:
+      result.push_back(static_cast<char>(slice.isTrue() ? TagTrue : TagFalse));
+      break;
+    case ValueType::MinKey:
+      result.push_back(static_cast<char>(TagMinKey));
+      break;
+    case ValueType::MaxKey:
+      result.push_back(static_cast<char>(TagMaxKey));
+      break;
+    case ValueType::Double:
+      appendDouble(result, slice.getDouble());
+      break;
+    case ValueType::Int:
+    case ValueType::SmallInt: {
+      int64_t const v = slice.getIntUnchecked();
+      if (v < 0) {
+        appendInteger(result, true, static_cast<uint64_t>(-(v + 1)) + 1);
+      } else {
+        appendInteger(result, false, static_cast<uint64_t>(v));
+      }
+      break;
+    }
+    case ValueType::UInt:
+      appendInteger(result, false, slice.getUIntUnchecked());
+      break;
+    case ValueType::UTCDate:
+      result.push_back(static_cast<char>(TagUTCDate));
+      appendBigEndian(result, static_cast<uint64_t>(slice.getUTCDate()) ^
+                                  0x8000000000000000ULL, 8);
+      break;
+    case ValueType::String: {
+      ValueLength length;
+      char const* p = slice.getStringUnchecked(length);
+      result.push_back(static_cast<char>(TagString));
+      appendEscaped(result, reinterpret_cast<uint8_t const*>(p), length, false);
+      break;
+    }
+    case ValueType::Binary: {
+      ValueLength length;
+      uint8_t const* p = slice.getBinary(length);
+      result.push_back(static_cast<char>(TagBinary));
+      appendEscaped(result, p, length, false);
+      break;
+    }
+    case ValueType::Array: {
+      result.push_back(static_cast<char>(TagArray));
+      ArrayIterator it(slice);
+      while (it.valid()) {
+        encodeValue(it.value(), result);
+        it.next();
+      }
+      result.push_back(static_cast<char>(TagEnd));
+      break;
+    }
+    case ValueType::Object:
+      encodeObject(slice, result);
+      break;
+    case ValueType::BCD:
+    case ValueType::Custom:
+      throw Exception(Exception::NotImplemented,
+                      "key encoding for BCD and Custom types is not implemented");
+    case ValueType::External:
+      // already resolved
+      VELOCYPACK_ASSERT(false);
+      break;
+  }
+}
+
+class KeyDecoder {
+ public:
+  KeyDecoder(uint8_t const* start, ValueLength length, Builder& builder)
+      : _start(start), _p(start), _end(start + length), _builder(builder) {}
+
+  ValueLength decode() {
+    decodeValue();
+    return static_cast<ValueLength>(_p - _start);
+  }
+
+ private:
+  [[noreturn]] static void fail() {
+    throw Exception(Exception::ParseError, "Invalid key encoding");
+  }
+
+  inline void need(ValueLength n) const {
+    if (static_cast<ValueLength>(_end - _p) < n) {
+      fail();
+    }
+  }
+
+  inline uint8_t next() {
+    need(1);
+    return *_p++;
+  }
+
+  // reads an escaped byte sequence into _scratch
+  void readEscaped(bool invert) {
+    uint8_t const mask = invert ? 0xff : 0x00;
+    _scratch.clear();
+    while (true) {
+      uint8_t c = next() ^ mask;
+      if (c == 0x00) {
+        c = next() ^ mask;
+        if (c == 0x01) {
+          return;
+        }
+        if (c != 0xff) {
+          fail();
+        }
+        _scratch.push_back(0x00);
+      } else {
+        _scratch.push_back(static_cast<char>(c));
+      }
+    }
+  }
+
+  void decodeNumber(bool negative) {
+    need(NumberLength - 1);
+    uint64_t e = readBigEndian(_p, 2);
+    uint64_t mantissa = readBigEndian(_p + 2, 8);
+    _p += NumberLength - 1;
+    if (negative) {
+      e = ~e & 0xffff;
+      mantissa = ~mantissa;
+    }
+    int const exponent = static_cast<int>(e) - ExponentBias;
+    if (exponent < -1074 || exponent > 1023) {
+      fail();
+    }
+
+    if (exponent >= 0 && exponent < 64 &&
+        (exponent == 0 ? mantissa == 0 : (mantissa << exponent) == 0)) {
+      // integral value that fits into 64 bits
+      uint64_t const magnitude =
+          (1ULL << exponent) | (exponent == 0 ? 0 : mantissa >> (64 - exponent));
+      if (!negative) {
+        _builder.add(Value(magnitude));
+        return;
+      }
+      if (magnitude <= 0x8000000000000000ULL) {
+        _builder.add(Value(static_cast<int64_t>(0 - magnitude)));
+        return;
+      }
+    }
+
+    if ((mantissa & 0xfffULL) != 0) {
+      // more precision than a double can hold
+      fail();
+    }
+    uint64_t bits;
+    if (exponent >= -1022) {
+      bits = (static_cast<uint64_t>(exponent + 1023) << 52) | (mantissa >> 12);
+    } else {
+      // subnormal number
+      int const bit = exponent + 1074;
+      bits = (1ULL << bit) | (bit == 0 ? 0 : mantissa >> (64 - bit));
+    }
+    if (negative) {
+      bits |= 0x8000000000000000ULL;
+    }
+    double v;
+    memcpy(&v, &bits, sizeof(v));
+    _builder.add(Value(v));
+  }
+
+  void decodeValue() {
+    uint8_t const tag = next();
+    switch (tag) {
+      case TagMinKey:
+        _builder.add(Value(ValueType::MinKey));
+        break;
+      case TagMaxKey:
+        _builder.add(Value(ValueType::MaxKey));
+        break;
+      case TagNone:
+        _builder.add(Slice::noneSlice());
+        break;
+      case TagIllegal:
+        _builder.add(Value(ValueType::Illegal));
+        break;
+      case TagNull:
+        _builder.add(Value(ValueType::Null));
+        break;
+      case TagFalse:
+        _builder.add(Value(false));
+        break;
+      case TagTrue:
+        _builder.add(Value(true));
+        break;
+      case TagNegativeInfinity:
+        _builder.add(Value(-std::numeric_limits<double>::infinity()));
+        break;
+      case TagNegative:
+        decodeNumber(true);
+        break;
+      case TagZero:
+        _builder.add(Value(0));
+        break;
+      case TagPositive:
+        decodeNumber(false);
+        break;
+      case TagPositiveInfinity:
+        _builder.add(Value(std::numeric_limits<double>::infinity()));
+        break;
+      case TagNaN:
+        _builder.add(Value(std::numeric_limits<double>::quiet_NaN()));
+        break;
+      case TagUTCDate: {
+        need(8);
+        uint64_t const v = readBigEndian(_p, 8) ^ 0x8000000000000000ULL;
+        _p += 8;
+        _builder.add(Value(static_cast<int64_t>(v), ValueType::UTCDate));
+        break;
+      }
+      case TagString:
+        readEscaped(false);
+        _builder.add(ValuePair(_scratch.data(), _scratch.size(),
+                               ValueType::String));
+        break;
+      case TagBinary:
+        readEscaped(false);
+        _builder.add(ValuePair(_scratch.data(), _scratch.size(),
+                               ValueType::Binary));
+        break;
+      case TagArray:
+        _builder.openArray();
+        while (true) {
+          need(1);
+          if (*_p == TagEnd) {
+            ++_p;
+            break;
+          }
+          decodeValue();
+        }
+        _builder.close();
+        break;
+      case TagObject:
+        _builder.openObject();
+        while (true) {
+          uint8_t const marker = next();
+          if (marker == MarkerEnd) {
+            break;
+          }
+          if (marker != MarkerLessThanNone && marker != MarkerGreaterThanNone) {
+            fail();
+          }
+          readEscaped(marker == MarkerGreaterThanNone);
+          _builder.add(ValuePair(_scratch.data(), _scratch.size(),
+                                 ValueType::String));
+          decodeValue();
+        }
+        _builder.close();
+        break;
+      default:
+        fail();
+    }
+  }
+
+  uint8_t const* _start;
+  uint8_t const* _p;
+  uint8_t const* _end;
+  Builder& _builder;
+  std::string _scratch;
+};
+
+}  // namespace
+
+void KeyEncoder::encode(Slice const& slice, std::string& result) {
+  encodeValue(slice, result);
+}
+
+ValueLength KeyEncoder::decode(uint8_t const* start, ValueLength length,
+                               Builder& builder) {
+  KeyDecoder decoder(start, length, builder);
+  return decoder.decode();
+}
+
+Builder KeyEncoder::decode(std::string const& key, Options const* options) {
+  Builder builder(options);
+  ValueLength const consumed =
+      decode(reinterpret_cast<uint8_t const*>(key.data()), key.size(), builder);
+  if (consumed != key.size()) {
+    throw Exception(Exception::ParseError, "Invalid key encoding");
+  }
+  return builder;
+}
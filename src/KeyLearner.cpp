@@ -0,0 +1,143 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <string>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/KeyLearner.h"
+#include "velocypack/Iterator.h"
+#include "velocypack/Slice.h"
+
+using namespace arangodb::velocypack;
+
+namespace {
+
+// the counters are halved after this many observations
+constexpr uint64_t AgingInterval = 40960;
+
+}  // namespace
+
+constexpr int KeyLearner::Depth;
+constexpr uint64_t KeyLearner::Width;
+
+KeyLearner::KeyLearner(uint32_t threshold, size_t maxKeys,
+                       ValueLength minKeyLength)
+    : _threshold((std::max)(threshold, uint32_t(1))),
+      _maxKeys(maxKeys),
+      _minKeyLength(minKeyLength),
+      _counters(Depth * Width),
+      _observations(0),
+      _epoch(0),
+      _full(maxKeys == 0),
+      _translator(new AttributeTranslator) {
+  for (auto& it : _counters) {
+    it.store(0, std::memory_order_relaxed);
+  }
+  _translator->seal();
+}
+
+void KeyLearner::observe(char const* key, ValueLength length) {
+  if (length < _minKeyLength || _full.load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  // derive the Depth counter positions from a single hash
+  uint64_t const hash = VELOCYPACK_HASH(key, checkOverflow(length), 0xa8f5e3c1);
+  uint64_t const step = (hash >> 32) | 1;
+  uint32_t estimate = UINT32_MAX;
+  for (int i = 0; i < Depth; ++i) {
+    uint64_t const slot = (hash + i * step) & (Width - 1);
+    uint32_t const value =
+        _counters[i * Width + slot].fetch_add(1, std::memory_order_relaxed) + 1;
+    estimate = (std::min)(estimate, value);
+  }
+
+  if (_observations.fetch_add(1, std::memory_order_relaxed) + 1 ==
+      AgingInterval) {
+    age();
+  }
+
+  if (estimate >= _threshold) {
+    promote(key, length);
+  }
+}
+
+std::shared_ptr<AttributeTranslator> KeyLearner::translator() const {
+  std::lock_guard<std::mutex> guard(_lock);
+  return _translator;
+}
+
+size_t KeyLearner::count() const {
+  std::lock_guard<std::mutex> guard(_lock);
+  return _translator->count();
+}
+
+// adds key to the dictionary, by creating the translator for the next
+// epoch. existing translators are never modified, as other threads may
+// still use them
+void KeyLearner::promote(char const* key, ValueLength length) {
+  std::lock_guard<std::mutex> guard(_lock);
+
+  if (_translator->translate(key, length) != nullptr) {
+    // added concurrently
+    return;
+  }
+  size_t const n = _translator->count();
+  if (n >= _maxKeys) {
+    _full.store(true, std::memory_order_relaxed);
+    return;
+  }
+
+  std::shared_ptr<AttributeTranslator> next(new AttributeTranslator);
+  Slice const dictionary = _translator->dictionary();
+  if (!dictionary.isNone()) {
+    ObjectIterator it(dictionary);
+    while (it.valid()) {
+      next->add(it.key(false).copyString(), it.value().getUInt());
+      it.next();
+    }
+  }
+  next->add(std::string(key, checkOverflow(length)), n + 1);
+  next->seal();
+
+  _translator = std::move(next);
+  _epoch.fetch_add(1, std::memory_order_release);
+  if (n + 1 >= _maxKeys) {
+    _full.store(true, std::memory_order_relaxed);
+  }
+}
+
+// halves all counters. increments that happen concurrently may get lost,
+// which is fine for an estimate
+void KeyLearner::age() {
+  std::lock_guard<std::mutex> guard(_lock);
+
+  _observations.store(0, std::memory_order_relaxed);
+  for (auto& it : _counters) {
+    it.store(it.load(std::memory_order_relaxed) / 2, std::memory_order_relaxed);
+  }
+}
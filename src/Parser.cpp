@@ -26,6 +26,8 @@
 
 #include "velocypack/velocypack-common.h"
 #include "velocypack/Parser.h"
+#include "velocypack/AttributeTranslator.h"
+#include "velocypack/KeyLearner.h"
 #include "asm-functions.h"
 
 #include <cstdlib>
@@ -47,6 +49,15 @@ ValueLength Parser::parseInternal(bool multi) {
     _pos += 3;
   }
 
+  std::unique_ptr<AttributeTranslatorThreadScope> scope;
+  if (options->keyLearner != nullptr && options->attributeTranslator == nullptr &&
+      !options->buildCanonical) {
+    // the learned translator is also installed for the current thread, as
+    // the Builder needs it for sorting translated attribute names
+    refreshLearnedKeys();
+    scope.reset(new AttributeTranslatorThreadScope(_learnedTranslator.get()));
+  }
+
   ValueLength nr = 0;
   do {
     bool haveReported = false;
@@ -492,7 +503,8 @@ void Parser::parseObject() {
       }
     }
 
-    if (!excludeAttribute && options->attributeTranslator != nullptr) {
+    if (!excludeAttribute && options->attributeTranslator != nullptr &&
+        !options->buildCanonical) {
       // check if a translation for the attribute name exists
       Slice key(_builderPtr->_start + lastPos);
 
@@ -510,6 +522,9 @@ void Parser::parseObject() {
           _builderPtr->addUInt(Slice(translated).getUInt());
         }
       }
+    } else if (!excludeAttribute && options->keyLearner != nullptr &&
+               !options->buildCanonical) {
+      learnKey(lastPos);
     }
 
     i = skipWhiteSpace("Expecting ':'");
@@ -548,6 +563,34 @@ void Parser::parseObject() {
   VELOCYPACK_ASSERT(false);
 }
 
+// translates the attribute name at keyPos with the translator learned so
+// far, or reports it to the KeyLearner if it has no id yet
+void Parser::learnKey(ValueLength keyPos) {
+  KeyLearner* learner = options->keyLearner;
+  if (learner->epoch() != _learnedEpoch) {
+    refreshLearnedKeys();
+    AttributeTranslator::setThreadTranslator(_learnedTranslator.get());
+  }
+
+  Slice key(_builderPtr->_start + keyPos);
+  ValueLength keyLength;
+  char const* p = key.getString(keyLength);
+  uint8_t const* translated = _learnedTranslator->translate(p, keyLength);
+
+  if (translated != nullptr) {
+    _builderPtr->resetTo(keyPos);
+    _builderPtr->addUInt(Slice(translated).getUInt());
+  } else {
+    learner->observe(p, keyLength);
+  }
+}
+
+void Parser::refreshLearnedKeys() {
+  KeyLearner* learner = options->keyLearner;
+  _learnedEpoch = learner->epoch();
+  _learnedTranslator = learner->translator();
+}
+
 void Parser::parseJson() {
   skipWhiteSpace("Expecting item"); // return value intentionally not checked
 
@@ -0,0 +1,207 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <istream>
+#include <string>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Reader.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Slice.h"
+#include "velocypack/Validator.h"
+
+using namespace arangodb::velocypack;
+
+namespace {
+
+// returns the byte size of the value at ptr, or 0 if its length field is
+// not completely contained in the available bytes yet
+ValueLength readByteSize(uint8_t const* ptr, ValueLength available) {
+  uint8_t const head = *ptr;
+  if (SliceStaticData::TypeMap[head] == ValueType::None && head != 0x00U) {
+    throw Exception(Exception::ValidatorInvalidType);
+  }
+
+  ValueLength byteSize = SliceStaticData::FixedTypeLengths[head];
+  if (byteSize != 0) {
+    return byteSize;
+  }
+
+  unsigned int const width = SliceStaticData::LengthFieldWidths[head];
+  if (width != 0) {
+    if (available < 1 + width) {
+      return 0;
+    }
+    ValueLength const value = readIntegerNonEmpty<ValueLength>(ptr + 1, width);
+    byteSize = SliceStaticData::LengthFieldBases[head] + value;
+    if (byteSize < value || byteSize < 1 + width) {
+      throw Exception(Exception::ValidatorInvalidLength, "Value length is out of bounds");
+    }
+    return byteSize;
+  }
+
+  if (head != 0x13U && head != 0x14U) {
+    throw Exception(Exception::ValidatorInvalidType);
+  }
+  // compact Array or Object, the byte size is stored as a variable length
+  // value after the head byte
+  unsigned int shift = 0;
+  for (ValueLength i = 1; i < available; ++i) {
+    byteSize |= static_cast<ValueLength>(ptr[i] & 0x7fU) << shift;
+    if ((ptr[i] & 0x80U) == 0) {
+      if (byteSize <= i) {
+        throw Exception(Exception::ValidatorInvalidLength, "Value length is out of bounds");
+      }
+      return byteSize;
+    }
+    shift += 7;
+    if (shift >= 64) {
+      throw Exception(Exception::ValidatorInvalidLength, "Value length is out of bounds");
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+ValueLength const Reader::DefaultBufferSize = 4 * 1024 * 1024;
+
+Reader::Reader(int fd, Validator const* validator, ValueLength bufferSize)
+    : _fd(fd),
+      _in(nullptr),
+      _validator(validator),
+      _offset(0),
+      _bufferPosition(0),
+      _position(0),
+      _eof(false) {
+  _buffer.reserve(bufferSize);
+}
+
+Reader::Reader(std::istream& in, Validator const* validator, ValueLength bufferSize)
+    : _fd(-1),
+      _in(&in),
+      _validator(validator),
+      _offset(0),
+      _bufferPosition(0),
+      _position(0),
+      _eof(false) {
+  _buffer.reserve(bufferSize);
+}
+
+bool Reader::next(Slice& slice) {
+  ValueLength byteSize = 0;
+  while (true) {
+    ValueLength const available = _buffer.size() - _offset;
+    if (available > 0) {
+      byteSize = readByteSize(_buffer.data() + _offset, available);
+      if (byteSize != 0 && byteSize <= available) {
+        break;
+      }
+    }
+    if (_eof) {
+      if (available == 0) {
+        return false;
+      }
+      throw Exception(Exception::ValidatorInvalidLength,
+                      "VPack value at offset " +
+                          std::to_string(_bufferPosition + _offset) +
+                          " is truncated");
+    }
+    refill(byteSize);
+  }
+
+  uint8_t const* start = _buffer.data() + _offset;
+  if (_validator != nullptr) {
+    _validator->validate(start, checkOverflow(byteSize));
+  }
+  _position = _bufferPosition + _offset;
+  _offset += byteSize;
+  slice = Slice(start);
+  return true;
+}
+
+void Reader::refill(ValueLength needed) {
+  ValueLength const remaining = _buffer.size() - _offset;
+  if (_offset > 0) {
+    // the start of an incomplete value, if any
+    uint8_t* data = _buffer.data();
+    memmove(data, data + _offset, checkOverflow(remaining));
+    _bufferPosition += _offset;
+    _offset = 0;
+    _buffer.resetTo(remaining);
+  }
+  if (needed > _buffer.capacity()) {
+    // the value does not fit into the buffer. grow it at most by a factor
+    // of 2 at a time, so that a corrupted length field cannot make us
+    // allocate much more memory than there is input
+    ValueLength const target = (std::min)(needed, 2 * _buffer.capacity());
+    _buffer.reserve(target - remaining);
+  }
+
+  size_t const n = read(_buffer.data() + remaining,
+                        checkOverflow(_buffer.capacity() - remaining));
+  if (n == 0) {
+    _eof = true;
+  } else {
+    _buffer.advance(n);
+  }
+}
+
+size_t Reader::read(uint8_t* dst, size_t length) {
+  if (_in != nullptr) {
+    _in->read(reinterpret_cast<char*>(dst), static_cast<std::streamsize>(length));
+    if (_in->bad()) {
+      throw Exception(Exception::IOError, "Cannot read from input stream");
+    }
+    return checkOverflow(static_cast<ValueLength>(_in->gcount()));
+  }
+
+  while (true) {
+#ifdef _WIN32
+    int n = ::_read(_fd, dst, static_cast<unsigned int>((std::min)(length, static_cast<size_t>(INT_MAX))));
+#else
+    ssize_t n = ::read(_fd, dst, (std::min)(length, static_cast<size_t>(SSIZE_MAX)));
+#endif
+    if (n >= 0) {
+      return static_cast<size_t>(n);
+    }
+    if (errno != EINTR) {
+      throw Exception(Exception::IOError,
+                      std::string("Cannot read from file descriptor: ") +
+                          strerror(errno));
+    }
+  }
+}
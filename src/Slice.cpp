@@ -169,6 +169,269 @@ uint8_t const SliceStaticData::FixedTypeLengths[256] = {
     /* 0xfc */ 0,                    /* 0xfd */ 0,
     /* 0xfe */ 0,                    /* 0xff */ 0};
  
+// width of the length field following the head byte, for types with a
+// dynamic length (0 = no length field or variable-length encoding)
+uint8_t const SliceStaticData::LengthFieldWidths[256] = {
+    /* 0x00 */ 0,                    /* 0x01 */ 0,
+    /* 0x02 */ 1,                    /* 0x03 */ 2,
+    /* 0x04 */ 4,                    /* 0x05 */ 8,
+    /* 0x06 */ 1,                    /* 0x07 */ 2,
+    /* 0x08 */ 4,                    /* 0x09 */ 8,
+    /* 0x0a */ 0,                    /* 0x0b */ 1,
+    /* 0x0c */ 2,                    /* 0x0d */ 4,
+    /* 0x0e */ 8,                    /* 0x0f */ 1,
+    /* 0x10 */ 2,                    /* 0x11 */ 4,
+    /* 0x12 */ 8,                    /* 0x13 */ 0,
+    /* 0x14 */ 0,                    /* 0x15 */ 4,
+    /* 0x16 */ 0,                    /* 0x17 */ 0,
+    /* 0x18 */ 0,                    /* 0x19 */ 0,
+    /* 0x1a */ 0,                    /* 0x1b */ 0,
+    /* 0x1c */ 0,                    /* 0x1d */ 0,
+    /* 0x1e */ 0,                    /* 0x1f */ 0,
+    /* 0x20 */ 0,                    /* 0x21 */ 0,
+    /* 0x22 */ 0,                    /* 0x23 */ 0,
+    /* 0x24 */ 0,                    /* 0x25 */ 0,
+    /* 0x26 */ 0,                    /* 0x27 */ 0,
+    /* 0x28 */ 0,                    /* 0x29 */ 0,
+    /* 0x2a */ 0,                    /* 0x2b */ 0,
+    /* 0x2c */ 0,                    /* 0x2d */ 0,
+    /* 0x2e */ 0,                    /* 0x2f */ 0,
+    /* 0x30 */ 0,                    /* 0x31 */ 0,
+    /* 0x32 */ 0,                    /* 0x33 */ 0,
+    /* 0x34 */ 0,                    /* 0x35 */ 0,
+    /* 0x36 */ 0,                    /* 0x37 */ 0,
+    /* 0x38 */ 0,                    /* 0x39 */ 0,
+    /* 0x3a */ 0,                    /* 0x3b */ 0,
+    /* 0x3c */ 0,                    /* 0x3d */ 0,
+    /* 0x3e */ 0,                    /* 0x3f */ 0,
+    /* 0x40 */ 0,                    /* 0x41 */ 0,
+    /* 0x42 */ 0,                    /* 0x43 */ 0,
+    /* 0x44 */ 0,                    /* 0x45 */ 0,
+    /* 0x46 */ 0,                    /* 0x47 */ 0,
+    /* 0x48 */ 0,                    /* 0x49 */ 0,
+    /* 0x4a */ 0,                    /* 0x4b */ 0,
+    /* 0x4c */ 0,                    /* 0x4d */ 0,
+    /* 0x4e */ 0,                    /* 0x4f */ 0,
+    /* 0x50 */ 0,                    /* 0x51 */ 0,
+    /* 0x52 */ 0,                    /* 0x53 */ 0,
+    /* 0x54 */ 0,                    /* 0x55 */ 0,
+    /* 0x56 */ 0,                    /* 0x57 */ 0,
+    /* 0x58 */ 0,                    /* 0x59 */ 0,
+    /* 0x5a */ 0,                    /* 0x5b */ 0,
+    /* 0x5c */ 0,                    /* 0x5d */ 0,
+    /* 0x5e */ 0,                    /* 0x5f */ 0,
+    /* 0x60 */ 0,                    /* 0x61 */ 0,
+    /* 0x62 */ 0,                    /* 0x63 */ 0,
+    /* 0x64 */ 0,                    /* 0x65 */ 0,
+    /* 0x66 */ 0,                    /* 0x67 */ 0,
+    /* 0x68 */ 0,                    /* 0x69 */ 0,
+    /* 0x6a */ 0,                    /* 0x6b */ 0,
+    /* 0x6c */ 0,                    /* 0x6d */ 0,
+    /* 0x6e */ 0,                    /* 0x6f */ 0,
+    /* 0x70 */ 0,                    /* 0x71 */ 0,
+    /* 0x72 */ 0,                    /* 0x73 */ 0,
+    /* 0x74 */ 0,                    /* 0x75 */ 0,
+    /* 0x76 */ 0,                    /* 0x77 */ 0,
+    /* 0x78 */ 0,                    /* 0x79 */ 0,
+    /* 0x7a */ 0,                    /* 0x7b */ 0,
+    /* 0x7c */ 0,                    /* 0x7d */ 0,
+    /* 0x7e */ 0,                    /* 0x7f */ 0,
+    /* 0x80 */ 0,                    /* 0x81 */ 0,
+    /* 0x82 */ 0,                    /* 0x83 */ 0,
+    /* 0x84 */ 0,                    /* 0x85 */ 0,
+    /* 0x86 */ 0,                    /* 0x87 */ 0,
+    /* 0x88 */ 0,                    /* 0x89 */ 0,
+    /* 0x8a */ 0,                    /* 0x8b */ 0,
+    /* 0x8c */ 0,                    /* 0x8d */ 0,
+    /* 0x8e */ 0,                    /* 0x8f */ 0,
+    /* 0x90 */ 0,                    /* 0x91 */ 0,
+    /* 0x92 */ 0,                    /* 0x93 */ 0,
+    /* 0x94 */ 0,                    /* 0x95 */ 0,
+    /* 0x96 */ 0,                    /* 0x97 */ 0,
+    /* 0x98 */ 0,                    /* 0x99 */ 0,
+    /* 0x9a */ 0,                    /* 0x9b */ 0,
+    /* 0x9c */ 0,                    /* 0x9d */ 0,
+    /* 0x9e */ 0,                    /* 0x9f */ 0,
+    /* 0xa0 */ 0,                    /* 0xa1 */ 0,
+    /* 0xa2 */ 0,                    /* 0xa3 */ 0,
+    /* 0xa4 */ 0,                    /* 0xa5 */ 0,
+    /* 0xa6 */ 0,                    /* 0xa7 */ 0,
+    /* 0xa8 */ 0,                    /* 0xa9 */ 0,
+    /* 0xaa */ 0,                    /* 0xab */ 0,
+    /* 0xac */ 0,                    /* 0xad */ 0,
+    /* 0xae */ 0,                    /* 0xaf */ 0,
+    /* 0xb0 */ 0,                    /* 0xb1 */ 0,
+    /* 0xb2 */ 0,                    /* 0xb3 */ 0,
+    /* 0xb4 */ 0,                    /* 0xb5 */ 0,
+    /* 0xb6 */ 0,                    /* 0xb7 */ 0,
+    /* 0xb8 */ 0,                    /* 0xb9 */ 0,
+    /* 0xba */ 0,                    /* 0xbb */ 0,
+    /* 0xbc */ 0,                    /* 0xbd */ 0,
+    /* 0xbe */ 0,                    /* 0xbf */ 8,
+    /* 0xc0 */ 1,                    /* 0xc1 */ 2,
+    /* 0xc2 */ 3,                    /* 0xc3 */ 4,
+    /* 0xc4 */ 5,                    /* 0xc5 */ 6,
+    /* 0xc6 */ 7,                    /* 0xc7 */ 8,
+    /* 0xc8 */ 1,                    /* 0xc9 */ 2,
+    /* 0xca */ 3,                    /* 0xcb */ 4,
+    /* 0xcc */ 5,                    /* 0xcd */ 6,
+    /* 0xce */ 7,                    /* 0xcf */ 8,
+    /* 0xd0 */ 1,                    /* 0xd1 */ 2,
+    /* 0xd2 */ 3,                    /* 0xd3 */ 4,
+    /* 0xd4 */ 5,                    /* 0xd5 */ 6,
+    /* 0xd6 */ 7,                    /* 0xd7 */ 8,
+    /* 0xd8 */ 0,                    /* 0xd9 */ 0,
+    /* 0xda */ 0,                    /* 0xdb */ 0,
+    /* 0xdc */ 0,                    /* 0xdd */ 0,
+    /* 0xde */ 0,                    /* 0xdf */ 0,
+    /* 0xe0 */ 0,                    /* 0xe1 */ 0,
+    /* 0xe2 */ 0,                    /* 0xe3 */ 0,
+    /* 0xe4 */ 0,                    /* 0xe5 */ 0,
+    /* 0xe6 */ 0,                    /* 0xe7 */ 0,
+    /* 0xe8 */ 0,                    /* 0xe9 */ 0,
+    /* 0xea */ 0,                    /* 0xeb */ 0,
+    /* 0xec */ 0,                    /* 0xed */ 0,
+    /* 0xee */ 0,                    /* 0xef */ 0,
+    /* 0xf0 */ 0,                    /* 0xf1 */ 0,
+    /* 0xf2 */ 0,                    /* 0xf3 */ 0,
+    /* 0xf4 */ 1,                    /* 0xf5 */ 1,
+    /* 0xf6 */ 1,                    /* 0xf7 */ 2,
+    /* 0xf8 */ 2,                    /* 0xf9 */ 2,
+    /* 0xfa */ 4,                    /* 0xfb */ 4,
+    /* 0xfc */ 4,                    /* 0xfd */ 8,
+    /* 0xfe */ 8,                    /* 0xff */ 8};
+
+// value to add to the length field to get the total byte size
+uint8_t const SliceStaticData::LengthFieldBases[256] = {
+    /* 0x00 */ 0,                    /* 0x01 */ 0,
+    /* 0x02 */ 0,                    /* 0x03 */ 0,
+    /* 0x04 */ 0,                    /* 0x05 */ 0,
+    /* 0x06 */ 0,                    /* 0x07 */ 0,
+    /* 0x08 */ 0,                    /* 0x09 */ 0,
+    /* 0x0a */ 0,                    /* 0x0b */ 0,
+    /* 0x0c */ 0,                    /* 0x0d */ 0,
+    /* 0x0e */ 0,                    /* 0x0f */ 0,
+    /* 0x10 */ 0,                    /* 0x11 */ 0,
+    /* 0x12 */ 0,                    /* 0x13 */ 0,
+    /* 0x14 */ 0,                    /* 0x15 */ 0,
+    /* 0x16 */ 0,                    /* 0x17 */ 0,
+    /* 0x18 */ 0,                    /* 0x19 */ 0,
+    /* 0x1a */ 0,                    /* 0x1b */ 0,
+    /* 0x1c */ 0,                    /* 0x1d */ 0,
+    /* 0x1e */ 0,                    /* 0x1f */ 0,
+    /* 0x20 */ 0,                    /* 0x21 */ 0,
+    /* 0x22 */ 0,                    /* 0x23 */ 0,
+    /* 0x24 */ 0,                    /* 0x25 */ 0,
+    /* 0x26 */ 0,                    /* 0x27 */ 0,
+    /* 0x28 */ 0,                    /* 0x29 */ 0,
+    /* 0x2a */ 0,                    /* 0x2b */ 0,
+    /* 0x2c */ 0,                    /* 0x2d */ 0,
+    /* 0x2e */ 0,                    /* 0x2f */ 0,
+    /* 0x30 */ 0,                    /* 0x31 */ 0,
+    /* 0x32 */ 0,                    /* 0x33 */ 0,
+    /* 0x34 */ 0,                    /* 0x35 */ 0,
+    /* 0x36 */ 0,                    /* 0x37 */ 0,
+    /* 0x38 */ 0,                    /* 0x39 */ 0,
+    /* 0x3a */ 0,                    /* 0x3b */ 0,
+    /* 0x3c */ 0,                    /* 0x3d */ 0,
+    /* 0x3e */ 0,                    /* 0x3f */ 0,
+    /* 0x40 */ 0,                    /* 0x41 */ 0,
+    /* 0x42 */ 0,                    /* 0x43 */ 0,
+    /* 0x44 */ 0,                    /* 0x45 */ 0,
+    /* 0x46 */ 0,                    /* 0x47 */ 0,
+    /* 0x48 */ 0,                    /* 0x49 */ 0,
+    /* 0x4a */ 0,                    /* 0x4b */ 0,
+    /* 0x4c */ 0,                    /* 0x4d */ 0,
+    /* 0x4e */ 0,                    /* 0x4f */ 0,
+    /* 0x50 */ 0,                    /* 0x51 */ 0,
+    /* 0x52 */ 0,                    /* 0x53 */ 0,
+    /* 0x54 */ 0,                    /* 0x55 */ 0,
+    /* 0x56 */ 0,                    /* 0x57 */ 0,
+    /* 0x58 */ 0,                    /* 0x59 */ 0,
+    /* 0x5a */ 0,                    /* 0x5b */ 0,
+    /* 0x5c */ 0,                    /* 0x5d */ 0,
+    /* 0x5e */ 0,                    /* 0x5f */ 0,
+    /* 0x60 */ 0,                    /* 0x61 */ 0,
+    /* 0x62 */ 0,                    /* 0x63 */ 0,
+    /* 0x64 */ 0,                    /* 0x65 */ 0,
+    /* 0x66 */ 0,                    /* 0x67 */ 0,
+    /* 0x68 */ 0,                    /* 0x69 */ 0,
+    /* 0x6a */ 0,                    /* 0x6b */ 0,
+    /* 0x6c */ 0,                    /* 0x6d */ 0,
+    /* 0x6e */ 0,                    /* 0x6f */ 0,
+    /* 0x70 */ 0,                    /* 0x71 */ 0,
+    /* 0x72 */ 0,                    /* 0x73 */ 0,
+    /* 0x74 */ 0,                    /* 0x75 */ 0,
+    /* 0x76 */ 0,                    /* 0x77 */ 0,
+    /* 0x78 */ 0,                    /* 0x79 */ 0,
+    /* 0x7a */ 0,                    /* 0x7b */ 0,
+    /* 0x7c */ 0,                    /* 0x7d */ 0,
+    /* 0x7e */ 0,                    /* 0x7f */ 0,
+    /* 0x80 */ 0,                    /* 0x81 */ 0,
+    /* 0x82 */ 0,                    /* 0x83 */ 0,
+    /* 0x84 */ 0,                    /* 0x85 */ 0,
+    /* 0x86 */ 0,                    /* 0x87 */ 0,
+    /* 0x88 */ 0,                    /* 0x89 */ 0,
+    /* 0x8a */ 0,                    /* 0x8b */ 0,
+    /* 0x8c */ 0,                    /* 0x8d */ 0,
+    /* 0x8e */ 0,                    /* 0x8f */ 0,
+    /* 0x90 */ 0,                    /* 0x91 */ 0,
+    /* 0x92 */ 0,                    /* 0x93 */ 0,
+    /* 0x94 */ 0,                    /* 0x95 */ 0,
+    /* 0x96 */ 0,                    /* 0x97 */ 0,
+    /* 0x98 */ 0,                    /* 0x99 */ 0,
+    /* 0x9a */ 0,                    /* 0x9b */ 0,
+    /* 0x9c */ 0,                    /* 0x9d */ 0,
+    /* 0x9e */ 0,                    /* 0x9f */ 0,
+    /* 0xa0 */ 0,                    /* 0xa1 */ 0,
+    /* 0xa2 */ 0,                    /* 0xa3 */ 0,
+    /* 0xa4 */ 0,                    /* 0xa5 */ 0,
+    /* 0xa6 */ 0,                    /* 0xa7 */ 0,
+    /* 0xa8 */ 0,                    /* 0xa9 */ 0,
+    /* 0xaa */ 0,                    /* 0xab */ 0,
+    /* 0xac */ 0,                    /* 0xad */ 0,
+    /* 0xae */ 0,                    /* 0xaf */ 0,
+    /* 0xb0 */ 0,                    /* 0xb1 */ 0,
+    /* 0xb2 */ 0,                    /* 0xb3 */ 0,
+    /* 0xb4 */ 0,                    /* 0xb5 */ 0,
+    /* 0xb6 */ 0,                    /* 0xb7 */ 0,
+    /* 0xb8 */ 0,                    /* 0xb9 */ 0,
+    /* 0xba */ 0,                    /* 0xbb */ 0,
+    /* 0xbc */ 0,                    /* 0xbd */ 0,
+    /* 0xbe */ 0,                    /* 0xbf */ 9,
+    /* 0xc0 */ 2,                    /* 0xc1 */ 3,
+    /* 0xc2 */ 4,                    /* 0xc3 */ 5,
+    /* 0xc4 */ 6,                    /* 0xc5 */ 7,
+    /* 0xc6 */ 8,                    /* 0xc7 */ 9,
+    /* 0xc8 */ 2,                    /* 0xc9 */ 3,
+    /* 0xca */ 4,                    /* 0xcb */ 5,
+    /* 0xcc */ 6,                    /* 0xcd */ 7,
+    /* 0xce */ 8,                    /* 0xcf */ 9,
+    /* 0xd0 */ 2,                    /* 0xd1 */ 3,
+    /* 0xd2 */ 4,                    /* 0xd3 */ 5,
+    /* 0xd4 */ 6,                    /* 0xd5 */ 7,
+    /* 0xd6 */ 8,                    /* 0xd7 */ 9,
+    /* 0xd8 */ 0,                    /* 0xd9 */ 0,
+    /* 0xda */ 0,                    /* 0xdb */ 0,
+    /* 0xdc */ 0,                    /* 0xdd */ 0,
+    /* 0xde */ 0,                    /* 0xdf */ 0,
+    /* 0xe0 */ 0,                    /* 0xe1 */ 0,
+    /* 0xe2 */ 0,                    /* 0xe3 */ 0,
+    /* 0xe4 */ 0,                    /* 0xe5 */ 0,
+    /* 0xe6 */ 0,                    /* 0xe7 */ 0,
+    /* 0xe8 */ 0,                    /* 0xe9 */ 0,
+    /* 0xea */ 0,                    /* 0xeb */ 0,
+    /* 0xec */ 0,                    /* 0xed */ 0,
+    /* 0xee */ 0,                    /* 0xef */ 0,
+    /* 0xf0 */ 0,                    /* 0xf1 */ 0,
+    /* 0xf2 */ 0,                    /* 0xf3 */ 0,
+    /* 0xf4 */ 2,                    /* 0xf5 */ 2,
+    /* 0xf6 */ 2,                    /* 0xf7 */ 3,
+    /* 0xf8 */ 3,                    /* 0xf9 */ 3,
+    /* 0xfa */ 5,                    /* 0xfb */ 5,
+    /* 0xfc */ 5,                    /* 0xfd */ 9,
+    /* 0xfe */ 9,                    /* 0xff */ 9};
+
 VT const SliceStaticData::TypeMap[256] = {
     /* 0x00 */ VT::None,     /* 0x01 */ VT::Array,
     /* 0x02 */ VT::Array,    /* 0x03 */ VT::Array,
@@ -180,7 +443,7 @@ VT const SliceStaticData::TypeMap[256] = {
     /* 0x0e */ VT::Object,   /* 0x0f */ VT::Object,
     /* 0x10 */ VT::Object,   /* 0x11 */ VT::Object,
     /* 0x12 */ VT::Object,   /* 0x13 */ VT::Array,
-    /* 0x14 */ VT::Object,   /* 0x15 */ VT::None,
+    /* 0x14 */ VT::Object,   /* 0x15 */ VT::Object,
     /* 0x16 */ VT::None,     /* 0x17 */ VT::Illegal,
     /* 0x18 */ VT::Null,     /* 0x19 */ VT::Bool,
     /* 0x1a */ VT::Bool,     /* 0x1b */ VT::Double,
@@ -319,6 +582,9 @@ unsigned int const SliceStaticData::WidthMap[32] = {
     2,  // 0x10, object with unsorted index table
     4,  // 0x11, object with unsorted index table
     8,  // 0x12, object with unsorted index table
+    0,  // 0x13, compact array, no index table
+    0,  // 0x14, compact object, no index table
+    4,  // 0x15, object with hash table and sorted index table
     0};
 
 unsigned int const SliceStaticData::FirstSubMap[32] = {
@@ -343,6 +609,7 @@ unsigned int const SliceStaticData::FirstSubMap[32] = {
     9,  // 0x12, object with unsorted index table,
     0,  // 0x13, compact array, no index table - note: the offset is dynamic!
     0,  // 0x14, compact object, no index table - note: the offset is dynamic!
+    0,  // 0x15, object with hash table - note: the offset is dynamic!
     0};
 
 uint64_t const SliceStaticData::PrecalculatedHashesForDefaultSeed[256] = {
@@ -624,10 +891,11 @@ Slice Slice::translate() const {
     throw Exception(Exception::InvalidValueType,
                     "Cannot translate key of this type");
   }
-  if (Options::Defaults.attributeTranslator == nullptr) {
+  AttributeTranslator const* translator = AttributeTranslator::current();
+  if (translator == nullptr) {
     throw Exception(Exception::NeedAttributeTranslator);
   }
-  return translateUnchecked();
+  return translateUnchecked(translator);
 }
 
 // return the value for a UInt object, without checks!
@@ -672,7 +940,12 @@ int64_t Slice::getSmallIntUnchecked() const noexcept {
 
 // translates an integer key into a string, without checks
 Slice Slice::translateUnchecked() const {
-  uint8_t const* result = Options::Defaults.attributeTranslator->translate(getUIntUnchecked());
+  return translateUnchecked(AttributeTranslator::current());
+}
+
+// translates an integer key into a string using translator, without checks
+Slice Slice::translateUnchecked(AttributeTranslator const* translator) const {
+  uint8_t const* result = translator->translate(getUIntUnchecked());
   if (result != nullptr) {
     return Slice(result);
   }
@@ -705,43 +978,248 @@ std::string Slice::toString(Options const* options) const {
 
 std::string Slice::hexType() const { return HexDump::toHex(head()); }
   
-uint64_t Slice::normalizedHash(uint64_t seed) const {
-  uint64_t value;
-
-  if (isNumber()) {
-    // upcast integer values to double
-    double v = getNumericValue<double>();
-    value = VELOCYPACK_HASH(&v, sizeof(v), seed);
-  } else if (isArray()) {
-    // normalize arrays by hashing array length and iterating
-    // over all array members
-    ArrayIterator it(*this);
-    uint64_t const n = it.size() ^ 0xba5bedf00d;
-    value = VELOCYPACK_HASH(&n, sizeof(n), seed);
-    while (it.valid()) {
-      value ^= it.value().normalizedHash(value);
-      it.next();
+namespace {
+
+// incremental hash state used by normalizedHash(). the hash function is
+// defined here and not via VELOCYPACK_HASH, so the results do not depend
+// on the hash function the library was built with. each lane uses the
+// xxHash64 round function with its own constants
+template<int Lanes>
+struct NormalizedHashState {
+  static_assert(Lanes == 1 || Lanes == 2, "invalid number of lanes");
+
+  uint64_t lanes[Lanes];
+
+  explicit NormalizedHashState(uint64_t seed) noexcept {
+    for (int i = 0; i < Lanes; ++i) {
+      lanes[i] = seed + Primes[i][2];
     }
-  } else if (isObject()) {
-    // normalize objects by hashing object length and iterating
-    // over all object members
-    ObjectIterator it(*this, true);
-    uint64_t const n = it.size() ^ 0xf00ba44ba5;
-    uint64_t seed2 = VELOCYPACK_HASH(&n, sizeof(n), seed);
-    value = seed2;
-    while (it.valid()) {
-      auto current = (*it);
-      uint64_t seed3 = current.key.normalizedHash(seed2);
-      value ^= seed3;
-      value ^= current.value.normalizedHash(seed3);
-      it.next();
+  }
+
+  inline void add(uint64_t value) noexcept {
+    for (int i = 0; i < Lanes; ++i) {
+      lanes[i] = round(lanes[i], value, i);
     }
-  } else {
-    // fall back to regular hash function
-    value = hash(seed);
   }
 
-  return value;
+  // adds a different value to each lane
+  inline void add(uint64_t const* values) noexcept {
+    for (int i = 0; i < Lanes; ++i) {
+      lanes[i] = round(lanes[i], values[i], i);
+    }
+  }
+
+  void addBytes(uint8_t const* p, ValueLength length) noexcept {
+    add(length);
+    while (length >= 8) {
+      add(readIntegerFixed<uint64_t, 8>(p));
+      p += 8;
+      length -= 8;
+    }
+    if (length > 0) {
+      add(readIntegerNonEmpty<uint64_t>(p, length));
+    }
+  }
+
+  inline uint64_t finish(int lane) const noexcept {
+    // murmur3 finalizer
+    uint64_t h = lanes[lane];
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+  }
+
+ private:
+  static inline uint64_t round(uint64_t acc, uint64_t value, int lane) noexcept {
+    acc += value * Primes[lane][1];
+    acc = (acc << 31) | (acc >> 33);
+    return acc * Primes[lane][0];
+  }
+
+  static constexpr uint64_t Primes[2][3] = {
+    { 0x9E3779B185EBCA87ULL, 0xC2B2AE3D27D4EB4FULL, 0x27D4EB2F165667C5ULL },
+    { 0x165667B19E3779F9ULL, 0x85EBCA77C2B2AE63ULL, 0x94D049BB133111EBULL }
+  };
+};
+
+template<int Lanes>
+constexpr uint64_t NormalizedHashState<Lanes>::Primes[2][3];
+
+// type tags fed into the hash state. values of the same type group must
+// use the same tag, and the tags must never change
+enum NormalizedHashTag : uint64_t {
+  TagNone = 0x4e6f6e65,
+  TagIllegal = 0x496c6c65,
+  TagNull = 0x4e756c6c,
+  TagFalse = 0x46616c73,
+  TagTrue = 0x54727565,
+  TagNumber = 0x4e756d62,
+  TagString = 0x53747269,
+  TagArray = 0x41727261,
+  TagObject = 0x4f626a65,
+  TagUTCDate = 0x55544344,
+  TagMinKey = 0x4d696e4b,
+  TagMaxKey = 0x4d61784b,
+  TagBinary = 0x42696e61,
+  TagBCD = 0x42434420,
+  TagCustom = 0x43757374,
+  TagObjectMember = 0x4d656d62
+};
+
+// IEEE-754 bit patterns of the SmallInt values 0 to 9 and -6 to -1, so
+// that SmallInts hash the same as the equivalent doubles
+uint64_t const SmallIntDoubleBits[16] = {
+  0x0000000000000000ULL, 0x3ff0000000000000ULL, 0x4000000000000000ULL,
+  0x4008000000000000ULL, 0x4010000000000000ULL, 0x4014000000000000ULL,
+  0x4018000000000000ULL, 0x401c000000000000ULL, 0x4020000000000000ULL,
+  0x4022000000000000ULL, 0xc018000000000000ULL, 0xc014000000000000ULL,
+  0xc010000000000000ULL, 0xc008000000000000ULL, 0xc000000000000000ULL,
+  0xbff0000000000000ULL
+};
+
+inline uint64_t normalizedDoubleBits(double v) noexcept {
+  if (v == 0.0) {
+    // -0.0 == 0.0
+    return 0;
+  }
+  if (v != v) {
+    // all NaNs are hashed the same
+    return 0x7ff8000000000000ULL;
+  }
+  uint64_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  return bits;
+}
+
+template<int Lanes>
+void hashNormalized(Slice slice, NormalizedHashState<Lanes>& state) {
+  uint8_t const h = slice.head();
+
+  if (h >= 0x30 && h <= 0x3f) {
+    // SmallInt
+    state.add(TagNumber);
+    state.add(SmallIntDoubleBits[h - 0x30]);
+    return;
+  }
+  if (h >= 0x40 && h <= 0xbe) {
+    // short String
+    state.add(TagString);
+    state.addBytes(slice.start() + 1, h - 0x40);
+    return;
+  }
+
+  switch (slice.type()) {
+    case ValueType::None:
+      state.add(TagNone);
+      break;
+    case ValueType::Illegal:
+      state.add(TagIllegal);
+      break;
+    case ValueType::Null:
+      state.add(TagNull);
+      break;
+    case ValueType::Bool:
+      state.add(slice.isTrue() ? TagTrue : TagFalse);
+      break;
+    case ValueType::MinKey:
+      state.add(TagMinKey);
+      break;
+    case ValueType::MaxKey:
+      state.add(TagMaxKey);
+      break;
+    case ValueType::Double:
+      state.add(TagNumber);
+      state.add(normalizedDoubleBits(slice.getDouble()));
+      break;
+    case ValueType::Int:
+      state.add(TagNumber);
+      state.add(normalizedDoubleBits(static_cast<double>(slice.getIntUnchecked())));
+      break;
+    case ValueType::UInt:
+      state.add(TagNumber);
+      state.add(normalizedDoubleBits(static_cast<double>(slice.getUIntUnchecked())));
+      break;
+    case ValueType::SmallInt:
+      // handled above
+      VELOCYPACK_ASSERT(false);
+      break;
+    case ValueType::UTCDate:
+      state.add(TagUTCDate);
+      state.add(static_cast<uint64_t>(slice.getUTCDate()));
+      break;
+    case ValueType::String: {
+      ValueLength length;
+      char const* p = slice.getStringUnchecked(length);
+      state.add(TagString);
+      state.addBytes(reinterpret_cast<uint8_t const*>(p), length);
+      break;
+    }
+    case ValueType::Array: {
+      ArrayIterator it(slice);
+      state.add(TagArray);
+      state.add(it.size());
+      while (it.valid()) {
+        hashNormalized(it.value(), state);
+        it.next();
+      }
+      break;
+    }
+    case ValueType::Object: {
+      // each member is hashed with its own state, and the results are
+      // summed up, so the result does not depend on the member order
+      ObjectIterator it(slice, true);
+      uint64_t sums[Lanes] = {};
+      while (it.valid()) {
+        NormalizedHashState<Lanes> member(TagObjectMember);
+        Slice key = it.key(false);
+        if (!key.isString()) {
+          key = key.makeKey();
+        }
+        hashNormalized(key, member);
+        hashNormalized(it.value(), member);
+        for (int i = 0; i < Lanes; ++i) {
+          sums[i] += member.finish(i);
+        }
+        it.next();
+      }
+      state.add(TagObject);
+      state.add(it.size());
+      state.add(sums);
+      break;
+    }
+    case ValueType::External:
+      hashNormalized(slice.resolveExternal(), state);
+      break;
+    case ValueType::Binary:
+      state.add(TagBinary);
+      state.addBytes(slice.start(), slice.byteSize());
+      break;
+    case ValueType::BCD:
+      state.add(TagBCD);
+      state.addBytes(slice.start(), slice.byteSize());
+      break;
+    case ValueType::Custom:
+      state.add(TagCustom);
+      state.addBytes(slice.start(), slice.byteSize());
+      break;
+  }
+}
+
+}  // namespace
+
+uint64_t Slice::normalizedHash(uint64_t seed) const {
+  NormalizedHashState<1> state(seed);
+  hashNormalized(*this, state);
+  return state.finish(0);
+}
+
+std::pair<uint64_t, uint64_t> Slice::normalizedHash128(uint64_t seed) const {
+  NormalizedHashState<2> state(seed);
+  hashNormalized(*this, state);
+  return std::make_pair(state.finish(1), state.finish(0));
 }
 
 // look for the specified attribute inside an Object
@@ -762,6 +1240,11 @@ Slice Slice::get(std::string const& attribute) const {
     return getFromCompactObject(attribute);
   }
 
+  if (h == 0x15) {
+    // Object with hash table
+    return getFromHashedObject(attribute);
+  }
+
   ValueLength const offsetSize = indexEntrySize(h);
   VELOCYPACK_ASSERT(offsetSize > 0);
   ValueLength end = readIntegerNonEmpty<ValueLength>(_start + 1, offsetSize);
@@ -788,10 +1271,11 @@ Slice Slice::get(std::string const& attribute) const {
       // fall through to returning None Slice below
     } else if (key.isSmallInt() || key.isUInt()) {
       // translate key
-      if (Options::Defaults.attributeTranslator == nullptr) {
+      AttributeTranslator const* translator = AttributeTranslator::current();
+      if (translator == nullptr) {
         throw Exception(Exception::NeedAttributeTranslator);
       }
-      if (key.translateUnchecked().isEqualString(attribute)) {
+      if (key.translateUnchecked(translator).isEqualString(attribute)) {
         return Slice(key.start() + key.byteSize());
       }
     }
@@ -807,9 +1291,9 @@ Slice Slice::get(std::string const& attribute) const {
   if (n >= SortedSearchEntriesThreshold && (h >= 0x0b && h <= 0x0e)) {
     switch (offsetSize) {
       case 1:
-        return searchObjectKeyBinary<1>(attribute, ieBase, n);
+        return searchObjectKeyBranchless<1>(attribute, ieBase, n);
       case 2:
-        return searchObjectKeyBinary<2>(attribute, ieBase, n);
+        return searchObjectKeyBranchless<2>(attribute, ieBase, n);
       case 4:
         return searchObjectKeyBinary<4>(attribute, ieBase, n);
       case 8:
@@ -996,6 +1480,60 @@ Slice Slice::getFromCompactObject(std::string const& attribute) const {
   return Slice();
 }
 
+// look up an attribute in an Object with a hash table
+Slice Slice::getFromHashedObject(std::string const& attribute) const {
+  VELOCYPACK_ASSERT(head() == 0x15);
+
+  if (VELOCYPACK_UNLIKELY(_start[9] != VELOCYPACK_HASH_ID)) {
+    // hash table was built with a different hash function. the index
+    // table is sorted, so we can still use a binary search
+    ValueLength const end = readIntegerFixed<ValueLength, 4>(_start + 1);
+    ValueLength const n = readIntegerFixed<ValueLength, 4>(_start + 5);
+    return searchObjectKeyBinary<4>(attribute, end - n * 4, n);
+  }
+
+  AttributeTranslator const* translator = AttributeTranslator::current();
+  bool const useTranslator = (translator != nullptr);
+
+  uint64_t const hash =
+      VELOCYPACK_HASH(attribute.data(), attribute.size(), defaultSeed);
+  uint32_t const tag = static_cast<uint32_t>(hash >> 32);
+  ValueLength const mask = (ValueLength(1) << _start[10]) - 1;
+  uint8_t const* table = _start + 11;
+
+  ValueLength slot = hash & mask;
+  for (ValueLength i = 0; i <= mask; ++i) {
+    uint8_t const* entry = table + slot * 8;
+    ValueLength const offset = readIntegerFixed<ValueLength, 4>(entry + 4);
+    if (offset == 0) {
+      // empty slot, attribute is not present
+      break;
+    }
+
+    if (readIntegerFixed<uint32_t, 4>(entry) == tag) {
+      Slice key(_start + offset);
+      if (key.isString()) {
+        if (key.isEqualStringUnchecked(attribute)) {
+          return Slice(key.start() + key.byteSize());
+        }
+      } else if (key.isSmallInt() || key.isUInt()) {
+        // translate key
+        if (!useTranslator) {
+          throw Exception(Exception::NeedAttributeTranslator);
+        }
+        if (key.translateUnchecked(translator).isEqualString(attribute)) {
+          return Slice(key.start() + key.byteSize());
+        }
+      }
+    }
+
+    slot = (slot + 1) & mask;
+  }
+
+  // not found
+  return Slice();
+}
+
 // get the offset for the nth member from an Array or Object type
 ValueLength Slice::getNthOffset(ValueLength index) const {
   VELOCYPACK_ASSERT(isArray() || isObject());
@@ -1081,10 +1619,11 @@ Slice Slice::makeKey() const {
     return *this;
   }
   if (isSmallInt() || isUInt()) {
-    if (Options::Defaults.attributeTranslator == nullptr) {
+    AttributeTranslator const* translator = AttributeTranslator::current();
+    if (translator == nullptr) {
       throw Exception(Exception::NeedAttributeTranslator);
     }
-    return translateUnchecked();
+    return translateUnchecked(translator);
   }
 
   throw Exception(Exception::InvalidValueType,
@@ -1119,7 +1658,8 @@ ValueLength Slice::getNthOffsetFromCompact(ValueLength index) const {
 Slice Slice::searchObjectKeyLinear(std::string const& attribute,
                                    ValueLength ieBase, ValueLength offsetSize,
                                    ValueLength n) const {
-  bool const useTranslator = (Options::Defaults.attributeTranslator != nullptr);
+  AttributeTranslator const* translator = AttributeTranslator::current();
+  bool const useTranslator = (translator != nullptr);
 
   for (ValueLength index = 0; index < n; ++index) {
     ValueLength offset = ieBase + index * offsetSize;
@@ -1135,7 +1675,7 @@ Slice Slice::searchObjectKeyLinear(std::string const& attribute,
         // no attribute translator
         throw Exception(Exception::NeedAttributeTranslator);
       }
-      if (!key.translateUnchecked().isEqualString(attribute)) {
+      if (!key.translateUnchecked(translator).isEqualString(attribute)) {
         continue;
       }
     } else {
@@ -1156,7 +1696,8 @@ template<ValueLength offsetSize>
 Slice Slice::searchObjectKeyBinary(std::string const& attribute,
                                    ValueLength ieBase,
                                    ValueLength n) const {
-  bool const useTranslator = (Options::Defaults.attributeTranslator != nullptr);
+  AttributeTranslator const* translator = AttributeTranslator::current();
+  bool const useTranslator = (translator != nullptr);
   VELOCYPACK_ASSERT(n > 0);
 
   ValueLength l = 0;
@@ -1176,7 +1717,7 @@ Slice Slice::searchObjectKeyBinary(std::string const& attribute,
         // no attribute translator
         throw Exception(Exception::NeedAttributeTranslator);
       }
-      res = key.translateUnchecked().compareString(attribute);
+      res = key.translateUnchecked(translator).compareString(attribute);
     } else {
       // invalid key
       return Slice();
@@ -1204,12 +1745,94 @@ Slice Slice::searchObjectKeyBinary(std::string const& attribute,
   }
 }
 
+// perform a branch-free binary search for the specified attribute inside an
+// Object with 1- or 2-byte offsets. the index tables of these objects are
+// at most a few cache lines long, so lookups are dominated by mispredicted
+// branches rather than by memory accesses. the loop always performs
+// ceil(log2(n)) probes and narrows the range with a conditional move, and
+// only the final candidate is checked for equality
+template<ValueLength offsetSize>
+Slice Slice::searchObjectKeyBranchless(std::string const& attribute,
+                                       ValueLength ieBase,
+                                       ValueLength n) const {
+  static_assert(offsetSize == 1 || offsetSize == 2,
+                "invalid offsetSize for branchless search");
+  AttributeTranslator const* translator = AttributeTranslator::current();
+  bool const useTranslator = (translator != nullptr);
+  VELOCYPACK_ASSERT(n > 0);
+
+  uint8_t const* table = _start + ieBase;
+  ValueLength base = 0;
+  ValueLength length = n;
+
+  while (length > 1) {
+    ValueLength const half = length / 2;
+    uint8_t const* key = _start + readIntegerFixed<ValueLength, offsetSize>(
+                                      table + (base + half) * offsetSize);
+    uint8_t const h = *key;
+
+    int res;
+    if (VELOCYPACK_LIKELY(h >= 0x40 && h <= 0xbe)) {
+      // short string key, compare inline
+      size_t const keyLength = static_cast<size_t>(h - 0x40);
+      res = memcmp(key + 1, attribute.data(),
+                   (std::min)(keyLength, attribute.size()));
+      if (res == 0) {
+        res = static_cast<int>(keyLength > attribute.size()) -
+              static_cast<int>(keyLength < attribute.size());
+      }
+    } else {
+      Slice k(key);
+      if (k.isString()) {
+        res = k.compareStringUnchecked(attribute.data(), attribute.size());
+      } else if (k.isSmallInt() || k.isUInt()) {
+        // translate key
+        if (!useTranslator) {
+          // no attribute translator
+          throw Exception(Exception::NeedAttributeTranslator);
+        }
+        res = k.translateUnchecked(translator).compareString(attribute);
+      } else {
+        // invalid key
+        return Slice();
+      }
+    }
+
+    // keep the upper half if its first key is still <= attribute
+    base = (res <= 0) ? base + half : base;
+    length -= half;
+  }
+
+  // base now points to the last key that is <= attribute, if any
+  Slice key(_start + readIntegerFixed<ValueLength, offsetSize>(
+                         table + base * offsetSize));
+  if (key.isString()) {
+    if (!key.isEqualStringUnchecked(attribute)) {
+      return Slice();
+    }
+  } else if (key.isSmallInt() || key.isUInt()) {
+    if (!useTranslator) {
+      throw Exception(Exception::NeedAttributeTranslator);
+    }
+    if (!key.translateUnchecked(translator).isEqualString(attribute)) {
+      return Slice();
+    }
+  } else {
+    return Slice();
+  }
+  return Slice(key.start() + key.byteSize());
+}
+
 // template instanciations for searchObjectKeyBinary
 template Slice Slice::searchObjectKeyBinary<1>(std::string const& attribute, ValueLength ieBase, ValueLength n) const;
 template Slice Slice::searchObjectKeyBinary<2>(std::string const& attribute, ValueLength ieBase, ValueLength n) const;
 template Slice Slice::searchObjectKeyBinary<4>(std::string const& attribute, ValueLength ieBase, ValueLength n) const;
 template Slice Slice::searchObjectKeyBinary<8>(std::string const& attribute, ValueLength ieBase, ValueLength n) const;
 
+// template instanciations for searchObjectKeyBranchless
+template Slice Slice::searchObjectKeyBranchless<1>(std::string const& attribute, ValueLength ieBase, ValueLength n) const;
+template Slice Slice::searchObjectKeyBranchless<2>(std::string const& attribute, ValueLength ieBase, ValueLength n) const;
+
 SliceScope::SliceScope() : _allocations() {}
 
 SliceScope::~SliceScope() {
@@ -24,6 +24,8 @@
 /// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <cstring>
+
 #include "velocypack/velocypack-common.h"
 #include "velocypack/Utf8Helper.h"
 
@@ -58,6 +60,15 @@ bool Utf8Helper::isValidUtf8(uint8_t const* p, ValueLength len) {
   uint8_t state = ValidChar;
 
   while (p < end) {
+    if (state == ValidChar && end - p >= 8) {
+      // skip over blocks of 8 ASCII characters at once
+      uint64_t block;
+      memcpy(&block, p, sizeof(block));
+      if ((block & 0x8080808080808080ULL) == 0) {
+        p += 8;
+        continue;
+      }
+    }
     state = states[256 + state * 16 + states[*p++]];
     if (state == InvalidChar) {
       return false;
@@ -24,6 +24,13 @@
 /// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "velocypack/velocypack-common.h"
 #include "velocypack/Validator.h"
 #include "velocypack/Exception.h"
@@ -33,13 +40,36 @@
 
 using namespace arangodb::velocypack;
 
+// start offsets of the members of the Objects being validated whose index
+// table is not in storage order, used as a stack. kept per thread and
+// reused, so that validation does not allocate memory in the steady state
+static thread_local std::vector<ValueLength> memberStarts;
+
+// flag for member offsets in memberStarts that an index entry points to
+static constexpr ValueLength UsedMemberStart = ValueLength(1) << 63;
+
+// values smaller than this are validated on a single thread by
+// validateParallel()
+static ValueLength const ParallelMinSize = 1024 * 1024;
+
+// number of chunks per thread in validateParallel(). more chunks than
+// threads even out the differences in the time needed for the chunks
+static size_t const ParallelChunksPerThread = 8;
+
+// reads an unsigned LEB128 value (as used for the byteSize and nrItems of
+// compact Arrays and Objects) starting at p, moving towards end, which is
+// never read. the value must be encoded with as few bytes as possible
 template<bool reverse>
 static ValueLength ReadVariableLengthValue(uint8_t const*& p, uint8_t const* end) {
+  uint8_t const* start = p;
   ValueLength value = 0;
   ValueLength shifter = 0;
   while (true) {
+    if (p == end) {
+      throw Exception(Exception::ValidatorInvalidLength, "Compound value length value is out of bounds");
+    }
     uint8_t c = *p;
-    value += (c & 0x7fU) << shifter;
+    value += static_cast<ValueLength>(c & 0x7fU) << shifter;
     shifter += 7;
     if (reverse) {
       --p;
@@ -49,430 +79,628 @@ static ValueLength ReadVariableLengthValue(uint8_t const*& p, uint8_t const* end
     if (!(c & 0x80U)) {
       break;
     }
-    if (p == end) {
-      throw Exception(Exception::ValidatorInvalidLength, "Compound value length value is out of bounds");
+    if (shifter > 56) {
+      throw Exception(Exception::ValidatorInvalidLength, "Compound value length value is too long");
     }
   }
+  ValueLength const size = static_cast<ValueLength>(reverse ? start - p : p - start);
+  if (size != getVariableValueLength(value)) {
+    throw Exception(Exception::ValidatorInvalidLength, "Compound value length value is not minimally encoded");
+  }
   return value;
 }
 
+// returns the offset of the first member of an Array or Object with
+// 1-8 bytes lengths, determined in the same way as Slice::findDataOffset()
+// does. all bytes between the header and the first member must be zero
+static ValueLength ReadDataOffset(uint8_t const* ptr, ValueLength byteSize) {
+  ValueLength const header = SliceStaticData::FirstSubMap[*ptr];
+  ValueLength dataOffset = 9;
+  if (header <= 2 && byteSize > 2 && ptr[2] != 0x00U) {
+    dataOffset = 2;
+  } else if (header <= 3 && byteSize > 3 && ptr[3] != 0x00U) {
+    dataOffset = 3;
+  } else if (header <= 5 && byteSize > 5 && ptr[5] != 0x00U) {
+    dataOffset = 5;
+  }
+  if (dataOffset >= byteSize) {
+    throw Exception(Exception::ValidatorInvalidLength, "Compound value data is out of bounds");
+  }
+  for (ValueLength i = header; i < dataOffset; ++i) {
+    if (ptr[i] != 0x00U) {
+      throw Exception(Exception::ValidatorInvalidLength, "Compound value padding is invalid");
+    }
+  }
+  return dataOffset;
+}
+
+// reads the number of members of an Array or Object with index table and
+// 1-8 bytes lengths, and computes the offset of its index table. the index
+// table must leave at least one byte per member in the data area
+static ValueLength ReadIndexTable(uint8_t const* ptr, ValueLength byteSize,
+                                  ValueLength dataOffset, ValueLength& indexOffset) {
+  ValueLength const width = SliceStaticData::LengthFieldWidths[*ptr];
+  ValueLength nrItems;
+  ValueLength indexEnd = byteSize;
+  if (width == 8) {
+    // nrItems is stored behind the index table
+    if (byteSize < dataOffset + 8) {
+      throw Exception(Exception::ValidatorInvalidLength, "Compound value nrItems value is out of bounds");
+    }
+    indexEnd -= 8;
+    nrItems = readIntegerFixed<ValueLength, 8>(ptr + indexEnd);
+  } else {
+    nrItems = readIntegerNonEmpty<ValueLength>(ptr + 1 + width, width);
+  }
+  if (nrItems == 0) {
+    throw Exception(Exception::ValidatorInvalidLength, "Compound value nrItems value is invalid");
+  }
+  if (nrItems > (indexEnd - dataOffset) / (width + 1)) {
+    throw Exception(Exception::ValidatorInvalidLength, "Compound value index table is out of bounds");
+  }
+  indexOffset = indexEnd - nrItems * width;
+  return nrItems;
+}
+
+// reads the number of members of an Object with hash table, and computes
+// the offsets of its data area and of its index table
+static ValueLength ReadHashTable(uint8_t const* ptr, ValueLength byteSize,
+                                 ValueLength& dataOffset, ValueLength& indexOffset) {
+  if (byteSize < 1 + 4 + 4 + 1 + 1) {
+    throw Exception(Exception::ValidatorInvalidLength, "Object length is out of bounds");
+  }
+
+  ValueLength const nrItems = readIntegerFixed<ValueLength, 4>(ptr + 5);
+  if (nrItems == 0) {
+    throw Exception(Exception::ValidatorInvalidLength, "Object nrItems value is invalid");
+  }
+
+  if (ptr[9] != 1 && ptr[9] != 2) {
+    throw Exception(Exception::ValidatorInvalidType, "Object hash function is invalid");
+  }
+
+  uint8_t const slotBits = ptr[10];
+  if (slotBits >= 32) {
+    throw Exception(Exception::ValidatorInvalidLength, "Object hash table size is invalid");
+  }
+  ValueLength const slots = ValueLength(1) << slotBits;
+  dataOffset = 11 + 8 * slots;
+
+  if (slots <= nrItems || dataOffset + 5 * nrItems > byteSize) {
+    throw Exception(Exception::ValidatorInvalidLength, "Object hash table is out of bounds");
+  }
+  indexOffset = byteSize - 4 * nrItems;
+  return nrItems;
+}
+
+// checks that all hash table entries of an Object point to a different
+// member, given the sorted member offsets from first to last, and that
+// there is exactly one used slot per member. the offsets are marked as
+// used on the way
+template<typename Iterator>
+static void CheckHashTable(uint8_t const* ptr, ValueLength nrItems,
+                           Iterator first, Iterator last) {
+  ValueLength const slots = ValueLength(1) << ptr[10];
+  uint8_t const* table = ptr + 11;
+  ValueLength used = 0;
+  for (ValueLength i = 0; i < slots; ++i) {
+    ValueLength const offset = readIntegerFixed<ValueLength, 4>(table + i * 8 + 4);
+    if (offset == 0) {
+      continue;
+    }
+    auto it = std::lower_bound(first, last, offset,
+                               [](ValueLength start, ValueLength offset) {
+                                 return (start & ~UsedMemberStart) < offset;
+                               });
+    if (it == last || *it != offset) {
+      throw Exception(Exception::ValidatorInvalidLength, "Object hash table entry is invalid");
+    }
+    *it |= UsedMemberStart;
+    ++used;
+  }
+  if (used != nrItems) {
+    throw Exception(Exception::ValidatorInvalidLength, "Object hash table is invalid");
+  }
+}
+
+// keys must be Strings, or UInts or non-negative SmallInts that are
+// translated by an AttributeTranslator
+static inline void CheckKeyType(uint8_t head) {
+  if (!(head >= 0x40U && head <= 0xbfU) && !(head >= 0x28U && head <= 0x2fU) &&
+      !(head >= 0x30U && head <= 0x39U)) {
+    throw Exception(Exception::ValidatorInvalidType, "Invalid Object key type");
+  }
+}
+
 bool Validator::validate(uint8_t const* ptr, size_t length, bool isSubPart) const {
+  // may contain leftovers from a validation that failed
+  memberStarts.clear();
+
+  ValueLength const byteSize = validateValue(ptr, length, 0);
+  validateBufferLength(byteSize, length, isSubPart);
+  return true;
+}
+
+bool Validator::validateFraming(uint8_t const* ptr, size_t length, bool isSubPart) const {
+  if (length == 0) {
+    throw Exception(Exception::ValidatorInvalidLength, "length 0 is invalid for any VelocyPack value");
+  }
+  if (SliceStaticData::TypeMap[*ptr] == ValueType::None && *ptr != 0x00U) {
+    throw Exception(Exception::ValidatorInvalidType);
+  }
+  ValueLength const byteSize = readByteSize(ptr, length);
+  validateBufferLength(byteSize, length, isSubPart);
+  return true;
+}
+
+bool Validator::validateParallel(uint8_t const* ptr, size_t length,
+                                 bool isSubPart, size_t concurrency) const {
+  if (concurrency == 0) {
+    concurrency = std::thread::hardware_concurrency();
+  }
+  uint8_t const head = (length > 0) ? *ptr : 0x00U;
+  bool const isArray = (head >= 0x02U && head <= 0x09U);
+  bool const isObject = (head >= 0x0bU && head <= 0x12U) || head == 0x15U;
+  if (concurrency <= 1 || length < ParallelMinSize || (!isArray && !isObject)) {
+    return validate(ptr, length, isSubPart);
+  }
+
+  // may contain leftovers from a validation that failed
+  memberStarts.clear();
+
+  ValueLength const byteSize = readByteSize(ptr, length);
+  validateBufferLength(byteSize, length, isSubPart);
+
+  // member i starts at dataOffset + i * itemSize in Arrays without index
+  // table, at the offset from index entry i in other Arrays and at
+  // offsets[i] in Objects, whose index entries are sorted by offset first.
+  // the last member ends at dataEnd. the offsets must be increasing, and
+  // each member must start at its offset
+  ValueLength dataOffset;
+  ValueLength dataEnd = byteSize;
+  ValueLength nrItems;
+  ValueLength itemSize = 0;
+  ValueLength width = 0;
+  std::vector<ValueLength> offsets;
+
+  if (head <= 0x05U) {
+    dataOffset = ReadDataOffset(ptr, byteSize);
+    itemSize = validateValue(ptr + dataOffset, byteSize - dataOffset, 1);
+    if ((byteSize - dataOffset) % itemSize != 0) {
+      throw Exception(Exception::ValidatorInvalidLength, "Array members do not match Array length");
+    }
+    nrItems = (byteSize - dataOffset) / itemSize;
+  } else {
+    if (head == 0x15U) {
+      width = 4;
+      nrItems = ReadHashTable(ptr, byteSize, dataOffset, dataEnd);
+    } else {
+      width = SliceStaticData::LengthFieldWidths[head];
+      dataOffset = ReadDataOffset(ptr, byteSize);
+      nrItems = ReadIndexTable(ptr, byteSize, dataOffset, dataEnd);
+    }
+    if (isObject) {
+      offsets.reserve(checkOverflow(nrItems));
+      for (ValueLength i = 0; i < nrItems; ++i) {
+        offsets.push_back(readIntegerNonEmpty<ValueLength>(ptr + dataEnd + i * width, width));
+      }
+      std::sort(offsets.begin(), offsets.end());
+    }
+  }
+
+  uint8_t const* indexTable = ptr + dataEnd;
+  auto memberOffset = [&](ValueLength i) -> ValueLength {
+    if (itemSize != 0) {
+      return dataOffset + i * itemSize;
+    }
+    if (isObject) {
+      return offsets[i];
+    }
+    return readIntegerNonEmpty<ValueLength>(indexTable + i * width, width);
+  };
+
+  if (itemSize == 0) {
+    ValueLength previous = 0;
+    for (ValueLength i = 0; i < nrItems; ++i) {
+      ValueLength const offset = memberOffset(i);
+      if (offset < dataOffset || offset >= dataEnd || (i > 0 && offset <= previous)) {
+        throw Exception(Exception::ValidatorInvalidLength, isObject
+                        ? "Object index table entry is invalid"
+                        : "Array index table entry is invalid");
+      }
+      previous = offset;
+    }
+  }
+
+  // the members are validated in chunks, and each thread (including the
+  // calling one) takes the next chunk that is not yet taken
+  size_t const chunks = static_cast<size_t>(
+      (std::min)(nrItems, static_cast<ValueLength>(concurrency * ParallelChunksPerThread)));
+  concurrency = (std::min)(concurrency, chunks);
+
+  std::atomic<size_t> next(0);
+  std::atomic<bool> failed(false);
+  std::exception_ptr error;
+  std::mutex mutex;
+
+  auto work = [&]() {
+    while (!failed.load()) {
+      size_t const c = next++;
+      if (c >= chunks) {
+        break;
+      }
+      try {
+        ValueLength const first = nrItems * c / chunks;
+        ValueLength const last = nrItems * (c + 1) / chunks;
+        ValueLength const end = (c + 1 == chunks) ? dataEnd : memberOffset(last);
+        ValueLength offset = (c == 0) ? dataOffset : memberOffset(first);
+        for (ValueLength i = first; i < last; ++i) {
+          if (offset != memberOffset(i)) {
+            throw Exception(Exception::ValidatorInvalidLength, isObject
+                            ? "Object index table entry is invalid"
+                            : "Array index table entry is invalid");
+          }
+          if (isObject) {
+            CheckKeyType(ptr[offset]);
+            offset += validateValue(ptr + offset, end - offset, 1);
+          }
+          ValueLength const size = validateValue(ptr + offset, end - offset, 1);
+          if (itemSize != 0 && size != itemSize) {
+            throw Exception(Exception::ValidatorInvalidLength, "Unexpected Array value length");
+          }
+          offset += size;
+        }
+        if (offset != end) {
+          throw Exception(Exception::ValidatorInvalidLength, isObject
+                          ? "Object members do not match Object length"
+                          : "Array members do not match Array length");
+        }
+      } catch (...) {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+        failed = true;
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  auto joinAll = [&]() {
+    for (auto& it : threads) {
+      it.join();
+    }
+  };
+
+  try {
+    for (size_t i = 1; i < concurrency; ++i) {
+      threads.emplace_back(work);
+    }
+  } catch (...) {
+    failed = true;
+    joinAll();
+    throw;
+  }
+  work();
+  joinAll();
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  if (head == 0x15U) {
+    CheckHashTable(ptr, nrItems, offsets.begin(), offsets.end());
+  }
+  return true;
+}
+
+ValueLength Validator::validateValue(uint8_t const* ptr, size_t length, ValueLength depth) const {
   if (length == 0) {
     throw Exception(Exception::ValidatorInvalidLength, "length 0 is invalid for any VelocyPack value");
   }
 
   uint8_t const head = *ptr;
 
-  // type() only reads the first byte, which is safe
-  ValueType const type = Slice(ptr).type();
+  // fast path for the most common scalar types with a fixed length
+  ValueLength const fixedLength = SliceStaticData::FixedTypeLengths[head];
+  if (fixedLength != 0 && head >= 0x18U && head <= 0xbeU && head != 0x1dU) {
+    validateBufferLength(fixedLength, length, true);
+    if (head >= 0x40U && options->validateUtf8Strings &&
+        !Utf8Helper::isValidUtf8(ptr + 1, fixedLength - 1)) {
+      throw Exception(Exception::InvalidUtf8Sequence);
+    }
+    return fixedLength;
+  }
+
+  ValueType const type = SliceStaticData::TypeMap[head];
 
   if (type == ValueType::None && head != 0x00U) {
     // invalid type
     throw Exception(Exception::ValidatorInvalidType);
   }
 
+  if (type == ValueType::BCD) {
+    throw Exception(Exception::NotImplemented);
+  }
+
+  ValueLength const byteSize = readByteSize(ptr, length);
+
   // special handling for certain types...
   switch (type) {
-    case ValueType::None:
-    case ValueType::Null: 
-    case ValueType::Bool: 
-    case ValueType::MinKey: 
-    case ValueType::MaxKey:  
-    case ValueType::SmallInt:
-    case ValueType::Int: 
-    case ValueType::UInt: 
-    case ValueType::Double: 
-    case ValueType::UTCDate: 
-    case ValueType::Binary:
-    case ValueType::Illegal: {
-      break;
-    }
-    
     case ValueType::String: {
-      uint8_t const* p;
-      ValueLength len;
-      if (head == 0xbfU) {
-        // long UTF-8 string. must be at least 9 bytes long so we
-        // can read the entire string length safely
-        validateBufferLength(1 + 8, length, true);
-        len = readIntegerFixed<ValueLength, 8>(ptr + 1);
-        p = ptr + 1 + 8;
-        validateBufferLength(len + 1 + 8, length, true);
-      } else {
-        len = head - 0x40U;
-        p = ptr + 1;
-        validateBufferLength(len + 1, length, true);
-      }
-
-      if (options->validateUtf8Strings && !Utf8Helper::isValidUtf8(p, len)) {
-        throw Exception(Exception::InvalidUtf8Sequence);
+      if (options->validateUtf8Strings) {
+        ValueLength const offset = (head == 0xbfU) ? 1 + 8 : 1;
+        if (!Utf8Helper::isValidUtf8(ptr + offset, byteSize - offset)) {
+          throw Exception(Exception::InvalidUtf8Sequence);
+        }
       }
       break;
     }
 
-    case ValueType::Array: {
-      validateArray(ptr, length);
-      break;
-    }
-    
+    case ValueType::Array:
     case ValueType::Object: {
-      validateObject(ptr, length);
+      if (options->validateMaxDepth != 0 && depth >= options->validateMaxDepth) {
+        throw Exception(Exception::ValidatorNestingTooDeep);
+      }
+      if (type == ValueType::Array) {
+        validateArray(ptr, byteSize, depth + 1);
+      } else {
+        validateObject(ptr, byteSize, depth + 1);
+      }
       break;
     }
 
-    case ValueType::BCD: {
-      throw Exception(Exception::NotImplemented);
-    }
-
     case ValueType::External: {
       // check if Externals are forbidden
       if (options->disallowExternals) {
         throw Exception(Exception::BuilderExternalsDisallowed);
       }
-      // validate if Slice length exceeds the given buffer
-      validateBufferLength(1 + sizeof(void*), length, true);
       // do not perform pointer validation
       break;
     }
 
     case ValueType::Custom: {
-      ValueLength byteSize = 0;
-
-      if (head == 0xf0U) {
-        byteSize = 1 + 1;
-      } else if (head == 0xf1U) {
-        byteSize = 1 + 2;
-      } else if (head == 0xf2U) {
-        byteSize = 1 + 4;
-      } else if (head == 0xf3U) {
-        byteSize = 1 + 8;
-      } else if (head >= 0xf4U && head <= 0xf6U) {
-        validateBufferLength(1 + 1, length, true);
-        byteSize = 1 + 1 + readIntegerNonEmpty<ValueLength>(ptr + 1, 1);
-        if (byteSize == 1 + 1) {
-          throw Exception(Exception::ValidatorInvalidLength, "Invalid size for Custom type");
-        }
-      } else if (head >= 0xf7U && head <= 0xf9U) {
-        validateBufferLength(1 + 2, length, true);
-        byteSize = 1 + 2 + readIntegerNonEmpty<ValueLength>(ptr + 1, 2); 
-        if (byteSize == 1 + 2) {
-          throw Exception(Exception::ValidatorInvalidLength, "Invalid size for Custom type");
-        }
-      } else if (head >= 0xfaU && head <= 0xfcU) {
-        validateBufferLength(1 + 4, length, true);
-        byteSize = 1 + 4 + readIntegerNonEmpty<ValueLength>(ptr + 1, 4); 
-        if (byteSize == 1 + 4) {
-          throw Exception(Exception::ValidatorInvalidLength, "Invalid size for Custom type");
-        }
-      } else if (head >= 0xfdU) {
-        validateBufferLength(1 + 8, length, true);
-        byteSize = 1 + 8 + readIntegerNonEmpty<ValueLength>(ptr + 1, 8); 
-        if (byteSize == 1 + 8) {
-          throw Exception(Exception::ValidatorInvalidLength, "Invalid size for Custom type");
-        }
+      // Custom types with a length field must have at least one byte of payload
+      ValueLength const width = SliceStaticData::LengthFieldWidths[head];
+      if (width != 0 && byteSize == 1 + width) {
+        throw Exception(Exception::ValidatorInvalidLength, "Invalid size for Custom type");
       }
-  
-      validateSliceLength(ptr, byteSize, isSubPart);
+      break;
+    }
+
+    default: {
       break;
     }
   }
-     
-  // common validation that must happen for all types 
-  validateSliceLength(ptr, length, isSubPart);
-  return true;
+
+  return byteSize;
+}
+
+ValueLength Validator::readByteSize(uint8_t const* ptr, size_t length) const {
+  uint8_t const head = *ptr;
+  ValueLength byteSize = SliceStaticData::FixedTypeLengths[head];
+
+  if (byteSize == 0) {
+    unsigned int const width = SliceStaticData::LengthFieldWidths[head];
+    if (width != 0) {
+      // the length field must be inside the buffer before it can be read
+      validateBufferLength(1 + width, length, true);
+      ValueLength const value = readIntegerNonEmpty<ValueLength>(ptr + 1, width);
+      byteSize = SliceStaticData::LengthFieldBases[head] + value;
+      if (byteSize < value) {
+        throw Exception(Exception::ValidatorInvalidLength, "Value length is out of bounds");
+      }
+    } else if (head == 0x13U || head == 0x14U) {
+      uint8_t const* p = ptr + 1;
+      byteSize = ReadVariableLengthValue<false>(p, ptr + length);
+    } else {
+      throw Exception(Exception::ValidatorInvalidType);
+    }
+  }
+
+  validateBufferLength(byteSize, length, true);
+  return byteSize;
 }
 
-void Validator::validateArray(uint8_t const* ptr, size_t length) const {
+void Validator::validateArray(uint8_t const* ptr, ValueLength byteSize, ValueLength depth) const {
   uint8_t head = *ptr;
 
   if (head == 0x13U) {
     // compact array
-    validateCompactArray(ptr, length);
+    validateCompactArray(ptr, byteSize, depth);
   } else if (head >= 0x02U && head <= 0x05U) {
     // array without index table
-    validateUnindexedArray(ptr, length);
+    validateUnindexedArray(ptr, byteSize, depth);
   } else if (head >= 0x06U && head <= 0x09U) {
     // array with index table
-    validateIndexedArray(ptr, length);
+    validateIndexedArray(ptr, byteSize, depth);
   } else if (head == 0x01U) {
     // empty array. always valid
   }
 }
 
-void Validator::validateCompactArray(uint8_t const* ptr, size_t length) const {
-  // compact Array without index table
-  validateBufferLength(4, length, true);
-
-  uint8_t const* p = ptr + 1;
-  // read byteLength
-  ValueLength const byteSize = ReadVariableLengthValue<false>(p, p + length);
-  if (byteSize > length || byteSize < 4) {
+void Validator::validateCompactArray(uint8_t const* ptr, ValueLength byteSize, ValueLength depth) const {
+  // compact Array without index table. the byteSize was already read and
+  // checked, nrItems is stored backwards at the end
+  ValueLength const dataOffset = 1 + getVariableValueLength(byteSize);
+  if (byteSize < dataOffset + 2) {
     throw Exception(Exception::ValidatorInvalidLength, "Array length value is out of bounds");
   }
-
-  // read nrItems
-  uint8_t const* data = p;
-  p = ptr + byteSize - 1;
-  ValueLength nrItems = ReadVariableLengthValue<true>(p, ptr + byteSize);
+  uint8_t const* p = ptr + byteSize - 1;
+  ValueLength const nrItems = ReadVariableLengthValue<true>(p, ptr + dataOffset - 1);
   if (nrItems == 0) {
-    throw Exception(Exception::ValidatorInvalidLength, "Array length value is out of bounds");
-  }
-  ++p;
-  
-  // validate the array members 
-  uint8_t const* e = p;
-  p = data;
-  while (nrItems-- > 0) { 
-    validate(p, e - p, true);
-    p += Slice(p).byteSize();
-  }
-}
-
-void Validator::validateUnindexedArray(uint8_t const* ptr, size_t length) const {
-  // Array without index table, with 1-8 bytes lengths, all values with same length
-  uint8_t head = *ptr;
-  ValueLength const byteSizeLength = 1ULL << (static_cast<ValueLength>(head) - 0x02U);
-  validateBufferLength(1 + byteSizeLength + 1, length, true);
-  ValueLength const byteSize = readIntegerNonEmpty<ValueLength>(ptr + 1, byteSizeLength);
-  
-  if (byteSize > length) {
-    throw Exception(Exception::ValidatorInvalidLength, "Array length is out of bounds");
+    throw Exception(Exception::ValidatorInvalidLength, "Array nrItems value is invalid");
   }
+  ValueLength const dataEnd = (p + 1) - ptr;
 
-  // look up first member
-  uint8_t const* p = ptr + 1 + byteSizeLength;
-  uint8_t const* e = ptr + 1 + byteSizeLength + (8 - byteSizeLength);
-  
-  if (e > ptr + byteSize) {
-    e = ptr + byteSize;
+  // the members must fill the space up to nrItems exactly
+  ValueLength offset = dataOffset;
+  for (ValueLength i = 0; i < nrItems; ++i) {
+    offset += validateValue(ptr + offset, dataEnd - offset, depth);
   }
-  while (p < e && *p == '\x00') {
-    ++p;
+  if (offset != dataEnd) {
+    throw Exception(Exception::ValidatorInvalidLength, "Array members do not match Array length");
   }
+}
 
-  if (p >= ptr + byteSize) {
-    throw Exception(Exception::ValidatorInvalidLength, "Array structure is invalid");
-  }
-  
-  validate(p, length - (p - ptr), true);
-  ValueLength itemSize = Slice(p).byteSize();
-  if (itemSize == 0) {
-    throw Exception(Exception::ValidatorInvalidLength, "Array itemSize value is invalid");
-  }
-  ValueLength nrItems = (byteSize - (p - ptr)) / itemSize; 
+void Validator::validateUnindexedArray(uint8_t const* ptr, ValueLength byteSize, ValueLength depth) const {
+  // Array without index table, with 1-8 bytes lengths, all values with same length
+  ValueLength offset = ReadDataOffset(ptr, byteSize);
 
-  if (nrItems == 0) {
-    throw Exception(Exception::ValidatorInvalidLength, "Array nrItems value is invalid");
+  ValueLength const itemSize = validateValue(ptr + offset, byteSize - offset, depth);
+  if ((byteSize - offset) % itemSize != 0) {
+    throw Exception(Exception::ValidatorInvalidLength, "Array members do not match Array length");
   }
+  offset += itemSize;
 
-  e = ptr + length;
-  while (nrItems > 0) {
-    if (p >= e) {
-      throw Exception(Exception::ValidatorInvalidLength, "Array value is out of bounds");
-    }
-    // validate sub value
-    validate(p, e - p, true);
-    if (Slice(p).byteSize() != itemSize) {
+  while (offset < byteSize) {
+    if (validateValue(ptr + offset, byteSize - offset, depth) != itemSize) {
       // got a sub-object with a different size. this is not allowed
       throw Exception(Exception::ValidatorInvalidLength, "Unexpected Array value length");
     }
-    p += itemSize;
-    --nrItems;
+    offset += itemSize;
   }
 }
 
-void Validator::validateIndexedArray(uint8_t const* ptr, size_t length) const {
+void Validator::validateIndexedArray(uint8_t const* ptr, ValueLength byteSize, ValueLength depth) const {
   // Array with index table, with 1-8 bytes lengths
-  uint8_t head = *ptr;
-  ValueLength const byteSizeLength = 1ULL << (static_cast<ValueLength>(head) - 0x06U);
-  validateBufferLength(1 + byteSizeLength + byteSizeLength + 1, length, true);
-  ValueLength byteSize = readIntegerNonEmpty<ValueLength>(ptr + 1, byteSizeLength);
-
-  if (byteSize > length) {
-    throw Exception(Exception::ValidatorInvalidLength, "Array length is out of bounds");
-  }
-
-  ValueLength nrItems;
-  ValueLength dataOffset;
-  uint8_t const* indexTable;
-
-  if (head == 0x09U) {
-    // byte length = 8
-    nrItems = readIntegerNonEmpty<ValueLength>(ptr + byteSize - byteSizeLength, byteSizeLength);
-    
-    if (nrItems == 0) {
-      throw Exception(Exception::ValidatorInvalidLength, "Array nrItems value is invalid");
+  ValueLength const width = SliceStaticData::LengthFieldWidths[*ptr];
+  ValueLength const dataOffset = ReadDataOffset(ptr, byteSize);
+  ValueLength indexOffset;
+  ValueLength const nrItems = ReadIndexTable(ptr, byteSize, dataOffset, indexOffset);
+
+  // the index table entries must be the offsets of the members in
+  // storage order, and the members must end where the index table starts
+  uint8_t const* indexTable = ptr + indexOffset;
+  ValueLength offset = dataOffset;
+  for (ValueLength i = 0; i < nrItems; ++i) {
+    if (readIntegerNonEmpty<ValueLength>(indexTable + i * width, width) != offset) {
+      throw Exception(Exception::ValidatorInvalidLength, "Array index table entry is invalid");
     }
-
-    indexTable = ptr + byteSize - byteSizeLength - (nrItems * byteSizeLength);
-    if (indexTable < ptr + byteSizeLength) {
-      throw Exception(Exception::ValidatorInvalidLength, "Array index table is out of bounds");
-    }
-    
-    dataOffset = 1 + byteSizeLength;
-  } else {
-    // byte length = 1, 2 or 4
-    nrItems = readIntegerNonEmpty<ValueLength>(ptr + 1 + byteSizeLength, byteSizeLength);
-    
-    if (nrItems == 0) {
-      throw Exception(Exception::ValidatorInvalidLength, "Array nrItems value is invalid");
-    }
-    
-    // look up first member
-    uint8_t const* p = ptr + 1 + byteSizeLength + byteSizeLength;
-    uint8_t const* e = ptr + 1 + (8 - byteSizeLength - byteSizeLength);
-    if (e > ptr + byteSize) {
-      e = ptr + byteSize;
-    }
-    while (p < e && *p == '\x00') {
-      ++p;
-    }
-
-    indexTable = ptr + byteSize - (nrItems * byteSizeLength);
-    if (indexTable < ptr + byteSizeLength + byteSizeLength || indexTable < p) {
-      throw Exception(Exception::ValidatorInvalidLength, "Array index table is out of bounds");
-    }
-    
-    dataOffset = 1 + byteSizeLength + byteSizeLength;
+    offset += validateValue(ptr + offset, indexOffset - offset, depth);
   }
-
-  while (nrItems > 0) {
-    ValueLength const offset = readIntegerNonEmpty<ValueLength>(indexTable, byteSizeLength);
-    if (offset < dataOffset || offset >= static_cast<ValueLength>(indexTable - ptr)) {
-      throw Exception(Exception::ValidatorInvalidLength, "Array index table entry is out of bounds");
-    }
-    validate(ptr + offset, length - offset, true);
-    indexTable += byteSizeLength; 
-    --nrItems;
+  if (offset != indexOffset) {
+    throw Exception(Exception::ValidatorInvalidLength, "Array members do not match Array length");
   }
 }
 
-void Validator::validateObject(uint8_t const* ptr, size_t length) const {
+void Validator::validateObject(uint8_t const* ptr, ValueLength byteSize, ValueLength depth) const {
   uint8_t head = *ptr;
 
   if (head == 0x14U) {
     // compact object
-    validateCompactObject(ptr, length);
+    validateCompactObject(ptr, byteSize, depth);
   } else if (head >= 0x0bU && head <= 0x12U) {
     // regular object
-    validateIndexedObject(ptr, length);
+    validateIndexedObject(ptr, byteSize, depth);
+  } else if (head == 0x15U) {
+    // object with hash table
+    validateHashedObject(ptr, byteSize, depth);
   } else if (head == 0x0aU) {
     // empty object. always valid
   }
 }
 
-void Validator::validateCompactObject(uint8_t const* ptr, size_t length) const {
-  // compact Object without index table
-  validateBufferLength(5, length, true);
-
-  uint8_t const* p = ptr + 1;
-  // read byteLength
-  ValueLength const byteSize = ReadVariableLengthValue<false>(p, p + length);
-  if (byteSize > length || byteSize < 5) {
+void Validator::validateCompactObject(uint8_t const* ptr, ValueLength byteSize, ValueLength depth) const {
+  // compact Object without index table. the byteSize was already read and
+  // checked, nrItems is stored backwards at the end
+  ValueLength const dataOffset = 1 + getVariableValueLength(byteSize);
+  if (byteSize < dataOffset + 3) {
     throw Exception(Exception::ValidatorInvalidLength, "Object length value is out of bounds");
   }
-
-  // read nrItems
-  uint8_t const* data = p;
-  p = ptr + byteSize - 1;
-  ValueLength nrItems = ReadVariableLengthValue<true>(p, ptr + byteSize);
+  uint8_t const* p = ptr + byteSize - 1;
+  ValueLength const nrItems = ReadVariableLengthValue<true>(p, ptr + dataOffset - 1);
   if (nrItems == 0) {
-    throw Exception(Exception::ValidatorInvalidLength, "Object length value is out of bounds");
+    throw Exception(Exception::ValidatorInvalidLength, "Object nrItems value is invalid");
   }
-  ++p;
-  
-  // validate the object members 
-  uint8_t const* e = p;
-  p = data;
-  while (nrItems-- > 0) {
-    // validate key 
-    validate(p, e - p, true);
-    Slice key(p);
-    if (!key.isString() && !key.isInteger()) {
-      throw Exception(Exception::ValidatorInvalidLength, "Invalid object key type");
-    }
 
-    // validate value
-    p += key.byteSize();
-    validate(p, e - p, true);
-    p += Slice(p).byteSize();
-  }
+  validateObjectMembers(ptr, dataOffset, (p + 1) - ptr, nrItems, 0, depth);
 }
 
-void Validator::validateIndexedObject(uint8_t const* ptr, size_t length) const {
+void Validator::validateIndexedObject(uint8_t const* ptr, ValueLength byteSize, ValueLength depth) const {
   // Object with index table, with 1-8 bytes lengths
-  uint8_t head = *ptr;
-  ValueLength const byteSizeLength = 1ULL << (static_cast<ValueLength>(head) - 0x0bU);
-  validateBufferLength(1 + byteSizeLength + byteSizeLength + 1, length, true);
-  ValueLength const byteSize = readIntegerNonEmpty<ValueLength>(ptr + 1, byteSizeLength);
+  ValueLength const width = SliceStaticData::LengthFieldWidths[*ptr];
+  ValueLength const dataOffset = ReadDataOffset(ptr, byteSize);
+  ValueLength indexOffset;
+  ValueLength const nrItems = ReadIndexTable(ptr, byteSize, dataOffset, indexOffset);
 
-  if (byteSize > length) {
-    throw Exception(Exception::ValidatorInvalidLength, "Object length is out of bounds");
-  }
+  validateObjectMembers(ptr, dataOffset, indexOffset, nrItems, width, depth);
+}
 
-  ValueLength nrItems;
+void Validator::validateHashedObject(uint8_t const* ptr, ValueLength byteSize, ValueLength depth) const {
+  // Object with hash table and 4-byte index table
   ValueLength dataOffset;
-  uint8_t const* indexTable;
-
-  if (head == 0x12U) {
-    // byte length = 8
-    nrItems = readIntegerNonEmpty<ValueLength>(ptr + byteSize - byteSizeLength, byteSizeLength);
-    
-    if (nrItems == 0) {
-      throw Exception(Exception::ValidatorInvalidLength, "Object nrItems value is invalid");
-    }
+  ValueLength indexOffset;
+  ValueLength const nrItems = ReadHashTable(ptr, byteSize, dataOffset, indexOffset);
 
-    indexTable = ptr + byteSize - byteSizeLength - (nrItems * byteSizeLength);
-    if (indexTable < ptr + byteSizeLength) {
-      throw Exception(Exception::ValidatorInvalidLength, "Object index table is out of bounds");
-    }
-    
-    dataOffset = 1 + byteSizeLength;
-  } else {
-    // byte length = 1, 2 or 4
-    nrItems = readIntegerNonEmpty<ValueLength>(ptr + 1 + byteSizeLength, byteSizeLength);
-    
-    if (nrItems == 0) {
-      throw Exception(Exception::ValidatorInvalidLength, "Object nrItems value is invalid");
+  validateObjectMembers(ptr, dataOffset, indexOffset, nrItems, 4, depth);
+
+  std::vector<ValueLength>& starts = memberStarts;
+  size_t const base = starts.size();
+  for (ValueLength offset = dataOffset; offset < indexOffset;) {
+    starts.push_back(offset);
+    offset += Slice(ptr + offset).byteSize();
+    offset += Slice(ptr + offset).byteSize();
+  }
+  CheckHashTable(ptr, nrItems, starts.begin() + base, starts.end());
+  starts.resize(base);
+}
+
+void Validator::validateObjectMembers(uint8_t const* ptr, ValueLength dataOffset,
+                                      ValueLength dataEnd, ValueLength nrItems,
+                                      ValueLength width, ValueLength depth) const {
+  // validates the key/value pairs between dataOffset and dataEnd in storage
+  // order. if width is not 0, the index table with entries of width bytes
+  // starts at dataEnd
+  uint8_t const* indexTable = ptr + dataEnd;
+  std::vector<ValueLength>* starts = nullptr;
+  size_t base = 0;
+  ValueLength unordered = nrItems;
+  ValueLength offset = dataOffset;
+
+  for (ValueLength i = 0; i < nrItems; ++i) {
+    if (offset >= dataEnd) {
+      throw Exception(Exception::ValidatorInvalidLength, "Object members do not match Object length");
     }
-    
-    // look up first member
-    uint8_t const* p = ptr + 1 + byteSizeLength + byteSizeLength;
-    uint8_t const* e = ptr + 1 + (8 - byteSizeLength - byteSizeLength);
-    if (e > ptr + byteSize) {
-      e = ptr + byteSize;
+    if (starts == nullptr && width != 0 &&
+        readIntegerNonEmpty<ValueLength>(indexTable + i * width, width) != offset) {
+      // sorted index tables are usually not in storage order. the remaining
+      // entries must still point to the start of a different member each,
+      // so the offsets of the remaining members are recorded
+      starts = &memberStarts;
+      base = starts->size();
+      unordered = i;
     }
-    while (p < e && *p == '\x00') {
-      ++p;
+    if (starts != nullptr) {
+      starts->push_back(offset);
     }
 
-    indexTable = ptr + byteSize - (nrItems * byteSizeLength);
-    if (indexTable < ptr + byteSizeLength + byteSizeLength || indexTable < p) {
-      throw Exception(Exception::ValidatorInvalidLength, "Object index table is out of bounds");
-    }
-    
-    dataOffset = 1 + byteSizeLength + byteSizeLength;
+    CheckKeyType(ptr[offset]);
+    offset += validateValue(ptr + offset, dataEnd - offset, depth);
+    offset += validateValue(ptr + offset, dataEnd - offset, depth);
+  }
+  if (offset != dataEnd) {
+    throw Exception(Exception::ValidatorInvalidLength, "Object members do not match Object length");
   }
 
-  while (nrItems > 0) {
-    ValueLength offset = readIntegerNonEmpty<ValueLength>(indexTable, byteSizeLength);
-    if (offset < dataOffset || offset >= static_cast<ValueLength>(indexTable - ptr)) {
-      throw Exception(Exception::ValidatorInvalidLength, "Object index table entry is out of bounds");
-    }
-    // validate key
-    validate(ptr + offset, length - offset, true);
-    Slice key(ptr + offset);
-    if (!key.isString() && !key.isInteger()) {
-      throw Exception(Exception::ValidatorInvalidLength, "Invalid object key type");
-    }
-    
-    // validate value
-    offset += key.byteSize();
-    validate(ptr + offset, length - offset, true);
+  if (starts == nullptr) {
+    // no index table, or all entries are the member offsets in storage order
+    return;
+  }
 
-    indexTable += byteSizeLength; 
-    --nrItems;
+  // the recorded offsets are sorted. each one may be used only once
+  auto const first = starts->begin() + base;
+  for (ValueLength i = unordered; i < nrItems; ++i) {
+    ValueLength const entry = readIntegerNonEmpty<ValueLength>(indexTable + i * width, width);
+    auto it = std::lower_bound(first, starts->end(), entry,
+                               [](ValueLength start, ValueLength entry) {
+                                 return (start & ~UsedMemberStart) < entry;
+                               });
+    if (it == starts->end() || *it != entry) {
+      throw Exception(Exception::ValidatorInvalidLength, "Object index table entry is invalid");
+    }
+    *it |= UsedMemberStart;
   }
+  starts->resize(base);
 }
 
 void Validator::validateBufferLength(size_t expected, size_t actual, bool isSubPart) const {
@@ -481,9 +709,3 @@ void Validator::validateBufferLength(size_t expected, size_t actual, bool isSubP
     throw Exception(Exception::ValidatorInvalidLength, "given buffer length is unequal to actual length of Slice in buffer");
   }
 }
-        
-void Validator::validateSliceLength(uint8_t const* ptr, size_t length, bool isSubPart) const {
-  size_t actual = static_cast<size_t>(Slice(ptr).byteSize());
-  validateBufferLength(actual, length, isSubPart);
-}
-
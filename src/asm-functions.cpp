@@ -71,6 +71,28 @@ inline size_t JSONSkipWhiteSpaceC(uint8_t const* src, size_t limit) {
   return limit - (end - src);
 }
 
+inline size_t JSONStringEscapeScanC(uint8_t const* src, size_t limit) {
+  // Scan up to limit uint8_t from src for a byte that must be escaped
+  // when dumping JSON: a control character, a backslash, a double quote
+  // or a forward slash. Report the number of bytes before that byte.
+  uint8_t const* end = src + limit;
+  while (src < end && *src >= 32 && *src != '\\' && *src != '"' &&
+         *src != '/') {
+    src++;
+  }
+  return limit - (end - src);
+}
+
+inline size_t JSONStringEscapeScanCheckUtf8C(uint8_t const* src, size_t limit) {
+  // Same as above, but also stop at byte with high bit set.
+  uint8_t const* end = src + limit;
+  while (src < end && *src >= 32 && *src != '\\' && *src != '"' &&
+         *src != '/' && *src < 0x80) {
+    src++;
+  }
+  return limit - (end - src);
+}
+
 } // namespace
 
 
@@ -226,6 +248,126 @@ size_t doInitSkip(uint8_t const* src, size_t limit) {
   return (*JSONSkipWhiteSpace)(src, limit);
 }
 
+// The escape scans never read beyond src + limit, as the dumped strings
+// may end right at the end of a mapped region. The remainder that does
+// not fill a full register is handled by the C versions.
+
+size_t JSONStringEscapeScanSSE42(uint8_t const* src, size_t limit) {
+  alignas(16) static unsigned char const ranges[17] =
+      "\x20\x21\x23\x2e\x30\x5b\x5d\xff        ";
+  // stops at 0x00-0x1f, '"', '/' and '\\'
+  __m128i const r = _mm_load_si128(reinterpret_cast<__m128i const*>(ranges));
+  size_t count = 0;
+  while (limit >= 16) {
+    __m128i const s = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src));
+    int x = _mm_cmpistri(r, /* 8, */ s, /* 16, */
+                         _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES |
+                             _SIDD_NEGATIVE_POLARITY | _SIDD_LEAST_SIGNIFICANT);
+    if (x < 16) {
+      return count + x;
+    }
+    src += 16;
+    limit -= 16;
+    count += 16;
+  }
+  return count + ::JSONStringEscapeScanC(src, limit);
+}
+
+size_t JSONStringEscapeScanCheckUtf8SSE42(uint8_t const* src, size_t limit) {
+  alignas(16) static unsigned char const ranges[17] =
+      "\x20\x21\x23\x2e\x30\x5b\x5d\x7f        ";
+  // stops at 0x00-0x1f, '"', '/', '\\' and 0x80-0xff
+  __m128i const r = _mm_load_si128(reinterpret_cast<__m128i const*>(ranges));
+  size_t count = 0;
+  while (limit >= 16) {
+    __m128i const s = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src));
+    int x = _mm_cmpistri(r, /* 8, */ s, /* 16, */
+                         _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES |
+                             _SIDD_NEGATIVE_POLARITY | _SIDD_LEAST_SIGNIFICANT);
+    if (x < 16) {
+      return count + x;
+    }
+    src += 16;
+    limit -= 16;
+    count += 16;
+  }
+  return count + ::JSONStringEscapeScanCheckUtf8C(src, limit);
+}
+
+bool hasAVX2() {
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid_max(0, nullptr) < 7 ||
+      !__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+    return false;
+  }
+  // OSXSAVE and AVX, then check that the OS saves the ymm registers
+  if ((ecx & 0x18000000) != 0x18000000) {
+    return false;
+  }
+  unsigned int xcr0, xcr0high;
+  __asm__ __volatile__("xgetbv" : "=a"(xcr0), "=d"(xcr0high) : "c"(0));
+  if ((xcr0 & 0x6) != 0x6) {
+    return false;
+  }
+  __cpuid_count(7, 0, eax, ebx, ecx, edx);
+  return (ebx & 0x20) != 0;
+}
+
+template <bool checkUtf8>
+__attribute__((target("avx2")))
+size_t JSONStringEscapeScanAVX2(uint8_t const* src, size_t limit) {
+  __m256i const controlMax = _mm256_set1_epi8(0x1f);
+  __m256i const quote = _mm256_set1_epi8('"');
+  __m256i const backslash = _mm256_set1_epi8('\\');
+  __m256i const slash = _mm256_set1_epi8('/');
+  size_t count = 0;
+  while (limit >= 32) {
+    __m256i const s = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src));
+    // s <= 0x1f <=> min(s, 0x1f) == s
+    __m256i m = _mm256_cmpeq_epi8(_mm256_min_epu8(s, controlMax), s);
+    m = _mm256_or_si256(m, _mm256_cmpeq_epi8(s, quote));
+    m = _mm256_or_si256(m, _mm256_cmpeq_epi8(s, backslash));
+    m = _mm256_or_si256(m, _mm256_cmpeq_epi8(s, slash));
+    if (checkUtf8) {
+      // bytes with the high bit set have their sign bit set
+      m = _mm256_or_si256(m, s);
+    }
+    uint32_t const mask = static_cast<uint32_t>(_mm256_movemask_epi8(m));
+    if (mask != 0) {
+      return count + __builtin_ctz(mask);
+    }
+    src += 32;
+    limit -= 32;
+    count += 32;
+  }
+  if (checkUtf8) {
+    return count + ::JSONStringEscapeScanCheckUtf8SSE42(src, limit);
+  }
+  return count + ::JSONStringEscapeScanSSE42(src, limit);
+}
+
+size_t doInitEscapeScan(uint8_t const* src, size_t limit) {
+  if (assemblerFunctionsEnabled() && ::hasSSE42() && ::hasAVX2()) {
+    JSONStringEscapeScan = ::JSONStringEscapeScanAVX2<false>;
+  } else if (assemblerFunctionsEnabled() && ::hasSSE42()) {
+    JSONStringEscapeScan = ::JSONStringEscapeScanSSE42;
+  } else {
+    JSONStringEscapeScan = ::JSONStringEscapeScanC;
+  }
+  return (*JSONStringEscapeScan)(src, limit);
+}
+
+size_t doInitEscapeScanCheckUtf8(uint8_t const* src, size_t limit) {
+  if (assemblerFunctionsEnabled() && ::hasSSE42() && ::hasAVX2()) {
+    JSONStringEscapeScanCheckUtf8 = ::JSONStringEscapeScanAVX2<true>;
+  } else if (assemblerFunctionsEnabled() && ::hasSSE42()) {
+    JSONStringEscapeScanCheckUtf8 = ::JSONStringEscapeScanCheckUtf8SSE42;
+  } else {
+    JSONStringEscapeScanCheckUtf8 = ::JSONStringEscapeScanCheckUtf8C;
+  }
+  return (*JSONStringEscapeScanCheckUtf8)(src, limit);
+}
+
 } // namespace
 
 #else
@@ -247,6 +389,16 @@ size_t doInitSkip(uint8_t const* src, size_t limit) {
   return JSONSkipWhiteSpace(src, limit);
 }
 
+size_t doInitEscapeScan(uint8_t const* src, size_t limit) {
+  JSONStringEscapeScan = ::JSONStringEscapeScanC;
+  return ::JSONStringEscapeScanC(src, limit);
+}
+
+size_t doInitEscapeScanCheckUtf8(uint8_t const* src, size_t limit) {
+  JSONStringEscapeScanCheckUtf8 = ::JSONStringEscapeScanCheckUtf8C;
+  return ::JSONStringEscapeScanCheckUtf8C(src, limit);
+}
+
 } // namespace
 
 #endif
@@ -254,17 +406,23 @@ size_t doInitSkip(uint8_t const* src, size_t limit) {
 size_t (*JSONStringCopy)(uint8_t*, uint8_t const*, size_t) = ::doInitCopy;
 size_t (*JSONStringCopyCheckUtf8)(uint8_t*, uint8_t const*, size_t) = ::doInitCopyCheckUtf8;
 size_t (*JSONSkipWhiteSpace)(uint8_t const*, size_t) = ::doInitSkip;
+size_t (*JSONStringEscapeScan)(uint8_t const*, size_t) = ::doInitEscapeScan;
+size_t (*JSONStringEscapeScanCheckUtf8)(uint8_t const*, size_t) = ::doInitEscapeScanCheckUtf8;
 
 void arangodb::velocypack::enableNativeStringFunctions() {
   JSONStringCopy = ::doInitCopy;
   JSONStringCopyCheckUtf8 = ::doInitCopyCheckUtf8;
   JSONSkipWhiteSpace = ::doInitSkip;
+  JSONStringEscapeScan = ::doInitEscapeScan;
+  JSONStringEscapeScanCheckUtf8 = ::doInitEscapeScanCheckUtf8;
 }
 
 void arangodb::velocypack::enableBuiltinStringFunctions() {
   JSONStringCopy = ::JSONStringCopyC;
   JSONStringCopyCheckUtf8 = ::JSONStringCopyCheckUtf8C;
   JSONSkipWhiteSpace = ::JSONSkipWhiteSpaceC;
+  JSONStringEscapeScan = ::JSONStringEscapeScanC;
+  JSONStringEscapeScanCheckUtf8 = ::JSONStringEscapeScanCheckUtf8C;
 }
 
 
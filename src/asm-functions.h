@@ -37,6 +37,14 @@ extern size_t (*JSONStringCopyCheckUtf8)(uint8_t*, uint8_t const*, size_t);
 // White space skipping:
 extern size_t (*JSONSkipWhiteSpace)(uint8_t const*, size_t);
 
+// Scanning for the next byte that needs escaping when dumping a string:
+// control characters, double quote, backslash and forward slash. Returns
+// the number of leading bytes that can be copied verbatim:
+extern size_t (*JSONStringEscapeScan)(uint8_t const*, size_t);
+
+// Now a version which also stops at high bit set bytes:
+extern size_t (*JSONStringEscapeScanCheckUtf8)(uint8_t const*, size_t);
+
 namespace arangodb {
 namespace velocypack {
 
@@ -42,6 +42,9 @@ namespace arangodb {
 namespace velocypack {
 // forward for fpconv function
 int fpconv_dtoa(double fp, char dest[24]);
+int fpconv_dtoa_shortest(double fp, char dest[24]);
+// digit generation for fpconv_dtoa_shortest, see schubfach.cpp
+int schubfach_digits(double d, char digits[17], int* K);
 }
 }
 
@@ -326,7 +329,7 @@ static int filter_special(double fp, char* dest) {
   return 3;
 }
 
-int arangodb::velocypack::fpconv_dtoa(double d, char dest[24]) {
+static int dtoa(double d, char dest[24], bool shortest) {
   char digits[18];
 
   int str_len = 0;
@@ -348,9 +351,24 @@ int arangodb::velocypack::fpconv_dtoa(double d, char dest[24]) {
   digits[0] = '\0';
 
   int K = 0;
-  int ndigits = grisu2(d, digits, &K);
+  int ndigits;
+  if (shortest) {
+    ndigits = arangodb::velocypack::schubfach_digits(absv(d), digits, &K);
+  } else {
+    ndigits = grisu2(d, digits, &K);
+  }
 
   str_len += emit_digits(digits, ndigits, dest + str_len, K, neg);
 
   return str_len;
 }
+
+int arangodb::velocypack::fpconv_dtoa(double d, char dest[24]) {
+  return dtoa(d, dest, false);
+}
+
+/* Same output format as fpconv_dtoa, but always with the shortest digits
+ * that convert back to d, which Grisu2 does not guarantee. */
+int arangodb::velocypack::fpconv_dtoa_shortest(double d, char dest[24]) {
+  return dtoa(d, dest, true);
+}
@@ -10,6 +10,7 @@
                    "../../src/Exception.cpp",
                    "../../src/fasthash.cpp",
                    "../../src/fpconv.cpp",
+                   "../../src/schubfach.cpp",
                    "../../src/HexDump.cpp",
                    "../../src/Iterator.cpp",
                    "../../src/Options.cpp",
@@ -27,6 +27,7 @@
 #include <ostream>
 #include <string>
 #include <iostream>
+#include <limits>
 
 #include "tests-common.h"
 
@@ -755,6 +756,38 @@ TEST(BuilderTest, BinaryWithOtherTypes) {
                               Exception::BuilderUnexpectedValue);
 }
 
+TEST(BuilderTest, LargeBinary) {
+  // Binary values of 64 KiB or more have a 3 byte length field
+  std::string const value(70000, 'x');
+  Builder b;
+  b.add(ValuePair(value.data(), value.size(), ValueType::Binary));
+  Slice binary = b.slice();
+  ASSERT_EQ(0xc2U, binary.head());
+  ASSERT_EQ(70004ULL, b.size());
+  ASSERT_EQ(70004ULL, binary.byteSize());
+  ASSERT_TRUE(binary.isBinary());
+  ValueLength length;
+  uint8_t const* p = binary.getBinary(length);
+  ASSERT_EQ(value.size(), length);
+  ASSERT_EQ(0, memcmp(value.data(), p, length));
+
+  Builder array;
+  array.openArray();
+  array.add(ValuePair(value.data(), value.size(), ValueType::Binary));
+  array.add(Value(1));
+  array.add(ValuePair(value.data(), 3, ValueType::Binary));
+  array.close();
+
+  Slice s = array.slice();
+  ASSERT_EQ(3ULL, s.length());
+  ASSERT_EQ(70004ULL, s.at(0).byteSize());
+  ASSERT_EQ(1, s.at(1).getInt());
+  ASSERT_EQ(5ULL, s.at(2).byteSize());
+
+  Validator validator;
+  ASSERT_TRUE(validator.validate(s.start(), s.byteSize()));
+}
+
 TEST(BuilderTest, ExternalWithOtherTypes) {
   Builder b;
   b.add(Value(ValueType::Array));
@@ -2782,6 +2815,174 @@ TEST(BuilderTest, AddThousandNonesCompact) {
   }
 }
 
+TEST(BuilderTest, CanonicalObjectKeyOrder) {
+  Options options;
+  options.buildCanonical = true;
+
+  Builder b1(&options);
+  b1.openObject();
+  b1.add("b", Value(1));
+  b1.add("c", Value("foo"));
+  b1.add("a", Value(true));
+  b1.close();
+
+  Builder b2(&options);
+  b2.openObject();
+  b2.add("a", Value(true));
+  b2.add("b", Value(1));
+  b2.add("c", Value("foo"));
+  b2.close();
+
+  ASSERT_EQ(b2.slice().byteSize(), b1.slice().byteSize());
+  ASSERT_EQ(0, memcmp(b1.slice().start(), b2.slice().start(), b1.slice().byteSize()));
+  ASSERT_EQ(0x0b, b1.slice().head());
+
+  // members are stored in key order
+  ObjectIterator it(b1.slice(), true);
+  ASSERT_EQ("a", it.key().copyString());
+  it.next();
+  ASSERT_EQ("b", it.key().copyString());
+  it.next();
+  ASSERT_EQ("c", it.key().copyString());
+}
+
+TEST(BuilderTest, CanonicalIgnoresLayoutOptions) {
+  std::string const value("{\"z\":[1,2,3],\"y\":{\"b\":1,\"a\":2},\"x\":[]}");
+
+  Options options;
+  options.buildCanonical = true;
+  Builder expected(&options);
+  Parser parser1(expected, &options);
+  parser1.parse(value);
+
+  options.buildUnindexedArrays = true;
+  options.buildUnindexedObjects = true;
+  options.buildHashedObjects = true;
+  options.hashedObjectMinLength = 1;
+  Builder b(&options);
+  Parser parser2(b, &options);
+  parser2.parse(value);
+
+  ASSERT_EQ(expected.slice().byteSize(), b.slice().byteSize());
+  ASSERT_EQ(0, memcmp(expected.slice().start(), b.slice().start(), b.slice().byteSize()));
+
+  b.clear();
+  b.openArray(true);
+  b.add(Value(1));
+  b.add(Value(2));
+  b.close();
+  ASSERT_EQ(0x02, b.slice().head());
+}
+
+TEST(BuilderTest, CanonicalNumbers) {
+  Options options;
+  options.buildCanonical = true;
+
+  Builder b(&options);
+  b.openArray();
+  b.add(Value(42));
+  b.add(Value(static_cast<uint64_t>(42)));
+  b.add(Value(42.0));
+  b.add(Value(-42.0));
+  b.add(Value(-0.0));
+  b.add(Value(0.5));
+  b.add(Value(18446744073709549568.0));
+  b.add(Value(std::numeric_limits<double>::quiet_NaN()));
+  b.add(Value(-std::numeric_limits<double>::quiet_NaN()));
+  b.close();
+
+  Slice s = b.slice();
+  ASSERT_EQ(0x28, s.at(0).head());
+  ASSERT_EQ(0x28, s.at(1).head());
+  ASSERT_EQ(0x28, s.at(2).head());
+  ASSERT_EQ(42ULL, s.at(2).getUInt());
+  ASSERT_EQ(0x20, s.at(3).head());
+  ASSERT_EQ(-42LL, s.at(3).getInt());
+  ASSERT_EQ(0x30, s.at(4).head());
+  ASSERT_TRUE(s.at(5).isDouble());
+  ASSERT_EQ(0.5, s.at(5).getDouble());
+  ASSERT_TRUE(s.at(6).isUInt());
+  ASSERT_EQ(18446744073709549568ULL, s.at(6).getUInt());
+  ASSERT_TRUE(s.at(7).isDouble());
+  ASSERT_EQ(0, memcmp(s.at(7).start(), s.at(8).start(), s.at(7).byteSize()));
+}
+
+TEST(BuilderTest, CanonicalStringsAndBinary) {
+  // build a long string representation of a short string by hand
+  uint8_t const longString[] = {0xbf, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 'f', 'o', 'o'};
+  uint8_t const binary[] = {0xc3, 0x03, 0x00, 0x00, 0x00, 'b', 'a', 'r'};
+
+  Options options;
+  options.buildCanonical = true;
+  Builder b(&options);
+  b.openArray();
+  b.add(Slice(longString));
+  b.add(Slice(binary));
+  b.close();
+
+  Slice s = b.slice();
+  ASSERT_EQ(0x43, s.at(0).head());
+  ASSERT_EQ("foo", s.at(0).copyString());
+  ASSERT_EQ(0xc0, s.at(1).head());
+  ValueLength length;
+  uint8_t const* p = s.at(1).getBinary(length);
+  ASSERT_EQ(3ULL, length);
+  ASSERT_EQ(0, memcmp("bar", p, 3));
+}
+
+TEST(BuilderTest, CanonicalTranslatedKeys) {
+  std::unique_ptr<AttributeTranslator> translator(new AttributeTranslator);
+  translator->add("foo", 1);
+  translator->add("bar", 2);
+  translator->seal();
+
+  AttributeTranslatorScope scope(translator.get());
+
+  Options translating;
+  translating.attributeTranslator = translator.get();
+  Builder input(&translating);
+  Parser parser(input, &translating);
+  parser.parse("{\"foo\":1,\"bar\":{\"foo\":2},\"baz\":3}");
+  ASSERT_TRUE(input.slice().keyAt(0, false).isSmallInt());
+
+  Options options;
+  options.buildCanonical = true;
+  options.attributeTranslator = translator.get();
+
+  Builder b(&options);
+  b.add(input.slice());
+  Builder expected(&options);
+  Parser expectedParser(expected, &options);
+  expectedParser.parse("{\"baz\":3,\"foo\":1,\"bar\":{\"foo\":2}}");
+
+  ASSERT_EQ(expected.slice().byteSize(), b.slice().byteSize());
+  ASSERT_EQ(0, memcmp(expected.slice().start(), b.slice().start(), b.slice().byteSize()));
+  ASSERT_TRUE(b.slice().keyAt(0, false).isString());
+  ASSERT_TRUE(b.slice().get("bar").keyAt(0, false).isString());
+
+  b.clear();
+  b.openObject();
+  b.add("foo", Value(1));
+  b.close();
+  ASSERT_TRUE(b.slice().keyAt(0, false).isString());
+}
+
+TEST(BuilderTest, CanonicalExternals) {
+  std::shared_ptr<Builder> value = Parser::fromJson("{\"b\":[1,2],\"a\":\"x\"}");
+
+  Options options;
+  options.buildCanonical = true;
+  Builder b(&options);
+  b.openArray();
+  b.add(Value(static_cast<void const*>(value->slice().start()), ValueType::External));
+  b.close();
+
+  Slice s = b.slice().at(0);
+  ASSERT_TRUE(s.isObject());
+  ASSERT_EQ("a", s.keyAt(0).copyString());
+  ASSERT_EQ("{\"a\":\"x\",\"b\":[1,2]}", s.toJson());
+}
+
 int main(int argc, char* argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
 
@@ -2101,6 +2101,31 @@ TEST(CollectionTest, SortNonArray) {
   ASSERT_VELOCYPACK_EXCEPTION(Collection::sort(b.slice(), &lt), Exception::InvalidValueType);
 }
 
+TEST(CollectionTest, Canonicalize) {
+  Options unindexed;
+  unindexed.buildUnindexedArrays = true;
+  unindexed.buildUnindexedObjects = true;
+
+  Builder b1(&unindexed);
+  Parser parser(b1, &unindexed);
+  parser.parse("{\"foo\":[1,2.0,\"bar\"],\"baz\":{\"y\":null,\"x\":-3}}");
+
+  std::shared_ptr<Builder> b2 = Parser::fromJson("{\"baz\":{\"x\":-3.0,\"y\":null},\"foo\":[1,2,\"bar\"]}");
+
+  ASSERT_NE(b1.slice().byteSize(), b2->slice().byteSize());
+
+  Builder c1 = Collection::canonicalize(b1.slice());
+  Builder c2 = Collection::canonicalize(b2->slice());
+  ASSERT_EQ(c1.slice().byteSize(), c2.slice().byteSize());
+  ASSERT_EQ(0, memcmp(c1.slice().start(), c2.slice().start(), c1.slice().byteSize()));
+  ASSERT_EQ("{\"baz\":{\"x\":-3,\"y\":null},\"foo\":[1,2,\"bar\"]}", c1.slice().toJson());
+
+  // canonicalizing is idempotent
+  Builder c3 = Collection::canonicalize(c1.slice());
+  ASSERT_EQ(c1.slice().byteSize(), c3.slice().byteSize());
+  ASSERT_EQ(0, memcmp(c1.slice().start(), c3.slice().start(), c1.slice().byteSize()));
+}
+
 int main(int argc, char* argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
 
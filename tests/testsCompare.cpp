@@ -24,8 +24,12 @@
 /// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+#include <limits>
 #include <ostream>
+#include <set>
 #include <string>
+#include <vector>
 
 #include "tests-common.h"
 
@@ -376,6 +380,226 @@ TEST(CompareTest, Custom) {
   ASSERT_VELOCYPACK_EXCEPTION(NormalizedCompare::equals(b.slice(), b.slice()), Exception::NotImplemented);
 }
 
+static int compareJson(std::string const& lhs, std::string const& rhs) {
+  int res = NormalizedCompare::compare(Parser::fromJson(lhs)->slice(), Parser::fromJson(rhs)->slice());
+  // results must be antisymmetric
+  EXPECT_EQ(-res, NormalizedCompare::compare(Parser::fromJson(rhs)->slice(), Parser::fromJson(lhs)->slice()));
+  return res;
+}
+
+TEST(CompareTest, CompareTypeOrder) {
+  ASSERT_LT(NormalizedCompare::compare(Slice::minKeySlice(), Slice::noneSlice()), 0);
+  ASSERT_LT(NormalizedCompare::compare(Slice::noneSlice(), Slice::nullSlice()), 0);
+  ASSERT_GT(NormalizedCompare::compare(Slice::maxKeySlice(), Parser::fromJson("{}")->slice()), 0);
+  ASSERT_EQ(0, NormalizedCompare::compare(Slice::minKeySlice(), Slice::minKeySlice()));
+  ASSERT_EQ(0, NormalizedCompare::compare(Slice::maxKeySlice(), Slice::maxKeySlice()));
+
+  std::vector<std::string> const values{ "null", "false", "true", "-1000.5", "0", "1", "100000000000", "\"\"", "\"a\"", "[]", "[null]", "{}", "{\"a\":null}" };
+  for (size_t i = 0; i < values.size(); ++i) {
+    ASSERT_EQ(0, compareJson(values[i], values[i]));
+    for (size_t j = i + 1; j < values.size(); ++j) {
+      ASSERT_LT(compareJson(values[i], values[j]), 0) << values[i] << " vs. " << values[j];
+    }
+  }
+}
+
+TEST(CompareTest, CompareNumbers) {
+  ASSERT_EQ(0, compareJson("0", "0.0"));
+  ASSERT_EQ(0, compareJson("0", "-0.0"));
+  ASSERT_EQ(0, compareJson("1", "1.0"));
+  ASSERT_EQ(0, compareJson("-1", "-1.0"));
+  ASSERT_EQ(0, compareJson("12345678", "12345678.0"));
+  ASSERT_EQ(0, compareJson("18446744073709551615", "18446744073709551615"));
+  ASSERT_LT(compareJson("1", "1.5"), 0);
+  ASSERT_LT(compareJson("-2", "-1.5"), 0);
+  ASSERT_LT(compareJson("-1", "0"), 0);
+  ASSERT_LT(compareJson("-6", "9"), 0);
+  ASSERT_LT(compareJson("9", "10"), 0);
+  ASSERT_LT(compareJson("-1", "18446744073709551615"), 0);
+  ASSERT_LT(compareJson("9223372036854775807", "9223372036854775808"), 0);
+  ASSERT_GT(compareJson("-9223372036854775808", "-1e300"), 0);
+  ASSERT_LT(compareJson("18446744073709551615", "1e20"), 0);
+  ASSERT_GT(compareJson("0.5", "-0.5"), 0);
+
+  // integers beyond 2^53 are compared exactly
+  Builder b;
+  b.openArray();
+  b.add(Value(static_cast<int64_t>(9007199254740993LL)));
+  b.add(Value(9007199254740992.0));
+  b.add(Value(static_cast<uint64_t>(9007199254740993ULL)));
+  b.close();
+  Slice s = b.slice();
+  ASSERT_GT(NormalizedCompare::compare(s.at(0), s.at(1)), 0);
+  ASSERT_LT(NormalizedCompare::compare(s.at(1), s.at(0)), 0);
+  ASSERT_GT(NormalizedCompare::compare(s.at(2), s.at(1)), 0);
+  ASSERT_EQ(0, NormalizedCompare::compare(s.at(0), s.at(2)));
+}
+
+TEST(CompareTest, CompareNaN) {
+  Builder b;
+  b.openArray();
+  b.add(Value(std::numeric_limits<double>::quiet_NaN()));
+  b.add(Value(std::numeric_limits<double>::infinity()));
+  b.add(Value(static_cast<int64_t>(-5)));
+  b.add(Value(static_cast<uint64_t>(5)));
+  b.close();
+  Slice s = b.slice();
+  ASSERT_EQ(0, NormalizedCompare::compare(s.at(0), s.at(0)));
+  for (size_t i = 1; i < 4; ++i) {
+    ASSERT_GT(NormalizedCompare::compare(s.at(0), s.at(i)), 0);
+    ASSERT_LT(NormalizedCompare::compare(s.at(i), s.at(0)), 0);
+  }
+}
+
+TEST(CompareTest, CompareStrings) {
+  ASSERT_EQ(0, compareJson("\"\"", "\"\""));
+  ASSERT_EQ(0, compareJson("\"abc\"", "\"abc\""));
+  ASSERT_LT(compareJson("\"\"", "\"a\""), 0);
+  ASSERT_LT(compareJson("\"a\"", "\"ab\""), 0);
+  ASSERT_LT(compareJson("\"A\"", "\"a\""), 0);
+  ASSERT_LT(compareJson("\"ab\"", "\"b\""), 0);
+  ASSERT_LT(compareJson("\"z\"", "\"\xc3\xa4\""), 0);
+
+  std::string const longString(300, 'x');
+  ASSERT_EQ(0, compareJson("\"" + longString + "\"", "\"" + longString + "\""));
+  ASSERT_LT(compareJson("\"" + longString + "\"", "\"" + longString + "x\""), 0);
+  ASSERT_LT(compareJson("\"xxx\"", "\"" + longString + "\""), 0);
+  ASSERT_GT(compareJson("\"y\"", "\"" + longString + "\""), 0);
+}
+
+TEST(CompareTest, CompareArrays) {
+  ASSERT_EQ(0, compareJson("[]", "[]"));
+  ASSERT_EQ(0, compareJson("[1,2,3]", "[1.0,2,3.0]"));
+  ASSERT_LT(compareJson("[]", "[null]"), 0);
+  ASSERT_LT(compareJson("[1,2]", "[1,2,3]"), 0);
+  ASSERT_LT(compareJson("[1,2,3]", "[1,3]"), 0);
+  ASSERT_LT(compareJson("[1,[2,\"a\"]]", "[1,[2,\"b\"]]"), 0);
+  ASSERT_LT(compareJson("[1,2,3]", "[\"1\"]"), 0);
+}
+
+TEST(CompareTest, CompareObjects) {
+  ASSERT_EQ(0, compareJson("{}", "{}"));
+  ASSERT_EQ(0, compareJson("{\"a\":1,\"b\":2}", "{\"b\":2,\"a\":1}"));
+  ASSERT_EQ(0, compareJson("{\"a\":1,\"b\":{\"c\":[1],\"d\":2}}", "{\"b\":{\"d\":2.0,\"c\":[1]},\"a\":1}"));
+  ASSERT_LT(compareJson("{}", "{\"a\":null}"), 0);
+  ASSERT_LT(compareJson("{\"a\":1}", "{\"a\":2}"), 0);
+  ASSERT_LT(compareJson("{\"a\":1}", "{\"a\":1,\"b\":1}"), 0);
+  ASSERT_LT(compareJson("{\"b\":1}", "{\"a\":1}"), 0);
+  ASSERT_GT(compareJson("{\"a\":1,\"b\":1}", "{\"a\":1,\"c\":1}"), 0);
+
+  Options options;
+  options.buildUnindexedObjects = true;
+  std::shared_ptr<Builder> b1 = Parser::fromJson("{\"x\":1,\"a\":[1,2],\"m\":\"m\"}", &options);
+  options.buildUnindexedObjects = false;
+  options.buildHashedObjects = true;
+  options.hashedObjectMinLength = 1;
+  std::shared_ptr<Builder> b2 = Parser::fromJson("{\"m\":\"m\",\"x\":1,\"a\":[1,2]}", &options);
+  ASSERT_EQ(0, NormalizedCompare::compare(b1->slice(), b2->slice()));
+}
+
+TEST(CompareTest, CompareTranslatedKeys) {
+  std::unique_ptr<AttributeTranslator> translator(new AttributeTranslator);
+  translator->add("zzz", 1);
+  translator->seal();
+
+  AttributeTranslatorScope scope(translator.get());
+
+  Options options;
+  options.attributeTranslator = translator.get();
+  std::shared_ptr<Builder> b1 = Parser::fromJson("{\"zzz\":1,\"a\":2}", &options);
+  std::shared_ptr<Builder> b2 = Parser::fromJson("{\"a\":2,\"zzz\":1}");
+  ASSERT_EQ(0, NormalizedCompare::compare(b1->slice(), b2->slice()));
+
+  std::shared_ptr<Builder> b3 = Parser::fromJson("{\"a\":2,\"zzz\":0}");
+  ASSERT_GT(NormalizedCompare::compare(b1->slice(), b3->slice()), 0);
+}
+
+TEST(CompareTest, CompareExternals) {
+  std::shared_ptr<Builder> value = Parser::fromJson("[1,\"foo\"]");
+  Builder b;
+  b.add(Value(static_cast<void const*>(value->slice().start()), ValueType::External));
+
+  ASSERT_EQ(0, NormalizedCompare::compare(b.slice(), value->slice()));
+  ASSERT_EQ(0, NormalizedCompare::compare(value->slice(), b.slice()));
+  ASSERT_LT(NormalizedCompare::compare(b.slice(), Parser::fromJson("[1,\"goo\"]")->slice()), 0);
+}
+
+TEST(CompareTest, CompareCustom) {
+  Builder b;
+  uint8_t* p = b.add(ValuePair(2ULL, ValueType::Custom));
+  *p++ = 0xf0;
+  *p++ = 0xaa;
+
+  ASSERT_VELOCYPACK_EXCEPTION(NormalizedCompare::compare(b.slice(), b.slice()), Exception::NotImplemented);
+  ASSERT_LT(NormalizedCompare::compare(Parser::fromJson("{}")->slice(), b.slice()), 0);
+}
+
+TEST(CompareTest, CompareConsistentWithEquals) {
+  std::shared_ptr<Builder> b = Parser::fromJson("[null,false,true,0,-0.0,1,1.0,-1,2.5,\"\",\"a\",\"b\",[],[1],[1.0],{},{\"a\":1},{\"a\":1.0},{\"b\":1}]");
+  for (auto const& lhs : ArrayIterator(b->slice())) {
+    for (auto const& rhs : ArrayIterator(b->slice())) {
+      ASSERT_EQ(NormalizedCompare::equals(lhs, rhs), NormalizedCompare::compare(lhs, rhs) == 0);
+    }
+  }
+}
+
+TEST(CompareTest, EqualsSmallIntsAndShortStrings) {
+  // 0 as Int and as UInt with a one-byte value, instead of a SmallInt
+  uint8_t const intZero[] = { 0x20, 0x00 };
+  uint8_t const uintZero[] = { 0x28, 0x00 };
+
+  Builder b;
+  b.openArray();
+  for (int64_t i = -6; i <= 9; ++i) {
+    b.add(Value(i));
+    b.add(Value(static_cast<double>(i)));
+  }
+  b.add(Slice(intZero));
+  b.add(Slice(uintZero));
+  for (auto const& s : { std::string(), std::string("a"), std::string("b"),
+                         std::string("ab"), std::string("ba"),
+                         std::string(126, 'x'), std::string(127, 'x') }) {
+    b.add(Value(s));
+  }
+  b.close();
+  ASSERT_EQ(0x30, b.slice().at(12).head());
+  ASSERT_EQ(0x20, b.slice().at(32).head());
+
+  for (auto const& lhs : ArrayIterator(b.slice())) {
+    for (auto const& rhs : ArrayIterator(b.slice())) {
+      ASSERT_EQ(NormalizedCompare::equals(lhs, rhs), NormalizedCompare::compare(lhs, rhs) == 0)
+          << lhs.toJson() << " vs. " << rhs.toJson();
+    }
+  }
+  // a SmallInt and a short string with the same payload
+  ASSERT_FALSE(NormalizedCompare::equals(Parser::fromJson("0")->slice(), Parser::fromJson("\"\"")->slice()));
+}
+
+TEST(CompareTest, NormalizedLess) {
+  std::shared_ptr<Builder> b = Parser::fromJson("[{\"b\":1},\"b\",3,[2],null,-1.5,true,{\"a\":1},\"a\",[1,2],2,false,1.0,1]");
+
+  std::vector<Slice> values;
+  for (auto const& it : ArrayIterator(b->slice())) {
+    values.emplace_back(it);
+  }
+  std::sort(values.begin(), values.end(), NormalizedLess());
+
+  Builder sorted;
+  sorted.openArray();
+  for (auto const& it : values) {
+    sorted.add(it);
+  }
+  sorted.close();
+  ASSERT_EQ("[null,false,true,-1.5,1,1,2,3,\"a\",\"b\",[1,2],[2],{\"b\":1},{\"a\":1}]", sorted.toJson());
+
+  // equal values collapse in ordered containers
+  std::set<Slice, NormalizedLess> unique(values.begin(), values.end());
+  ASSERT_EQ(values.size() - 1, unique.size());
+
+  Builder c = Collection::sort(b->slice(), NormalizedLess());
+  ASSERT_EQ(sorted.toJson(), c.toJson());
+}
+
 int main(int argc, char* argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
 
@@ -0,0 +1,216 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tests-common.h"
+
+#include "velocypack/DocumentFile.h"
+
+static std::vector<std::shared_ptr<Builder>> buildDocuments() {
+  std::vector<std::shared_ptr<Builder>> documents;
+  for (auto const& json : { "{\"_key\":\"a\",\"value\":1}", "null", "[1,2,3]",
+                            "\"foo\"", "{}", "{\"nested\":{\"x\":[true,false]}}" }) {
+    documents.emplace_back(Parser::fromJson(json));
+  }
+  return documents;
+}
+
+static std::string writeDocuments(
+    std::vector<std::shared_ptr<Builder>> const& documents) {
+  std::string data;
+  StringSink sink(&data);
+  DocumentFileWriter writer(&sink);
+  for (auto const& it : documents) {
+    writer.add(it->slice());
+  }
+  writer.finish();
+  return data;
+}
+
+static void checkDocuments(DocumentFile const& file,
+                           std::vector<std::shared_ptr<Builder>> const& documents) {
+  ASSERT_EQ(documents.size(), file.size());
+  for (size_t i = 0; i < documents.size(); ++i) {
+    ASSERT_TRUE(documents[i]->slice().equals(file.at(i)));
+    ASSERT_TRUE(documents[i]->slice().equals(file[i]));
+  }
+  ASSERT_VELOCYPACK_EXCEPTION(file.at(documents.size()), Exception::IndexOutOfBounds);
+}
+
+TEST(DocumentFileTest, WriteAndRead) {
+  std::vector<std::shared_ptr<Builder>> documents = buildDocuments();
+  std::string const data = writeDocuments(documents);
+
+  ValueLength expected = DocumentFile::HeaderSize + DocumentFile::FooterSize;
+  for (auto const& it : documents) {
+    expected += it->size() + 8;
+  }
+  ASSERT_EQ(expected, data.size());
+  ASSERT_EQ(0, memcmp("VPKF", data.data(), 4));
+
+  DocumentFile file(reinterpret_cast<uint8_t const*>(data.data()), data.size());
+  checkDocuments(file, documents);
+
+  // the Slices point into the data
+  ASSERT_EQ(reinterpret_cast<uint8_t const*>(data.data()) + DocumentFile::HeaderSize,
+            file.at(0).start());
+}
+
+TEST(DocumentFileTest, Empty) {
+  std::string const data = writeDocuments({});
+  ASSERT_EQ(DocumentFile::HeaderSize + DocumentFile::FooterSize, data.size());
+
+  DocumentFile file(reinterpret_cast<uint8_t const*>(data.data()), data.size());
+  ASSERT_EQ(0UL, file.size());
+  ASSERT_VELOCYPACK_EXCEPTION(file.at(0), Exception::IndexOutOfBounds);
+}
+
+TEST(DocumentFileTest, WriterIndexes) {
+  std::string data;
+  StringSink sink(&data);
+  DocumentFileWriter writer(&sink);
+  ASSERT_EQ(0UL, writer.size());
+  ASSERT_EQ(0UL, writer.add(Slice::nullSlice()));
+  ASSERT_EQ(1UL, writer.add(Slice::trueSlice()));
+  ASSERT_EQ(2UL, writer.size());
+  writer.finish();
+
+  ASSERT_VELOCYPACK_EXCEPTION(writer.add(Slice::nullSlice()), Exception::InternalError);
+  ASSERT_VELOCYPACK_EXCEPTION(writer.finish(), Exception::InternalError);
+}
+
+TEST(DocumentFileTest, Externals) {
+  std::shared_ptr<Builder> value = Parser::fromJson("{\"a\":[1,\"foo\"]}");
+  Builder external;
+  external.add(Value(static_cast<void const*>(value->slice().start()), ValueType::External));
+
+  std::string data;
+  StringSink sink(&data);
+  DocumentFileWriter writer(&sink);
+  writer.add(external.slice());
+  writer.finish();
+
+  DocumentFile file(reinterpret_cast<uint8_t const*>(data.data()), data.size());
+  ASSERT_TRUE(value->slice().equals(file.at(0)));
+}
+
+TEST(DocumentFileTest, SaveAndMapFile) {
+  std::vector<std::shared_ptr<Builder>> documents = buildDocuments();
+  std::string const filename("testsDocumentFile.tmp");
+  {
+    std::ofstream ofs(filename, std::ofstream::out | std::ofstream::binary |
+                                    std::ofstream::trunc);
+    OutputFileStreamSink sink(&ofs);
+    DocumentFileWriter writer(&sink);
+    for (auto const& it : documents) {
+      writer.add(it->slice());
+    }
+    writer.finish();
+  }
+
+  {
+    DocumentFile file(filename);
+    checkDocuments(file, documents);
+
+    file.advise(DocumentFile::SequentialAccess);
+    checkDocuments(file, documents);
+  }
+
+  std::remove(filename.c_str());
+
+  ASSERT_VELOCYPACK_EXCEPTION(DocumentFile(filename), Exception::IOError);
+}
+
+TEST(DocumentFileTest, InvalidHeaderAndFooter) {
+  std::string const data = writeDocuments(buildDocuments());
+
+  auto load = [](std::string const& data) {
+    DocumentFile file(reinterpret_cast<uint8_t const*>(data.data()), data.size());
+  };
+
+  // too short
+  for (size_t length = 0; length < DocumentFile::HeaderSize + DocumentFile::FooterSize; ++length) {
+    ASSERT_VELOCYPACK_EXCEPTION(load(data.substr(0, length)), Exception::InvalidDocumentFile);
+  }
+  // truncated offset table or documents
+  ASSERT_VELOCYPACK_EXCEPTION(load(data.substr(8)), Exception::InvalidDocumentFile);
+  ASSERT_VELOCYPACK_EXCEPTION(load(data.substr(0, 8) + data.substr(9)), Exception::InvalidDocumentFile);
+
+  std::string copy = data;
+  copy[0] = 'X';
+  ASSERT_VELOCYPACK_EXCEPTION(load(copy), Exception::InvalidDocumentFile);
+
+  copy = data;
+  copy[4] = 2;
+  ASSERT_VELOCYPACK_EXCEPTION(load(copy), Exception::InvalidDocumentFile);
+
+  // number of documents does not match the offset table
+  copy = data;
+  copy[copy.size() - 16] += 1;
+  ASSERT_VELOCYPACK_EXCEPTION(load(copy), Exception::InvalidDocumentFile);
+
+  // offset of the offset table out of bounds
+  copy = data;
+  copy[copy.size() - 1] = '\x7f';
+  ASSERT_VELOCYPACK_EXCEPTION(load(copy), Exception::InvalidDocumentFile);
+}
+
+TEST(DocumentFileTest, InvalidDocuments) {
+  std::vector<std::shared_ptr<Builder>> documents = buildDocuments();
+  std::string const data = writeDocuments(documents);
+  ValueLength const tableOffset = data.size() - DocumentFile::FooterSize - 8 * documents.size();
+
+  // every offset that does not point to the start of its document is
+  // detected when accessing the document
+  for (size_t i = 0; i < documents.size(); ++i) {
+    for (uint8_t delta : { 1, 2, 0x80 }) {
+      std::string copy = data;
+      copy[tableOffset + 8 * i] += delta;
+      DocumentFile file(reinterpret_cast<uint8_t const*>(copy.data()), copy.size());
+      ASSERT_VELOCYPACK_EXCEPTION(file.at(i), Exception::InvalidDocumentFile);
+    }
+  }
+
+  // document with a length that does not match its offsets. the first
+  // document is an Object with a 1 byte length
+  std::string copy = data;
+  ASSERT_EQ(0x0bU, static_cast<uint8_t>(copy[DocumentFile::HeaderSize]));
+  copy[DocumentFile::HeaderSize + 1] -= 1;
+  DocumentFile file(reinterpret_cast<uint8_t const*>(copy.data()), copy.size());
+  ASSERT_VELOCYPACK_EXCEPTION(file.at(0), Exception::InvalidDocumentFile);
+  ASSERT_TRUE(documents[1]->slice().equals(file.at(1)));
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
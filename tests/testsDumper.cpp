@@ -24,11 +24,25 @@
 /// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <ostream>
+#include <new>
 #include <string>
+#include <type_traits>
 
 #include "tests-common.h"
 
+namespace arangodb {
+namespace velocypack {
+
+extern void enableNativeStringFunctions();
+extern void enableBuiltinStringFunctions();
+
+}
+}
+
 static unsigned char LocalBuffer[4096];
 
 TEST(DumperTest, CreateWithoutOptions) {
@@ -625,6 +639,82 @@ TEST(StringDumperTest, NumberDoubleScientific4) {
   ASSERT_EQ(std::string("3.4239493e+104"), buffer);
 }
 
+TEST(StringDumperTest, NumberDoubleShortest) {
+  std::vector<std::pair<double, std::string>> const values{
+      {0.1, "0.1"},
+      {1.0 / 3.0, "0.3333333333333333"},
+      {2.718281828459045, "2.718281828459045"},
+      {13650404408.95646, "13650404408.95646"},
+      {65294498705027980.0, "65294498705027980"},
+      {4.148662197091951e34, "4.148662197091951e+34"},
+      {9.12443524144154e-309, "9.12443524144154e-309"},
+      {5e-324, "5e-324"},
+      {2.2250738585072014e-308, "2.2250738585072014e-308"},
+      {1.7976931348623157e308, "1.7976931348623157e+308"},
+      {-1e23, "-1e+23"},
+      {9007199254740993.0, "9007199254740992"}};
+
+  for (auto const& it : values) {
+    Builder b;
+    b.add(Value(it.first));
+    ASSERT_EQ(it.second, Dumper::toString(b.slice()));
+  }
+}
+
+TEST(StringDumperTest, NumberDoubleFpconv) {
+  // Grisu2 does not always find the shortest representation
+  Options options;
+  options.doubleFormat = Options::FpconvDoubleFormat;
+
+  Builder b;
+  b.add(Value(13650404408.95646));
+  ASSERT_EQ(std::string("13650404408.956461"),
+            Dumper::toString(b.slice(), &options));
+  ASSERT_EQ(std::string("13650404408.95646"), Dumper::toString(b.slice()));
+}
+
+TEST(StringDumperTest, NumberDoubleRoundtrip) {
+  Options fpconvOptions;
+  fpconvOptions.doubleFormat = Options::FpconvDoubleFormat;
+
+  uint64_t x = 88172645463325252ULL;
+  for (size_t i = 0; i < 100000; ++i) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    uint64_t bits = x;
+    if (i % 3 == 1) {
+      // exponents around 0
+      bits = (bits & 0x800FFFFFFFFFFFFFULL) |
+             (static_cast<uint64_t>(1023 + (bits >> 52) % 80 - 40) << 52);
+    } else if (i % 3 == 2) {
+      // subnormals
+      bits &= 0x800FFFFFFFFFFFFFULL;
+    }
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    if (std::isnan(d) || !std::isfinite(d)) {
+      continue;
+    }
+
+    Builder b;
+    b.add(Value(d));
+    std::string const shortest = Dumper::toString(b.slice());
+    double const parsed = strtod(shortest.c_str(), nullptr);
+    ASSERT_EQ(0, memcmp(&d, &parsed, sizeof(d))) << shortest;
+    ASSERT_LE(shortest.size(), Dumper::toString(b.slice(), &fpconvOptions).size());
+  }
+}
+
+TEST(StringDumperTest, NumberDoubleParseDumpRoundtrip) {
+  std::string const value(
+      "[0.1,0.5,-1.5,3.14159,123456.789,0.001,1e-7,-2.5e-10,1e+21,"
+      "6.02214076e+23,1.2345e+300,0.3333333333333333]");
+
+  std::shared_ptr<Builder> b = Parser::fromJson(value);
+  ASSERT_EQ(value, b->slice().toJson());
+}
+
 TEST(StringDumperTest, NumberInt1) {
   Builder b;
   b.add(Value(static_cast<int64_t>(123456789)));
@@ -649,6 +739,51 @@ TEST(StringDumperTest, NumberInt2) {
   ASSERT_EQ(std::string("-123456789"), buffer);
 }
 
+TEST(StringDumperTest, NumberIntAllLengths) {
+  std::vector<uint64_t> values{0, 1, UINT64_MAX, UINT64_MAX - 1};
+  uint64_t p = 1;
+  for (int i = 1; i < 20; ++i) {
+    p *= 10;
+    values.push_back(p - 1);
+    values.push_back(p);
+    values.push_back(p + 1);
+    values.push_back(p / 2 + 47);
+  }
+
+  for (uint64_t v : values) {
+    Builder b;
+    b.add(Value(v));
+    ASSERT_EQ(std::to_string(v), Dumper::toString(b.slice()));
+
+    if (v <= static_cast<uint64_t>(INT64_MAX)) {
+      int64_t const i = static_cast<int64_t>(v);
+      Builder bi;
+      bi.add(Value(i));
+      ASSERT_EQ(std::to_string(i), Dumper::toString(bi.slice()));
+      Builder bn;
+      bn.add(Value(-i));
+      ASSERT_EQ(std::to_string(-i), Dumper::toString(bn.slice()));
+    }
+  }
+
+  Builder b;
+  b.add(Value(INT64_MIN));
+  ASSERT_EQ(std::string("-9223372036854775808"), Dumper::toString(b.slice()));
+
+  for (int64_t i = -6; i <= 9; ++i) {
+    Builder bs;
+    bs.add(Value(i, ValueType::SmallInt));
+    ASSERT_TRUE(bs.slice().isSmallInt());
+    ASSERT_EQ(std::to_string(i), Dumper::toString(bs.slice()));
+  }
+
+  std::string buffer;
+  StringSink sink(&buffer);
+  Dumper dumper(&sink);
+  dumper.appendUInt(18446744073709551615ULL);
+  ASSERT_EQ(std::string("18446744073709551615"), buffer);
+}
+
 TEST(StringDumperTest, NumberZero) {
   Builder b;
   b.add(Value(static_cast<int64_t>(0)));
@@ -982,6 +1117,83 @@ TEST(StringDumperTest, AppendStringTestTruncatedFourByteUtf8) {
                               Exception::InvalidUtf8Sequence);
 }
 
+TEST(StringDumperTest, AppendStringTestTruncatedUtf8AfterLongRun) {
+  std::string buffer;
+  StringSink sink(&buffer);
+  Dumper dumper(&sink);
+  std::string const value = std::string(70, 'x') + "\xe2\x82";
+  ASSERT_VELOCYPACK_EXCEPTION(dumper.appendString(value),
+                              Exception::InvalidUtf8Sequence);
+}
+
+static void checkEscapesAtAllPositions() {
+  std::vector<std::pair<char, std::string>> const escapes{
+      {'"', "\\\""}, {'\\', "\\\\"}, {'/', "\\/"}, {'\n', "\\n"},
+      {'\x00', "\\u0000"}, {'\x01', "\\u0001"}, {'\x1f', "\\u001F"}};
+
+  Options options;
+  options.escapeForwardSlashes = true;
+
+  // lengths and positions around the 16 and 32 byte blocks of the scans
+  for (size_t len = 1; len <= 70; ++len) {
+    for (size_t pos = 0; pos < len; ++pos) {
+      for (auto const& it : escapes) {
+        std::string value(len, 'x');
+        value[pos] = it.first;
+
+        std::string buffer;
+        StringSink sink(&buffer);
+        Dumper dumper(&sink, &options);
+        dumper.appendString(value);
+        ASSERT_EQ("\"" + std::string(pos, 'x') + it.second +
+                      std::string(len - pos - 1, 'x') + "\"",
+                  buffer);
+      }
+    }
+  }
+}
+
+static void checkMultibytesAtAllPositions() {
+  Options options;
+  options.escapeUnicode = true;
+
+  for (size_t len = 0; len <= 70; ++len) {
+    for (size_t pos = 0; pos <= len; ++pos) {
+      std::string value(len, 'x');
+      value.insert(pos, "\xe2\x82\xac");
+
+      std::string buffer;
+      StringSink sink(&buffer);
+      Dumper dumper(&sink);
+      dumper.appendString(value);
+      ASSERT_EQ("\"" + value + "\"", buffer);
+
+      buffer.clear();
+      Dumper escaper(&sink, &options);
+      escaper.appendString(value);
+      ASSERT_EQ("\"" + std::string(pos, 'x') + "\\u20AC" +
+                    std::string(len - pos, 'x') + "\"",
+                buffer);
+    }
+  }
+}
+
+TEST(StringDumperTest, EscapesAtAllPositions) {
+  checkEscapesAtAllPositions();
+}
+
+TEST(StringDumperTest, MultibytesAtAllPositions) {
+  checkMultibytesAtAllPositions();
+}
+
+TEST(StringDumperTest, UseNonSSEEscapeScan) {
+  // modify global function pointers!
+  enableBuiltinStringFunctions();
+  checkEscapesAtAllPositions();
+  checkMultibytesAtAllPositions();
+  enableNativeStringFunctions();
+}
+
 TEST(StringDumperTest, AppendStringSlice1) {
   Options options;
   options.escapeForwardSlashes = true;
@@ -1463,6 +1675,538 @@ TEST(StringDumperTest, AttributeTranslationsInSubObjects) {
         "\"bark\":3,\"foo\":true}}"), result);
 }
 
+TEST(DumperTest, LargeOutput) {
+  // the output exceeds the Dumper's local buffer several times, with
+  // values of all sizes crossing its boundaries
+  std::string expected("[");
+  Builder b;
+  b.openArray();
+  for (size_t i = 0; i < 2000; ++i) {
+    std::string value(i % 97, 'x');
+    if (i % 250 == 0) {
+      value = std::string(3000 + i, 'y');
+    }
+    b.add(Value(value));
+    b.add(Value(i));
+    if (i > 0) {
+      expected.push_back(',');
+    }
+    expected.append("\"" + value + "\"," + std::to_string(i));
+  }
+  b.close();
+  expected.push_back(']');
+
+  std::string buffer;
+  StringSink sink(&buffer);
+  Dumper dumper(&sink);
+  dumper.dump(b.slice());
+  ASSERT_EQ(expected, buffer);
+
+  // every public method hands over its output to the sink
+  dumper.appendUInt(42);
+  ASSERT_EQ(expected + "42", buffer);
+  dumper.appendString("foo");
+  ASSERT_EQ(expected + "42\"foo\"", buffer);
+}
+
+TEST(DumperTest, ObjectsInStorageOrder) {
+  std::string const value(R"({"b":1,"a":[{"z":true,"y":null}],"c":{"x":"foo","w":{}}})");
+  std::shared_ptr<Builder> b = Parser::fromJson(value);
+
+  ASSERT_EQ(std::string(R"({"a":[{"y":null,"z":true}],"b":1,"c":{"w":{},"x":"foo"}})"),
+            Dumper::toString(b->slice()));
+
+  Options options;
+  options.dumpAttributesInIndexOrder = false;
+  ASSERT_EQ(value, Dumper::toString(b->slice(), &options));
+
+  options.prettyPrint = true;
+  ASSERT_EQ(std::string("{\n  \"b\" : 1,\n  \"a\" : [\n    {\n      \"z\" : true,\n      \"y\" : null\n    }\n  ],\n  \"c\" : {\n    \"x\" : \"foo\",\n    \"w\" : {\n    }\n  }\n}"),
+            Dumper::toString(b->slice(), &options));
+}
+
+TEST(DumperTest, ArraysOfAllTypes) {
+  std::vector<std::string> const values{
+      "[]", "[1]", "[1,2,3]", "[\"a\",\"b\",\"c\"]", "[1,\"ab\",[],{}]",
+      "[[1,2],[3,4],[5,6]]"};
+  for (bool unindexed : {false, true}) {
+    Options options;
+    options.buildUnindexedArrays = unindexed;
+    for (auto const& value : values) {
+      Parser parser(&options);
+      parser.parse(value);
+      ASSERT_EQ(value, Dumper::toString(parser.builder().slice()));
+    }
+  }
+
+  // arrays with equal-size members but more than 255 bytes
+  Builder b;
+  b.openArray();
+  for (int i = 0; i < 100; ++i) {
+    b.add(Value("abcdefghij"));
+  }
+  b.close();
+  ASSERT_EQ(0x03, b.slice().head());
+  std::string expected("[");
+  for (int i = 0; i < 100; ++i) {
+    expected.append(i == 0 ? "\"abcdefghij\"" : ",\"abcdefghij\"");
+  }
+  expected.push_back(']');
+  ASSERT_EQ(expected, Dumper::toString(b.slice()));
+
+  Options options;
+  options.prettyPrint = true;
+  ASSERT_EQ(std::string("[\n  1,\n  [\n  ]\n]"),
+            Dumper::toString(Parser::fromJson("[1,[]]")->slice(), &options));
+}
+
+TEST(DumperTest, MaxBytes) {
+  std::shared_ptr<Builder> b = Parser::fromJson(R"([1,"foo",{"a":[true,null]},12345678901234,"bar"])");
+  std::string const full = Dumper::toString(b->slice());
+
+  Options options;
+  for (size_t limit = 1; limit < full.size(); ++limit) {
+    options.dumpMaxBytes = limit;
+    ASSERT_EQ(full.substr(0, limit) + "...", Dumper::toString(b->slice(), &options));
+  }
+  // output that fits is not marked as truncated
+  options.dumpMaxBytes = full.size();
+  ASSERT_EQ(full, Dumper::toString(b->slice(), &options));
+  options.dumpMaxBytes = full.size() + 1;
+  ASSERT_EQ(full, Dumper::toString(b->slice(), &options));
+}
+
+TEST(DumperTest, MaxBytesLargeString) {
+  std::string const value(10 * 1024 * 1024, 'x');
+  Builder b;
+  b.openArray();
+  b.add(Value(value));
+  b.add(Value(value));
+  b.close();
+
+  Options options;
+  options.dumpMaxBytes = 100;
+  ASSERT_EQ("[\"" + std::string(98, 'x') + "...",
+            Dumper::toString(b.slice(), &options));
+
+  // the limit also applies to output that bypasses the local buffer
+  options.dumpMaxBytes = 5000;
+  ASSERT_EQ("[\"" + std::string(4998, 'x') + "...",
+            Dumper::toString(b.slice(), &options));
+}
+
+TEST(DumperTest, MaxBytesUtf8) {
+  // two-byte sequences are not cut in the middle
+  std::string const value("\"\xc3\xa4\xc3\xa4\xc3\xa4\xc3\xa4\"");
+  std::shared_ptr<Builder> b = Parser::fromJson(value);
+
+  Options options;
+  options.dumpMaxBytes = 4;
+  ASSERT_EQ(std::string("\"\xc3\xa4..."), Dumper::toString(b->slice(), &options));
+  options.dumpMaxBytes = 5;
+  ASSERT_EQ(std::string("\"\xc3\xa4\xc3\xa4..."), Dumper::toString(b->slice(), &options));
+
+  // escape sequences count in full
+  b = Parser::fromJson(R"(["\n\n\n\n"])");
+  options.dumpMaxBytes = 5;
+  ASSERT_EQ(std::string(R"(["\n\...)"), Dumper::toString(b->slice(), &options));
+}
+
+TEST(DumperTest, ReuseAfterException) {
+  Builder b;
+  b.openArray();
+  b.add(Value("foo"));
+  b.add(Value(std::string("der fuchs"), ValueType::Binary));
+  b.close();
+
+  Options options;
+  std::string buffer;
+  StringSink sink(&buffer);
+  Dumper dumper(&sink, &options);
+  ASSERT_VELOCYPACK_EXCEPTION(dumper.dump(b.slice()), Exception::NoJsonEquivalent);
+
+  // the output buffered before the exception is neither written nor counted
+  // against dumpMaxBytes by the next dump
+  std::shared_ptr<Builder> valid = Parser::fromJson(R"({"a":[1,2,3]})");
+  buffer.clear();
+  dumper.dump(valid->slice());
+  ASSERT_EQ(std::string(R"({"a":[1,2,3]})"), buffer);
+
+  ASSERT_VELOCYPACK_EXCEPTION(dumper.dump(b.slice()), Exception::NoJsonEquivalent);
+  buffer.clear();
+  options.dumpMaxBytes = 13;
+  dumper.dump(valid->slice());
+  ASSERT_EQ(std::string(R"({"a":[1,2,3]})"), buffer);
+}
+
+TEST(DumperTest, MaxDepth) {
+  std::shared_ptr<Builder> b = Parser::fromJson(R"([1,[2,[3]],{"a":{"b":1}},[],{}])");
+
+  Options options;
+  options.dumpMaxDepth = 1;
+  ASSERT_EQ(std::string("[1,[...],{...},[],{}]"), Dumper::toString(b->slice(), &options));
+  options.dumpMaxDepth = 2;
+  ASSERT_EQ(std::string(R"([1,[2,[...]],{"a":{...}},[],{}])"), Dumper::toString(b->slice(), &options));
+  options.dumpMaxDepth = 3;
+  ASSERT_EQ(std::string(R"([1,[2,[3]],{"a":{"b":1}},[],{}])"), Dumper::toString(b->slice(), &options));
+
+  options.prettyPrint = true;
+  options.dumpMaxDepth = 1;
+  ASSERT_EQ(std::string("[\n  1,\n  [...],\n  {...},\n  [\n  ],\n  {\n  }\n]"),
+            Dumper::toString(b->slice(), &options));
+}
+
+TEST(DumperTest, MaxElements) {
+  std::shared_ptr<Builder> b = Parser::fromJson(R"([1,2,3,{"a":1,"b":2,"c":3},[1,2]])");
+
+  Options options;
+  options.dumpMaxElements = 2;
+  ASSERT_EQ(std::string("[1,2,...(3 more)]"), Dumper::toString(b->slice(), &options));
+  options.dumpMaxElements = 4;
+  ASSERT_EQ(std::string(R"([1,2,3,{"a":1,"b":2,"c":3},...(1 more)])"),
+            Dumper::toString(b->slice(), &options));
+  options.dumpMaxElements = 2;
+  ASSERT_EQ(std::string(R"({"a":1,"b":2,...(1 more)})"),
+            Dumper::toString(b->slice().at(3), &options));
+  options.dumpMaxElements = 5;
+  ASSERT_EQ(std::string(R"([1,2,3,{"a":1,"b":2,"c":3},[1,2]])"),
+            Dumper::toString(b->slice(), &options));
+
+  options.prettyPrint = true;
+  options.dumpMaxElements = 1;
+  ASSERT_EQ(std::string("[\n  1,\n  ...(4 more)\n]"), Dumper::toString(b->slice(), &options));
+  ASSERT_EQ(std::string("{\n  \"a\" : 1,\n  ...(2 more)\n}"),
+            Dumper::toString(b->slice().at(3), &options));
+
+  // unindexed arrays
+  options.prettyPrint = false;
+  options.buildUnindexedArrays = true;
+  Parser parser(&options);
+  parser.parse("[1,\"a\",[],2]");
+  ASSERT_EQ(0x13, parser.builder().slice().head());
+  ASSERT_EQ(std::string("[1,...(3 more)]"), Dumper::toString(parser.builder().slice(), &options));
+}
+
+TEST(DumperTest, LimitsAreResetAfterDump) {
+  std::shared_ptr<Builder> b = Parser::fromJson(R"(["abcdefghij",[1]])");
+  Options options;
+  options.dumpMaxBytes = 5;
+
+  std::string buffer;
+  StringSink sink(&buffer);
+  Dumper dumper(&sink, &options);
+  dumper.dump(b->slice());
+  ASSERT_EQ(std::string(R"(["abc...)"), buffer);
+
+  buffer.clear();
+  dumper.appendString("abcdefghij");
+  ASSERT_EQ(std::string(R"("abcdefghij")"), buffer);
+
+  // each dump starts with the full limit
+  buffer.clear();
+  dumper.dump(b->slice());
+  dumper.append(b->slice().at(1));
+  ASSERT_EQ(std::string(R"(["abc...[1])"), buffer);
+}
+
+static Builder buildLargeArray(Options const* options) {
+  Builder b(options);
+  b.openArray();
+  for (size_t i = 0; i < 20000; ++i) {
+    b.openObject();
+    b.add("id", Value(i));
+    b.add("name", Value("document " + std::to_string(i)));
+    b.add("values", Value(ValueType::Array));
+    for (size_t j = 0; j < i % 5; ++j) {
+      b.add(Value(j * 1.5));
+    }
+    b.close();
+    b.close();
+  }
+  b.close();
+  return b;
+}
+
+static std::string dumpParallel(Slice slice, Options const* options,
+                                size_t concurrency) {
+  std::string buffer;
+  StringSink sink(&buffer);
+  Dumper::dumpParallel(slice, &sink, options, concurrency);
+  return buffer;
+}
+
+TEST(DumperTest, Parallel) {
+  for (bool unindexed : {false, true}) {
+    Options options;
+    options.buildUnindexedArrays = unindexed;
+    Builder b = buildLargeArray(&options);
+    ASSERT_EQ(unindexed, b.slice().head() == 0x13);
+
+    for (bool prettyPrint : {false, true}) {
+      options.prettyPrint = prettyPrint;
+      std::string const expected = Dumper::toString(b.slice(), &options);
+      for (size_t concurrency : {0, 1, 2, 3, 8}) {
+        ASSERT_EQ(expected, dumpParallel(b.slice(), &options, concurrency));
+      }
+    }
+  }
+
+  // members of equal size in an array without index table
+  Builder b;
+  b.openArray();
+  for (size_t i = 0; i < 100000; ++i) {
+    b.add(Value("abcdefghij"));
+  }
+  b.close();
+  ASSERT_EQ(0x04, b.slice().head());
+  ASSERT_EQ(Dumper::toString(b.slice()), dumpParallel(b.slice(), &Options::Defaults, 4));
+}
+
+TEST(DumperTest, ParallelSmallValues) {
+  std::vector<std::string> const values{
+      "[]", "[1]", "[1,2,3]", "{\"a\":[1,2]}", "\"abc\"", "null"};
+  for (auto const& value : values) {
+    std::shared_ptr<Builder> b = Parser::fromJson(value);
+    ASSERT_EQ(value, dumpParallel(b->slice(), &Options::Defaults, 4));
+  }
+
+  // limited output is dumped on a single thread, with the same result
+  Options options;
+  Builder b = buildLargeArray(&options);
+  options.dumpMaxElements = 2;
+  ASSERT_EQ(Dumper::toString(b.slice(), &options), dumpParallel(b.slice(), &options, 4));
+}
+
+TEST(DumperTest, ParallelTranslatedKeys) {
+  std::unique_ptr<AttributeTranslator> translator(new AttributeTranslator);
+  translator->add("id", 1);
+  translator->add("name", 2);
+  translator->add("values", 3);
+  translator->seal();
+
+  Options options;
+  options.attributeTranslator = translator.get();
+  Builder b = buildLargeArray(&options);
+
+  // the workers use the translator of the calling thread
+  AttributeTranslatorThreadScope scope(translator.get());
+  ASSERT_EQ(Dumper::toString(b.slice(), &options), dumpParallel(b.slice(), &options, 4));
+}
+
+TEST(DumperTest, ParallelUnsupportedType) {
+  Builder b;
+  b.openArray();
+  for (size_t i = 0; i < 100000; ++i) {
+    if (i == 77777) {
+      b.add(ValuePair("\x01\x02", 2, ValueType::Binary));
+    } else {
+      b.add(Value(i));
+    }
+  }
+  b.close();
+
+  ASSERT_VELOCYPACK_EXCEPTION(dumpParallel(b.slice(), &Options::Defaults, 4),
+                              Exception::NoJsonEquivalent);
+
+  Options options;
+  options.unsupportedTypeBehavior = Options::NullifyUnsupportedType;
+  ASSERT_EQ(Dumper::toString(b.slice(), &options), dumpParallel(b.slice(), &options, 4));
+}
+
+TEST(DumperTest, ParallelCustomTypeAppend) {
+  // a handler that dumps a value through the Dumper itself
+  struct MyCustomTypeHandler : public CustomTypeHandler {
+    void dump(Slice const&, Dumper* dumper, Slice const&) {
+      Builder b;
+      b.add(Value("x"));
+      dumper->append(b.slice());
+    }
+  };
+
+  MyCustomTypeHandler handler;
+  Options options;
+  options.customTypeHandler = &handler;
+
+  Builder b(&options);
+  b.openArray();
+  for (size_t i = 0; i < 40000; ++i) {
+    b.openArray();
+    uint8_t* p = b.add(ValuePair(2ULL, ValueType::Custom));
+    *p++ = 0xf0;
+    *p = 1;
+    b.openArray();
+    b.add(Value(1));
+    b.close();
+    b.close();
+    b.openArray();
+    b.add(Value(2));
+    b.close();
+  }
+  b.close();
+  ASSERT_TRUE(b.slice().byteSize() >= 256 * 1024);
+
+  std::string const expected = Dumper::toString(b.slice(), &options);
+  std::string const prefix("[[\"x\",[1]],[2],[\"x\",[1]],[2],");
+  ASSERT_EQ(prefix, expected.substr(0, prefix.size()));
+  ASSERT_EQ(expected, dumpParallel(b.slice(), &options, 2));
+  ASSERT_EQ(expected, dumpParallel(b.slice(), &options, 4));
+}
+
+// a sink that throws on the n-th call of any of its methods
+struct ThrowingSink final : public Sink {
+  explicit ThrowingSink(size_t n) : calls(0), n(n) {}
+
+  void check() {
+    if (++calls == n) {
+      throw Exception(Exception::IOError, "sink failed");
+    }
+  }
+
+  void push_back(char) override { check(); }
+  void append(std::string const&) override { check(); }
+  void append(char const*) override { check(); }
+  void append(char const*, ValueLength) override { check(); }
+  void reserve(ValueLength) override { check(); }
+
+  size_t calls;
+  size_t const n;
+};
+
+TEST(DumperTest, ParallelThrowingSink) {
+  Options options;
+  Builder b = buildLargeArray(&options);
+
+  // the sink fails on reserving, on the opening bracket, on a chunk and
+  // on the closing bracket. the exception must be rethrown after all
+  // worker threads have been joined
+  size_t calls;
+  {
+    ThrowingSink sink(0);
+    Dumper::dumpParallel(b.slice(), &sink, &options, 4);
+    calls = sink.calls;
+  }
+  ASSERT_TRUE(calls > 3);
+  for (size_t n : {size_t(1), size_t(2), size_t(3), calls}) {
+    ThrowingSink sink(n);
+    ASSERT_VELOCYPACK_EXCEPTION(Dumper::dumpParallel(b.slice(), &sink, &options, 4),
+                                Exception::IOError);
+  }
+}
+
+TEST(DumperTest, TranslatedKeysCached) {
+  std::unique_ptr<AttributeTranslator> translator(new AttributeTranslator);
+  translator->add("a/b", 1);
+  translator->add("m\xc3\xb6t\xc3\xb6r", 2);
+  translator->add("x\"y", 3);
+  translator->seal();
+
+  Options options;
+  options.attributeTranslator = translator.get();
+  Builder b(&options);
+  b.openArray();
+  for (int i = 0; i < 3; ++i) {
+    b.openObject();
+    b.add("a/b", Value(i));
+    b.add("m\xc3\xb6t\xc3\xb6r", Value(i));
+    b.add("x\"y", Value(i));
+    b.add("untranslated", Value(i));
+    b.close();
+  }
+  b.close();
+
+  AttributeTranslatorThreadScope scope(translator.get());
+
+  // a Dumper reused with different escape options
+  std::string buffer;
+  StringSink sink(&buffer);
+  Dumper dumper(&sink, &options);
+  dumper.dump(b.slice().at(0));
+  ASSERT_EQ(std::string("{\"a/b\":0,\"m\xc3\xb6t\xc3\xb6r\":0,\"untranslated\":0,\"x\\\"y\":0}"), buffer);
+
+  options.escapeForwardSlashes = true;
+  options.escapeUnicode = true;
+  buffer.clear();
+  dumper.dump(b.slice().at(1));
+  ASSERT_EQ(std::string("{\"a\\/b\":1,\"m\\u00F6t\\u00F6r\":1,\"untranslated\":1,\"x\\\"y\":1}"), buffer);
+
+  options.escapeForwardSlashes = false;
+  options.escapeUnicode = false;
+  options.prettyPrint = true;
+  buffer.clear();
+  dumper.dump(b.slice().at(2));
+  ASSERT_EQ(std::string("{\n  \"a/b\" : 2,\n  \"m\xc3\xb6t\xc3\xb6r\" : 2,\n  \"untranslated\" : 2,\n  \"x\\\"y\" : 2\n}"), buffer);
+
+  // a different translator for the same ids
+  std::unique_ptr<AttributeTranslator> other(new AttributeTranslator);
+  other->add("one", 1);
+  other->add("two", 2);
+  other->add("three", 3);
+  other->seal();
+  AttributeTranslatorThreadScope otherScope(other.get());
+
+  options.prettyPrint = false;
+  buffer.clear();
+  dumper.dump(b.slice().at(0));
+  ASSERT_EQ(std::string("{\"one\":0,\"two\":0,\"untranslated\":0,\"three\":0}"), buffer);
+}
+
+TEST(DumperTest, TranslatedKeysCacheTranslatorReplaced) {
+  // a translator that is replaced by another one at the same address, as
+  // when a dictionary is reloaded and the allocator reuses the memory
+  std::aligned_storage<sizeof(AttributeTranslator), alignof(AttributeTranslator)>::type storage;
+
+  AttributeTranslator* translator = new (&storage) AttributeTranslator;
+  translator->add("foo", 1);
+  translator->add("bar", 2);
+  translator->seal();
+
+  Options options;
+  options.attributeTranslator = translator;
+  Builder b(&options);
+  b.openObject();
+  b.add("foo", Value(1));
+  b.add("bar", Value(2));
+  b.close();
+  ASSERT_TRUE(b.slice().keyAt(0, false).isInteger());
+
+  std::string buffer;
+  StringSink sink(&buffer);
+  Dumper dumper(&sink, &options);
+  {
+    AttributeTranslatorThreadScope scope(translator);
+    dumper.dump(b.slice());
+  }
+  ASSERT_EQ("{\"bar\":2,\"foo\":1}", buffer);
+
+  translator->~AttributeTranslator();
+  AttributeTranslator* other = new (&storage) AttributeTranslator;
+  ASSERT_EQ(translator, other);
+  other->add("baz", 1);
+  other->add("qux", 2);
+  other->seal();
+
+  buffer.clear();
+  {
+    AttributeTranslatorThreadScope scope(other);
+    dumper.dump(b.slice());
+  }
+  // attributes are dumped in the index order of the original names
+  ASSERT_EQ("{\"qux\":2,\"baz\":1}", buffer);
+
+  other->~AttributeTranslator();
+}
+
+TEST(DumperTest, SmallIntsAllValues) {
+  Builder b;
+  b.openArray();
+  for (int64_t i = -6; i <= 9; ++i) {
+    b.add(Value(i));
+  }
+  b.close();
+  ASSERT_EQ(0x3a, b.slice().at(0).head());
+  ASSERT_EQ(std::string("[-6,-5,-4,-3,-2,-1,0,1,2,3,4,5,6,7,8,9]"), Dumper::toString(b.slice()));
+}
+
 TEST(DumperTest, EmptyAttributeName) {
   Builder builder;
   Parser parser(builder);
@@ -30,6 +30,7 @@ TEST(ExceptionTest, TestMessages) {
   ASSERT_STREQ("Internal error", Exception::message(Exception::InternalError));
   ASSERT_STREQ("Not implemented",
                Exception::message(Exception::NotImplemented));
+  ASSERT_STREQ("I/O error", Exception::message(Exception::IOError));
   ASSERT_STREQ("Type has no equivalent in JSON",
                Exception::message(Exception::NoJsonEquivalent));
   ASSERT_STREQ("Parse error", Exception::message(Exception::ParseError));
@@ -54,6 +55,10 @@ TEST(ExceptionTest, TestMessages) {
   ASSERT_STREQ("Cannot translate key",
                Exception::message(Exception::CannotTranslateKey));
   ASSERT_STREQ("Key not found", Exception::message(Exception::KeyNotFound));
+  ASSERT_STREQ("Invalid key dictionary",
+               Exception::message(Exception::InvalidKeyDictionary));
+  ASSERT_STREQ("Invalid document file",
+               Exception::message(Exception::InvalidDocumentFile));
   ASSERT_STREQ("Builder value not yet sealed",
                Exception::message(Exception::BuilderNotSealed));
   ASSERT_STREQ("Need open Object",
@@ -74,6 +79,8 @@ TEST(ExceptionTest, TestMessages) {
                Exception::message(Exception::ValidatorInvalidType));
   ASSERT_STREQ("Invalid length found in binary data",
                Exception::message(Exception::ValidatorInvalidLength));
+  ASSERT_STREQ("Arrays or Objects nested too deeply in binary data",
+               Exception::message(Exception::ValidatorNestingTooDeep));
 
   ASSERT_STREQ("Unknown error", Exception::message(Exception::UnknownError));
   ASSERT_STREQ("Unknown error",
@@ -0,0 +1,154 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "tests-common.h"
+
+#include "velocypack/KeyDictionary.h"
+
+static std::unique_ptr<AttributeTranslator> buildTranslator() {
+  std::unique_ptr<AttributeTranslator> translator(new AttributeTranslator);
+  translator->add("foo", 1);
+  translator->add("bar", 2);
+  translator->add("quetzalcoatl", 3);
+  translator->add("mötör", 1000);
+  translator->seal();
+  return translator;
+}
+
+static void checkTranslator(AttributeTranslator* translator) {
+  ASSERT_EQ(4UL, translator->count());
+  ASSERT_EQ(1ULL, Slice(translator->translate("foo")).getUInt());
+  ASSERT_EQ(2ULL, Slice(translator->translate("bar")).getUInt());
+  ASSERT_EQ(3ULL, Slice(translator->translate("quetzalcoatl")).getUInt());
+  ASSERT_EQ(1000ULL, Slice(translator->translate("mötör")).getUInt());
+  ASSERT_EQ(nullptr, translator->translate("baz"));
+  ASSERT_EQ("quetzalcoatl", Slice(translator->translate(3)).copyString());
+  ASSERT_EQ("mötör", Slice(translator->translate(1000)).copyString());
+  ASSERT_EQ(nullptr, translator->translate(4));
+}
+
+TEST(KeyDictionaryTest, Serialize) {
+  std::unique_ptr<AttributeTranslator> translator = buildTranslator();
+  std::string const data = KeyDictionary::serialize(*translator);
+
+  ASSERT_EQ(KeyDictionary::HeaderSize + translator->dictionary().byteSize(), data.size());
+  ASSERT_EQ(0, memcmp("VPKD", data.data(), 4));
+
+  KeyDictionary dictionary(reinterpret_cast<uint8_t const*>(data.data()), data.size());
+  checkTranslator(dictionary.translator());
+}
+
+TEST(KeyDictionaryTest, SaveAndLoadFile) {
+  std::string const filename("testsKeyDictionary.tmp");
+  std::unique_ptr<AttributeTranslator> translator = buildTranslator();
+
+  Options options;
+  options.attributeTranslator = translator.get();
+  Builder b(&options);
+  Parser parser(b, &options);
+  parser.parse("{\"foo\":1,\"bar\":{\"mötör\":true},\"baz\":null}");
+  ASSERT_TRUE(b.slice().keyAt(0, false).isInteger());
+
+  KeyDictionary::save(*translator, filename);
+  translator.reset();
+
+  {
+    KeyDictionary dictionary(filename);
+    checkTranslator(dictionary.translator());
+
+    // data built with the original translator can be decoded
+    AttributeTranslatorThreadScope scope(dictionary.translator());
+    ASSERT_EQ("{\"bar\":{\"mötör\":true},\"baz\":null,\"foo\":1}", b.slice().toJson());
+  }
+
+  std::remove(filename.c_str());
+}
+
+TEST(KeyDictionaryTest, EmptyTranslator) {
+  AttributeTranslator translator;
+  translator.seal();
+  std::string const data = KeyDictionary::serialize(translator);
+
+  KeyDictionary dictionary(reinterpret_cast<uint8_t const*>(data.data()), data.size());
+  ASSERT_EQ(0UL, dictionary.translator()->count());
+  ASSERT_EQ(nullptr, dictionary.translator()->translate("foo"));
+}
+
+TEST(KeyDictionaryTest, InvalidData) {
+  std::unique_ptr<AttributeTranslator> translator = buildTranslator();
+  std::string const data = KeyDictionary::serialize(*translator);
+
+  auto load = [](std::string const& value) {
+    KeyDictionary dictionary(reinterpret_cast<uint8_t const*>(value.data()), value.size());
+  };
+
+  // truncated
+  for (size_t i = 0; i < data.size(); ++i) {
+    ASSERT_VELOCYPACK_EXCEPTION(load(data.substr(0, i)), Exception::InvalidKeyDictionary);
+  }
+  // trailing garbage
+  ASSERT_VELOCYPACK_EXCEPTION(load(data + "x"), Exception::InvalidKeyDictionary);
+
+  // wrong magic
+  std::string copy = data;
+  copy[0] = 'X';
+  ASSERT_VELOCYPACK_EXCEPTION(load(copy), Exception::InvalidKeyDictionary);
+
+  // unsupported version
+  copy = data;
+  copy[4] = 2;
+  ASSERT_VELOCYPACK_EXCEPTION(load(copy), Exception::InvalidKeyDictionary);
+
+  // corrupted payload
+  copy = data;
+  copy[KeyDictionary::HeaderSize + 3] ^= 0x20;
+  ASSERT_VELOCYPACK_EXCEPTION(load(copy), Exception::InvalidKeyDictionary);
+}
+
+TEST(KeyDictionaryTest, InvalidDictionaryContents) {
+  AttributeTranslator empty;
+  empty.load(Slice::emptyObjectSlice());
+  ASSERT_EQ(0UL, empty.count());
+
+  ASSERT_VELOCYPACK_EXCEPTION(AttributeTranslator().load(Parser::fromJson("{\"foo\":-1}")->slice()), Exception::InvalidKeyDictionary);
+  ASSERT_VELOCYPACK_EXCEPTION(AttributeTranslator().load(Parser::fromJson("[1]")->slice()), Exception::InvalidKeyDictionary);
+  ASSERT_VELOCYPACK_EXCEPTION(AttributeTranslator().load(Parser::fromJson("{\"foo\":\"bar\"}")->slice()), Exception::InvalidKeyDictionary);
+}
+
+TEST(KeyDictionaryTest, MissingFile) {
+  ASSERT_VELOCYPACK_EXCEPTION(KeyDictionary("testsKeyDictionary.does-not-exist"), Exception::IOError);
+  ASSERT_VELOCYPACK_EXCEPTION(KeyDictionary::save(AttributeTranslator(), "does-not-exist/foo"), Exception::IOError);
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,255 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "tests-common.h"
+
+#include "velocypack/KeyEncoder.h"
+
+static int sign(int value) {
+  return (value > 0) - (value < 0);
+}
+
+static int compareKeys(std::string const& lhs, std::string const& rhs) {
+  return sign(lhs.compare(rhs));
+}
+
+// checks that the memcmp order of the encoded values of all pairs of
+// members of array is the same as the NormalizedCompare order
+static void checkOrder(Slice array) {
+  std::vector<Slice> values;
+  std::vector<std::string> keys;
+  for (auto const& it : ArrayIterator(array)) {
+    values.emplace_back(it);
+    keys.emplace_back(KeyEncoder::encode(it));
+  }
+  for (size_t i = 0; i < values.size(); ++i) {
+    for (size_t j = 0; j < values.size(); ++j) {
+      ASSERT_EQ(sign(NormalizedCompare::compare(values[i], values[j])),
+                compareKeys(keys[i], keys[j]))
+          << values[i].toJson() << " vs. " << values[j].toJson();
+    }
+  }
+}
+
+static void checkRoundtrip(Slice value) {
+  std::string const key = KeyEncoder::encode(value);
+  Builder b = KeyEncoder::decode(key);
+  ASSERT_EQ(0, NormalizedCompare::compare(value, b.slice()))
+      << value.toJson() << " vs. " << b.slice().toJson();
+  ASSERT_EQ(key, KeyEncoder::encode(b.slice()));
+}
+
+TEST(KeyEncoderTest, Scalars) {
+  Builder b;
+  b.openArray();
+  b.add(Value(ValueType::MinKey));
+  b.add(Value(ValueType::Illegal));
+  b.add(Value(ValueType::Null));
+  b.add(Value(false));
+  b.add(Value(true));
+  b.add(Value(0));
+  b.add(Value(ValueType::MaxKey));
+  b.add(Value(static_cast<int64_t>(1234567890123), ValueType::UTCDate));
+  b.add(Value(static_cast<int64_t>(-1234567890123), ValueType::UTCDate));
+  b.add(Value(static_cast<int64_t>(0), ValueType::UTCDate));
+  b.add(ValuePair("\x00\x01\xff", 3, ValueType::Binary));
+  b.add(ValuePair("\x00\x01", 2, ValueType::Binary));
+  b.add(ValuePair("", 0, ValueType::Binary));
+  b.close();
+
+  checkOrder(b.slice());
+  for (auto const& it : ArrayIterator(b.slice())) {
+    checkRoundtrip(it);
+  }
+
+  ASSERT_EQ(std::string("\x18", 1), KeyEncoder::encode(Slice::nullSlice()));
+  ASSERT_LT(KeyEncoder::encode(Slice::minKeySlice()), KeyEncoder::encode(Slice::noneSlice()));
+  ASSERT_LT(KeyEncoder::encode(Slice::noneSlice()), KeyEncoder::encode(Slice::nullSlice()));
+}
+
+TEST(KeyEncoderTest, Numbers) {
+  Builder b;
+  b.openArray();
+  for (int64_t v : std::vector<int64_t>{ INT64_MIN, INT64_MIN + 1, -9007199254740993LL, -1000000LL, -7LL, -6LL, -1LL, 0LL, 1LL, 2LL, 9LL, 10LL, 255LL, 256LL, 9007199254740993LL, INT64_MAX }) {
+    b.add(Value(v));
+  }
+  for (uint64_t v : std::vector<uint64_t>{ 0ULL, 1ULL, 9ULL, 1000ULL, 9223372036854775807ULL, 9223372036854775808ULL, UINT64_MAX }) {
+    b.add(Value(v));
+  }
+  for (double v : std::vector<double>{ -std::numeric_limits<double>::infinity(), -1.0e300, -9223372036854775808.0, -9007199254740992.0, -1.5, -1.0, -0.5, -4.9e-324, -0.0, 0.0, 4.9e-324, 2.2250738585072014e-308, 1.0e-10, 0.5, 1.0, 1.5, 2.0, 3.14159, 255.5, 9007199254740992.0, 18446744073709551616.0, 1.0e300, std::numeric_limits<double>::max(), std::numeric_limits<double>::infinity(), std::numeric_limits<double>::quiet_NaN() }) {
+    b.add(Value(v));
+  }
+  b.close();
+
+  checkOrder(b.slice());
+  for (auto const& it : ArrayIterator(b.slice())) {
+    checkRoundtrip(it);
+  }
+}
+
+TEST(KeyEncoderTest, NumbersEqualAcrossTypes) {
+  Builder b;
+  b.openArray();
+  b.add(Value(3));
+  b.add(Value(static_cast<uint64_t>(3)));
+  b.add(Value(static_cast<int64_t>(3)));
+  b.add(Value(3.0));
+  b.close();
+
+  std::string const key = KeyEncoder::encode(b.slice().at(0));
+  for (auto const& it : ArrayIterator(b.slice())) {
+    ASSERT_EQ(key, KeyEncoder::encode(it));
+  }
+  ASSERT_EQ(KeyEncoder::encode(Parser::fromJson("0")->slice()),
+            KeyEncoder::encode(Parser::fromJson("-0.0")->slice()));
+
+  // integral doubles are decoded as integers, others stay doubles
+  ASSERT_TRUE(KeyEncoder::decode(KeyEncoder::encode(Parser::fromJson("42.0")->slice())).slice().isInteger());
+  ASSERT_TRUE(KeyEncoder::decode(KeyEncoder::encode(Parser::fromJson("-42.5")->slice())).slice().isDouble());
+}
+
+TEST(KeyEncoderTest, Strings) {
+  std::shared_ptr<Builder> b = Parser::fromJson("[\"\",\"a\",\"aa\",\"ab\",\"b\",\"B\",\"\\u0000\",\"a\\u0000\",\"a\\u0000b\",\"\\u0001\",\"\xc3\xa4\",\"xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx\"]");
+  checkOrder(b->slice());
+  for (auto const& it : ArrayIterator(b->slice())) {
+    checkRoundtrip(it);
+  }
+}
+
+TEST(KeyEncoderTest, Arrays) {
+  std::shared_ptr<Builder> b = Parser::fromJson("[[],[null],[null,null],[false],[0],[1],[1,2],[1,2,3],[1,3],[\"a\"],[[]],[[1]],[{}],1,\"a\",{}]");
+  checkOrder(b->slice());
+  for (auto const& it : ArrayIterator(b->slice())) {
+    checkRoundtrip(it);
+  }
+}
+
+TEST(KeyEncoderTest, Objects) {
+  std::shared_ptr<Builder> b = Parser::fromJson("[{},{\"a\":null},{\"a\":1},{\"a\":2},{\"a\":1,\"b\":1},{\"a\":1,\"c\":1},{\"b\":1},{\"b\":[1,2]},{\"b\":{\"c\":\"d\"}},{\"aa\":1},{\"a\\u0000\":1},{\"\":false},[],\"x\"]");
+  checkOrder(b->slice());
+  for (auto const& it : ArrayIterator(b->slice())) {
+    checkRoundtrip(it);
+  }
+
+  // attribute order does not matter
+  ASSERT_EQ(KeyEncoder::encode(Parser::fromJson("{\"a\":1,\"b\":[2,3]}")->slice()),
+            KeyEncoder::encode(Parser::fromJson("{\"b\":[2,3.0],\"a\":1.0}")->slice()));
+}
+
+TEST(KeyEncoderTest, ObjectsWithMinKey) {
+  Builder b;
+  b.openArray();
+  b.openObject();
+  b.close();
+  b.openObject();
+  b.add("a", Value(ValueType::MinKey));
+  b.close();
+  b.openObject();
+  b.add("b", Value(ValueType::MinKey));
+  b.close();
+  b.openObject();
+  b.add("a", Value(ValueType::MinKey));
+  b.add("b", Value(ValueType::MinKey));
+  b.close();
+  b.openObject();
+  b.add("a", Value(1));
+  b.add("b", Value(ValueType::MinKey));
+  b.close();
+  b.openObject();
+  b.add("a", Value(ValueType::MinKey));
+  b.add("b", Value(1));
+  b.close();
+  b.openObject();
+  b.add("b", Value(1));
+  b.close();
+  b.close();
+
+  checkOrder(b.slice());
+  for (auto const& it : ArrayIterator(b.slice())) {
+    checkRoundtrip(it);
+  }
+}
+
+TEST(KeyEncoderTest, Externals) {
+  std::shared_ptr<Builder> value = Parser::fromJson("{\"a\":[1,\"foo\"]}");
+  Builder b;
+  b.add(Value(static_cast<void const*>(value->slice().start()), ValueType::External));
+
+  ASSERT_EQ(KeyEncoder::encode(value->slice()), KeyEncoder::encode(b.slice()));
+}
+
+TEST(KeyEncoderTest, CompoundKeys) {
+  std::shared_ptr<Builder> b = Parser::fromJson("[\"abc\",[1,2],17.5,{\"x\":null}]");
+
+  std::string key;
+  for (auto const& it : ArrayIterator(b->slice())) {
+    KeyEncoder::encode(it, key);
+  }
+
+  Builder result;
+  result.openArray();
+  uint8_t const* p = reinterpret_cast<uint8_t const*>(key.data());
+  ValueLength length = key.size();
+  while (length > 0) {
+    ValueLength consumed = KeyEncoder::decode(p, length, result);
+    p += consumed;
+    length -= consumed;
+  }
+  result.close();
+
+  ASSERT_EQ(b->toJson(), result.toJson());
+}
+
+TEST(KeyEncoderTest, Custom) {
+  Builder b;
+  uint8_t* p = b.add(ValuePair(2ULL, ValueType::Custom));
+  *p++ = 0xf0;
+  *p++ = 0xaa;
+
+  ASSERT_VELOCYPACK_EXCEPTION(KeyEncoder::encode(b.slice()), Exception::NotImplemented);
+}
+
+TEST(KeyEncoderTest, DecodeInvalid) {
+  ASSERT_VELOCYPACK_EXCEPTION(KeyEncoder::decode(std::string()), Exception::ParseError);
+  ASSERT_VELOCYPACK_EXCEPTION(KeyEncoder::decode(std::string("\x01", 1)), Exception::ParseError);
+  ASSERT_VELOCYPACK_EXCEPTION(KeyEncoder::decode(std::string("\x18\x18", 2)), Exception::ParseError);
+
+  std::string key = KeyEncoder::encode(Parser::fromJson("[1,\"abc\",{\"a\":1.5}]")->slice());
+  for (size_t i = 0; i < key.size(); ++i) {
+    ASSERT_VELOCYPACK_EXCEPTION(KeyEncoder::decode(key.substr(0, i)), Exception::ParseError);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
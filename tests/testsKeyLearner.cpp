@@ -0,0 +1,189 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tests-common.h"
+
+#include "velocypack/KeyLearner.h"
+
+static std::string makeDocument(size_t i) {
+  return "{\"firstName\":\"a\",\"lastName\":\"b\",\"id\":" + std::to_string(i) +
+         ",\"address\":{\"street\":\"c\",\"city\":\"d\"},\"rare" +
+         std::to_string(i) + "\":true}";
+}
+
+TEST(KeyLearnerTest, Empty) {
+  KeyLearner learner;
+  ASSERT_EQ(0UL, learner.count());
+  ASSERT_EQ(0ULL, learner.epoch());
+  ASSERT_NE(nullptr, learner.translator());
+  ASSERT_EQ(nullptr, learner.translator()->translate("foo"));
+}
+
+TEST(KeyLearnerTest, Observe) {
+  KeyLearner learner(3);
+
+  learner.observe("foo", 3);
+  learner.observe("foo", 3);
+  ASSERT_EQ(0UL, learner.count());
+  std::shared_ptr<AttributeTranslator> old = learner.translator();
+
+  learner.observe("foo", 3);
+  ASSERT_EQ(1UL, learner.count());
+  ASSERT_EQ(1ULL, learner.epoch());
+  ASSERT_EQ(1ULL, Slice(learner.translator()->translate("foo")).getUInt());
+
+  // translators of older epochs are not modified
+  ASSERT_EQ(nullptr, old->translate("foo"));
+  ASSERT_EQ(0UL, old->count());
+
+  for (int i = 0; i < 3; ++i) {
+    learner.observe("barbaz", 6);
+  }
+  ASSERT_EQ(2UL, learner.count());
+  ASSERT_EQ(2ULL, learner.epoch());
+  ASSERT_EQ(1ULL, Slice(learner.translator()->translate("foo")).getUInt());
+  ASSERT_EQ(2ULL, Slice(learner.translator()->translate("barbaz")).getUInt());
+  ASSERT_EQ("barbaz", Slice(learner.translator()->translate(2)).copyString());
+}
+
+TEST(KeyLearnerTest, ShortKeysAndMaxKeys) {
+  KeyLearner learner(1, 2, 3);
+
+  learner.observe("id", 2);
+  ASSERT_EQ(0UL, learner.count());
+
+  learner.observe("foo", 3);
+  learner.observe("bar", 3);
+  learner.observe("baz", 3);
+  ASSERT_EQ(2UL, learner.count());
+  ASSERT_EQ(nullptr, learner.translator()->translate("baz"));
+}
+
+TEST(KeyLearnerTest, Aging) {
+  // a key seen less often than the threshold within the aging interval
+  // must never be promoted, no matter how long the learner runs
+  KeyLearner learner(100);
+  for (int i = 0; i < 200000; ++i) {
+    if (i % 1000 == 0) {
+      learner.observe("occasional", 10);
+    }
+    std::string const key("noise" + std::to_string(i % 50000));
+    learner.observe(key.data(), key.size());
+  }
+  ASSERT_EQ(nullptr, learner.translator()->translate("occasional"));
+}
+
+TEST(KeyLearnerTest, Parser) {
+  KeyLearner learner(10);
+  Options options;
+  options.keyLearner = &learner;
+
+  std::vector<std::shared_ptr<Builder>> results;
+  for (size_t i = 0; i < 100; ++i) {
+    results.emplace_back(Parser::fromJson(makeDocument(i), &options));
+  }
+
+  // frequent attribute names have been learned, the others not
+  std::shared_ptr<AttributeTranslator> translator = learner.translator();
+  ASSERT_EQ(5UL, translator->count());
+  for (auto const& key : { "firstName", "lastName", "address", "street", "city" }) {
+    ASSERT_NE(nullptr, translator->translate(key));
+  }
+  ASSERT_EQ(nullptr, translator->translate("id"));
+  ASSERT_EQ(nullptr, translator->translate("rare0"));
+
+  // later documents are smaller
+  ASSERT_LT(results.back()->size(), results.front()->size());
+  ASSERT_TRUE(results.back()->slice().keyAt(0, false).isInteger());
+
+  // all documents can be decoded with the latest translator, and are
+  // still correctly sorted
+  AttributeTranslatorThreadScope scope(translator.get());
+  for (size_t i = 0; i < results.size(); ++i) {
+    Slice s = results[i]->slice();
+    ASSERT_EQ("a", s.get("firstName").copyString());
+    ASSERT_EQ("d", s.get(std::vector<std::string>({"address", "city"})).copyString());
+    ASSERT_EQ(i, s.get("id").getUInt());
+    ASSERT_TRUE(s.get("rare" + std::to_string(i)).getBool());
+  }
+}
+
+TEST(KeyLearnerTest, ExplicitTranslatorTakesPrecedence) {
+  std::unique_ptr<AttributeTranslator> translator(new AttributeTranslator);
+  translator->add("firstName", 42);
+  translator->seal();
+
+  KeyLearner learner(1);
+  Options options;
+  options.attributeTranslator = translator.get();
+  options.keyLearner = &learner;
+
+  std::shared_ptr<Builder> b = Parser::fromJson(makeDocument(1), &options);
+  ASSERT_EQ(0UL, learner.count());
+  ASSERT_EQ(42ULL, b->slice().keyAt(1, false).getUInt());
+}
+
+TEST(KeyLearnerTest, ConcurrentParsers) {
+  KeyLearner learner(20);
+  Options options;
+  options.keyLearner = &learner;
+
+  auto parse = [&options](size_t offset, std::vector<std::shared_ptr<Builder>>* results) {
+    for (size_t i = 0; i < 500; ++i) {
+      results->emplace_back(Parser::fromJson(makeDocument(offset + i), &options));
+    }
+  };
+
+  std::vector<std::vector<std::shared_ptr<Builder>>> results(4);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < results.size(); ++i) {
+    threads.emplace_back(parse, i * 1000, &results[i]);
+  }
+  for (auto& it : threads) {
+    it.join();
+  }
+
+  ASSERT_EQ(5UL, learner.count());
+  AttributeTranslatorThreadScope scope(learner.translator().get());
+  for (size_t i = 0; i < results.size(); ++i) {
+    for (size_t j = 0; j < results[i].size(); ++j) {
+      Slice s = results[i][j]->slice();
+      ASSERT_EQ("b", s.get("lastName").copyString());
+      ASSERT_EQ("c", s.get(std::vector<std::string>({"address", "street"})).copyString());
+      ASSERT_EQ(i * 1000 + j, s.get("id").getUInt());
+    }
+  }
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -62,6 +62,7 @@ TEST(BuilderTest, FixedArraysSizes) {
 
     Slice s(start);
     checkBuild(s, ValueType::Array, byteSizes[i]);
+    ASSERT_TRUE(Validator().validateParallel(start, byteSizes[i]));
     ASSERT_TRUE(0x02 <= *start && *start <= 0x05);  // Array without index tab
     ASSERT_TRUE(s.isArray());
     ASSERT_EQ(nrs[i], s.length());
@@ -109,6 +110,7 @@ TEST(BuilderTest, ArraysSizes) {
 
     Slice s(start);
     checkBuild(s, ValueType::Array, byteSizes[i]);
+    ASSERT_TRUE(Validator().validateParallel(start, byteSizes[i]));
     ASSERT_TRUE(0x06 <= *start && *start <= 0x09);  // Array without index tab
     ASSERT_TRUE(s.isArray());
     ASSERT_EQ(nrs[i] + 1, s.length());
@@ -162,6 +164,7 @@ TEST(BuilderTest, ObjectsSizesSorted) {
 
     Slice s(start);
     checkBuild(s, ValueType::Object, byteSizes[i]);
+    ASSERT_TRUE(Validator().validateParallel(start, byteSizes[i]));
     if (nrs[i] == 1) {
       ASSERT_TRUE(*start = 0x14);
     } else {
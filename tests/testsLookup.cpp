@@ -787,6 +787,188 @@ TEST(LookupTest, LookupBinaryLongObject) {
   }
 }
 
+TEST(LookupTest, LookupBinarySmallOffsets) {
+  // object sizes that result in 1- and 2-byte index table entries
+  for (size_t n : { 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 200 }) {
+    Builder b;
+    b.add(Value(ValueType::Object));
+    for (size_t i = 0; i < n; ++i) {
+      std::string key = "k";
+      key.append(std::to_string(i * 2));
+      b.add(key, Value(i));
+    }
+    b.close();
+
+    Slice s(b.start());
+    ASSERT_EQ(n, s.length());
+    ASSERT_TRUE(s.head() == 0x0b || s.head() == 0x0c);
+
+    for (size_t i = 0; i < n; ++i) {
+      std::string key = "k";
+      key.append(std::to_string(i * 2));
+      Slice v = s.get(key);
+      ASSERT_TRUE(v.isNumber());
+      ASSERT_EQ(i, v.getUInt());
+
+      // keys between, before and after the existing ones
+      key = "k";
+      key.append(std::to_string(i * 2 + 1));
+      ASSERT_TRUE(s.get(key).isNone());
+      key.push_back('x');
+      ASSERT_TRUE(s.get(key).isNone());
+    }
+    ASSERT_TRUE(s.get("").isNone());
+    ASSERT_TRUE(s.get("k").isNone());
+    ASSERT_TRUE(s.get("a").isNone());
+    ASSERT_TRUE(s.get("z").isNone());
+  }
+}
+
+TEST(LookupTest, LookupBinarySmallOffsetsTranslated) {
+  std::unique_ptr<AttributeTranslator> translator(new AttributeTranslator);
+
+  translator->add("foo", 1);
+  translator->add("bar", 2);
+  translator->add("baz", 3);
+  translator->add("qux", 4);
+  translator->seal();
+
+  AttributeTranslatorScope scope(translator.get());
+
+  Options options;
+  options.attributeTranslator = translator.get();
+
+  Builder b(&options);
+  b.add(Value(ValueType::Object));
+  b.add("foo", Value(1));
+  b.add("bar", Value(2));
+  b.add("baz", Value(3));
+  b.add("qux", Value(4));
+  b.add("bart", Value(5));
+  b.add("abc", Value(6));
+  b.add("zzz", Value(7));
+  b.close();
+
+  Slice s(b.start());
+  ASSERT_EQ(0x0b, s.head());
+
+  ASSERT_EQ(1UL, s.get("foo").getUInt());
+  ASSERT_EQ(2UL, s.get("bar").getUInt());
+  ASSERT_EQ(3UL, s.get("baz").getUInt());
+  ASSERT_EQ(4UL, s.get("qux").getUInt());
+  ASSERT_EQ(5UL, s.get("bart").getUInt());
+  ASSERT_EQ(6UL, s.get("abc").getUInt());
+  ASSERT_EQ(7UL, s.get("zzz").getUInt());
+  ASSERT_TRUE(s.get("ba").isNone());
+  ASSERT_TRUE(s.get("fooo").isNone());
+  ASSERT_TRUE(s.get("zzzz").isNone());
+}
+
+TEST(LookupTest, LookupHashedObject) {
+  Options options;
+  options.buildHashedObjects = true;
+  options.hashedObjectMinLength = 16;
+
+  for (size_t n : { 15, 16, 17, 100, 5000 }) {
+    Builder b(&options);
+    b.openObject();
+    for (size_t i = 0; i < n; ++i) {
+      b.add("test" + std::to_string(i), Value(i));
+    }
+    b.close();
+
+    Slice s(b.start());
+    if (n < 16) {
+      ASSERT_NE(0x15, s.head());
+    } else {
+      ASSERT_EQ(0x15, s.head());
+    }
+    ASSERT_TRUE(s.isObject());
+    ASSERT_TRUE(s.isSorted());
+    ASSERT_EQ(n, s.length());
+
+    for (size_t i = 0; i < n; ++i) {
+      std::string key = "test" + std::to_string(i);
+      Slice v = s.get(key);
+      ASSERT_TRUE(v.isNumber());
+      ASSERT_EQ(i, v.getUInt());
+      ASSERT_TRUE(s.hasKey(key));
+      ASSERT_TRUE(s.get(key + "x").isNone());
+    }
+    ASSERT_TRUE(s.get("").isNone());
+    ASSERT_TRUE(s.get("test").isNone());
+
+    // keys are sorted in the index table
+    std::string previous;
+    size_t count = 0;
+    for (auto const& it : ObjectIterator(s)) {
+      std::string key = it.key.copyString();
+      ASSERT_TRUE(count == 0 || previous < key);
+      ASSERT_EQ(key, "test" + std::to_string(it.value.getUInt()));
+      previous = key;
+      ++count;
+    }
+    ASSERT_EQ(n, count);
+
+    // sequential iteration walks the members in insertion order
+    count = 0;
+    for (auto const& it : ObjectIterator(s, true)) {
+      ASSERT_EQ(count, it.value.getUInt());
+      ++count;
+    }
+    ASSERT_EQ(n, count);
+  }
+}
+
+TEST(LookupTest, LookupHashedObjectNested) {
+  Options options;
+  options.buildHashedObjects = true;
+  options.hashedObjectMinLength = 2;
+
+  Parser parser(&options);
+  parser.parse("{\"foo\":{\"bar\":{\"baz\":1,\"qux\":[1,2]},\"a\":null},\"b\":true}");
+  Slice s = parser.builder().slice();
+
+  ASSERT_EQ(0x15, s.head());
+  ASSERT_TRUE(s.get("b").isTrue());
+  ASSERT_TRUE(s.get("foo").get("a").isNull());
+  ASSERT_EQ(1UL, s.get(std::vector<std::string>({"foo", "bar", "baz"})).getUInt());
+  ASSERT_EQ(2UL, s.get("foo").get("bar").get("qux").length());
+  ASSERT_EQ("{\"b\":true,\"foo\":{\"a\":null,\"bar\":{\"baz\":1,\"qux\":[1,2]}}}", s.toJson());
+
+  Validator validator;
+  ASSERT_TRUE(validator.validate(s.start(), s.byteSize()));
+}
+
+TEST(LookupTest, LookupHashedObjectTranslated) {
+  std::unique_ptr<AttributeTranslator> translator(new AttributeTranslator);
+
+  translator->add("foo", 1);
+  translator->add("bar", 2);
+  translator->seal();
+
+  AttributeTranslatorScope scope(translator.get());
+
+  Options options;
+  options.attributeTranslator = translator.get();
+  options.buildHashedObjects = true;
+  options.hashedObjectMinLength = 2;
+
+  Builder b(&options);
+  b.openObject();
+  b.add("foo", Value(1));
+  b.add("bar", Value(2));
+  b.add("baz", Value(3));
+  b.close();
+
+  Slice s(b.start());
+  ASSERT_EQ(0x15, s.head());
+  ASSERT_EQ(1UL, s.get("foo").getUInt());
+  ASSERT_EQ(2UL, s.get("bar").getUInt());
+  ASSERT_EQ(3UL, s.get("baz").getUInt());
+  ASSERT_TRUE(s.get("qux").isNone());
+}
+
 TEST(LookupTest, LookupInvalidTypeNull) {
   std::string const value("null");
 
@@ -2181,6 +2181,19 @@ TEST(ParserTest, DuplicateAttributesDisallowedUnsortedObject) {
                               Exception::DuplicateAttributeName);
 }
 
+TEST(ParserTest, DuplicateAttributesDisallowedHashedObject) {
+  Options options;
+  options.checkAttributeUniqueness = true;
+  options.buildHashedObjects = true;
+  options.hashedObjectMinLength = 2;
+
+  std::string const value("{\"foo\":1,\"bar\":3,\"foo\":2}");
+
+  Parser parser(&options);
+  ASSERT_VELOCYPACK_EXCEPTION(parser.parse(value),
+                              Exception::DuplicateAttributeName);
+}
+
 TEST(ParserTest, DuplicateSubAttributesAllowed) {
   Options options;
   options.checkAttributeUniqueness = true;
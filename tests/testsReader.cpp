@@ -0,0 +1,258 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "tests-common.h"
+
+#include "velocypack/Reader.h"
+
+static std::vector<std::string> buildValues() {
+  std::vector<std::string> values;
+  auto add = [&values](Slice s) {
+    values.emplace_back(s.startAs<char>(), s.byteSize());
+  };
+
+  for (auto const& json : { "null", "true", "-17", "1234567890123", "3.5",
+                            "\"foo\"", "[]", "{}", "[1,2,3]",
+                            "{\"a\":1,\"b\":[\"c\",{\"d\":null}]}" }) {
+    add(Parser::fromJson(json)->slice());
+  }
+
+  Options options;
+  options.buildUnindexedArrays = true;
+  options.buildUnindexedObjects = true;
+  Builder compact(&options);
+  compact.openArray();
+  compact.add(Value(1));
+  compact.openObject();
+  compact.add("x", Value("y"));
+  compact.close();
+  compact.close();
+  add(compact.slice());
+
+  Builder b;
+  b.add(Value(std::string(100000, 'x')));
+  add(b.slice());
+
+  b.clear();
+  b.add(ValuePair("\x00\x01\x02", 3, ValueType::Binary));
+  add(b.slice());
+
+  b.clear();
+  b.openObject();
+  for (size_t i = 0; i < 1000; ++i) {
+    b.add("attribute" + std::to_string(i), Value(static_cast<uint64_t>(i)));
+  }
+  b.close();
+  add(b.slice());
+
+  return values;
+}
+
+static std::string concat(std::vector<std::string> const& values) {
+  std::string result;
+  for (auto const& it : values) {
+    result.append(it);
+  }
+  return result;
+}
+
+static void checkValues(Reader& reader, std::vector<std::string> const& values) {
+  uint64_t position = 0;
+  Slice s;
+  for (auto const& it : values) {
+    ASSERT_TRUE(reader.next(s));
+    ASSERT_EQ(position, reader.position());
+    ASSERT_EQ(it.size(), s.byteSize());
+    ASSERT_EQ(it, std::string(s.startAs<char>(), s.byteSize()));
+    position += it.size();
+  }
+  ASSERT_FALSE(reader.next(s));
+  ASSERT_FALSE(reader.next(s));
+}
+
+TEST(ReaderTest, Empty) {
+  std::istringstream in("");
+  Reader reader(in);
+
+  Slice s;
+  ASSERT_FALSE(reader.next(s));
+}
+
+TEST(ReaderTest, Stream) {
+  std::vector<std::string> const values = buildValues();
+  std::string const data = concat(values);
+
+  for (ValueLength bufferSize : { ValueLength(1), ValueLength(7), ValueLength(200),
+                                  ValueLength(4096), Reader::DefaultBufferSize }) {
+    std::istringstream in(data);
+    Reader reader(in, nullptr, bufferSize);
+    checkValues(reader, values);
+  }
+}
+
+TEST(ReaderTest, Validate) {
+  std::vector<std::string> const values = buildValues();
+  std::string const data = concat(values);
+
+  Validator validator;
+  std::istringstream in(data);
+  Reader reader(in, &validator, 256);
+  checkValues(reader, values);
+}
+
+TEST(ReaderTest, ValidateInvalid) {
+  // Array with a member of an invalid type
+  std::string const data("\x31\x02\x04\x31\x16\x31", 6);
+  Slice s;
+
+  {
+    std::istringstream in(data);
+    Reader reader(in);
+    ASSERT_TRUE(reader.next(s));
+    ASSERT_TRUE(reader.next(s));
+    ASSERT_EQ(1ULL, reader.position());
+    ASSERT_EQ(4ULL, s.byteSize());
+    ASSERT_TRUE(reader.next(s));
+    ASSERT_FALSE(reader.next(s));
+  }
+
+  {
+    Validator validator;
+    std::istringstream in(data);
+    Reader reader(in, &validator);
+    ASSERT_TRUE(reader.next(s));
+    ASSERT_VELOCYPACK_EXCEPTION(reader.next(s), Exception::ValidatorInvalidType);
+  }
+}
+
+TEST(ReaderTest, InvalidType) {
+  std::istringstream in(std::string("\x18\x16", 2));
+  Reader reader(in);
+
+  Slice s;
+  ASSERT_TRUE(reader.next(s));
+  ASSERT_TRUE(s.isNull());
+  ASSERT_VELOCYPACK_EXCEPTION(reader.next(s), Exception::ValidatorInvalidType);
+}
+
+TEST(ReaderTest, Truncated) {
+  std::vector<std::string> const values = buildValues();
+  std::string const data = concat(values);
+
+  size_t end = 0;
+  for (auto const& it : values) {
+    // cut off the input in the middle of the value, including its length
+    // field
+    for (size_t length : { size_t(1), size_t(2), size_t(5), it.size() / 2, it.size() - 1 }) {
+      if (length == 0 || length >= it.size()) {
+        continue;
+      }
+      std::istringstream in(data.substr(0, end + length));
+      Reader reader(in, nullptr, 64);
+
+      Slice s;
+      for (size_t i = 0; i < end; i += s.byteSize()) {
+        ASSERT_TRUE(reader.next(s));
+      }
+      ASSERT_VELOCYPACK_EXCEPTION(reader.next(s), Exception::ValidatorInvalidLength);
+    }
+    end += it.size();
+  }
+}
+
+TEST(ReaderTest, LengthOutOfBounds) {
+  // Array with an 8 byte length of 2^56 - 1, which must not be allocated
+  std::istringstream in(std::string("\x05\xff\xff\xff\xff\xff\xff\xff\x00\x31\x31", 11));
+  Reader reader(in, nullptr, 16);
+
+  Slice s;
+  ASSERT_VELOCYPACK_EXCEPTION(reader.next(s), Exception::ValidatorInvalidLength);
+
+  // compact Array with a length that does not even cover its length field
+  std::istringstream in2(std::string("\x13\x01\x31", 3));
+  Reader reader2(in2);
+  ASSERT_VELOCYPACK_EXCEPTION(reader2.next(s), Exception::ValidatorInvalidLength);
+}
+
+#ifndef _WIN32
+TEST(ReaderTest, FileDescriptor) {
+  std::vector<std::string> const values = buildValues();
+  std::string const filename("testsReader.tmp");
+  {
+    std::ofstream ofs(filename, std::ofstream::out | std::ofstream::binary |
+                                    std::ofstream::trunc);
+    // write the values several times, so that the file is larger than
+    // the buffer
+    for (size_t i = 0; i < 10; ++i) {
+      ofs << concat(values);
+    }
+  }
+
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  ASSERT_NE(-1, fd);
+  {
+    Reader reader(fd, nullptr, 65536);
+    Slice s;
+    uint64_t count = 0;
+    uint64_t position = 0;
+    while (reader.next(s)) {
+      ASSERT_EQ(position, reader.position());
+      ASSERT_EQ(values[count % values.size()],
+                std::string(s.startAs<char>(), s.byteSize()));
+      position += s.byteSize();
+      ++count;
+    }
+    ASSERT_EQ(10 * values.size(), count);
+  }
+  ::close(fd);
+
+  std::remove(filename.c_str());
+}
+
+TEST(ReaderTest, InvalidFileDescriptor) {
+  Reader reader(-1);
+
+  Slice s;
+  ASSERT_VELOCYPACK_EXCEPTION(reader.next(s), Exception::IOError);
+}
+#endif
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,219 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tests-common.h"
+
+#include "velocypack/DocumentFile.h"
+#include "velocypack/SharedSlice.h"
+
+// a Buffer that reports when it is destroyed
+static std::shared_ptr<Buffer<uint8_t>> buildBuffer(std::string const& json,
+                                                    bool& destroyed) {
+  std::shared_ptr<Builder> b = Parser::fromJson(json);
+  destroyed = false;
+  return std::shared_ptr<Buffer<uint8_t>>(
+      new Buffer<uint8_t>(*b->buffer()),
+      [&destroyed](Buffer<uint8_t>* buffer) {
+        destroyed = true;
+        delete buffer;
+      });
+}
+
+TEST(SharedSliceTest, Empty) {
+  SharedSlice s;
+  ASSERT_TRUE(s.slice().isNone());
+  ASSERT_EQ(0L, s.useCount());
+
+  SharedSlice copy(s);
+  ASSERT_TRUE(copy.slice().isNone());
+}
+
+TEST(SharedSliceTest, FromBuilder) {
+  Builder b;
+  b.openObject();
+  b.add("a", Value(1));
+  b.add("b", Value("foo"));
+  b.close();
+  uint8_t const* start = b.start();
+
+  SharedSlice s(b.steal());
+  ASSERT_EQ(start, s.start());
+  ASSERT_EQ(1L, s.useCount());
+  ASSERT_EQ("{\"a\":1,\"b\":\"foo\"}", s.slice().toJson());
+  ASSERT_EQ(s.slice().byteSize(), s.byteSize());
+}
+
+TEST(SharedSliceTest, FromParser) {
+  SharedSlice s(Parser::fromJson("[1,{\"x\":[true]}]"));
+  ASSERT_EQ("[1,{\"x\":[true]}]", s.slice().toJson());
+
+  Parser parser;
+  parser.parse("{\"y\":null}");
+  SharedSlice t(parser.steal());
+  ASSERT_TRUE(t.get("y").slice().isNull());
+}
+
+TEST(SharedSliceTest, CopiesShareOwner) {
+  bool destroyed;
+  SharedSlice s(buildBuffer("[1,2,3]", destroyed));
+  ASSERT_EQ(1L, s.useCount());
+
+  {
+    SharedSlice copy(s);
+    ASSERT_EQ(2L, s.useCount());
+    ASSERT_EQ(s.start(), copy.start());
+
+    SharedSlice assigned;
+    assigned = copy;
+    ASSERT_EQ(3L, s.useCount());
+
+    SharedSlice moved(std::move(assigned));
+    ASSERT_EQ(3L, s.useCount());
+  }
+  ASSERT_EQ(1L, s.useCount());
+  ASSERT_FALSE(destroyed);
+
+  s = SharedSlice();
+  ASSERT_TRUE(destroyed);
+}
+
+TEST(SharedSliceTest, SubSlicesKeepParentAlive) {
+  bool destroyed;
+  SharedSlice s(buildBuffer("{\"a\":[1,{\"b\":\"foo\"}],\"c\":2}", destroyed));
+
+  SharedSlice a = s.get("a");
+  SharedSlice b = a.at(1).get(std::string("b"));
+  SharedSlice c = s["c"];
+  SharedSlice key = s.keyAt(0);
+  SharedSlice value = s.valueAt(1);
+  ASSERT_EQ(6L, s.useCount());
+
+  // sub values point into the parent's memory
+  ASSERT_TRUE(a.start() > s.start());
+  ASSERT_TRUE(a.start() < s.start() + s.byteSize());
+
+  s = SharedSlice();
+  a = SharedSlice();
+  ASSERT_FALSE(destroyed);
+  ASSERT_EQ("\"foo\"", b.slice().toJson());
+  ASSERT_EQ(2, c.slice().getInt());
+  ASSERT_EQ("a", key.slice().copyString());
+  ASSERT_EQ(2, value.slice().getInt());
+
+  b = c = key = value = SharedSlice();
+  ASSERT_TRUE(destroyed);
+}
+
+TEST(SharedSliceTest, Share) {
+  bool destroyed;
+  SharedSlice s(buildBuffer("[[1,2],[3,4]]", destroyed));
+
+  std::vector<SharedSlice> members;
+  for (auto const& it : ArrayIterator(s.slice())) {
+    members.emplace_back(s.share(it));
+  }
+  s = SharedSlice();
+  ASSERT_FALSE(destroyed);
+  ASSERT_EQ("[1,2]", members[0].slice().toJson());
+  ASSERT_EQ("[3,4]", members[1].slice().toJson());
+
+  members.clear();
+  ASSERT_TRUE(destroyed);
+}
+
+TEST(SharedSliceTest, NotFound) {
+  SharedSlice s(Parser::fromJson("{\"a\":1}"));
+  ASSERT_TRUE(s.get("b").slice().isNone());
+}
+
+TEST(SharedSliceTest, Copy) {
+  std::shared_ptr<Builder> b = Parser::fromJson("{\"a\":[1,2]}");
+  SharedSlice s = SharedSlice::copy(b->slice());
+  ASSERT_NE(b->slice().start(), s.start());
+  b.reset();
+
+  ASSERT_EQ("{\"a\":[1,2]}", s.slice().toJson());
+  ASSERT_EQ(1L, s.useCount());
+}
+
+TEST(SharedSliceTest, Owner) {
+  std::string data;
+  {
+    StringSink sink(&data);
+    DocumentFileWriter writer(&sink);
+    writer.add(Parser::fromJson("{\"a\":1}")->slice());
+    writer.add(Parser::fromJson("[\"b\"]")->slice());
+    writer.finish();
+  }
+
+  std::shared_ptr<DocumentFile> file(new DocumentFile(
+      reinterpret_cast<uint8_t const*>(data.data()), data.size()));
+  SharedSlice document(file, file->at(1));
+  file.reset();
+
+  ASSERT_EQ(1L, document.useCount());
+  ASSERT_EQ("[\"b\"]", document.slice().toJson());
+}
+
+TEST(SharedSliceTest, Threads) {
+  bool destroyed;
+  SharedSlice s(buildBuffer("[\"abc\",1,2,3,4,5,6,7,8,9]", destroyed));
+
+  std::atomic<uint64_t> sum(0);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 4; ++i) {
+    threads.emplace_back([s, &sum]() {
+      for (size_t j = 0; j < 10000; ++j) {
+        SharedSlice member = s.at(1 + j % 9);
+        SharedSlice copy = member;
+        sum += copy.slice().getUInt();
+      }
+    });
+  }
+  s = SharedSlice();
+  for (auto& it : threads) {
+    it.join();
+  }
+  ASSERT_TRUE(destroyed);
+
+  uint64_t expected = 0;
+  for (size_t j = 0; j < 10000; ++j) {
+    expected += 1 + j % 9;
+  }
+  ASSERT_EQ(4 * expected, sum.load());
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
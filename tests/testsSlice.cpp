@@ -24,8 +24,11 @@
 /// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
 #include <ostream>
 #include <string>
+#include <thread>
+#include <vector>
 #include <iostream>
 
 #include "tests-common.h"
@@ -1961,7 +1964,7 @@ TEST(SliceTest, HashNull) {
   Slice s = b->slice();
 
   ASSERT_EQ(1903446559881298698ULL, s.hash());
-  ASSERT_EQ(1903446559881298698ULL, s.normalizedHash());
+  ASSERT_EQ(3292743054098051222ULL, s.normalizedHash());
 }
 
 TEST(SliceTest, HashDouble) {
@@ -1969,7 +1972,7 @@ TEST(SliceTest, HashDouble) {
   Slice s = b->slice();
 
   ASSERT_EQ(4457948945193834531ULL, s.hash());
-  ASSERT_EQ(9737553273926297610ULL, s.normalizedHash());
+  ASSERT_EQ(10988672986746915589ULL, s.normalizedHash());
 }
 
 TEST(SliceTest, HashString) {
@@ -1977,7 +1980,7 @@ TEST(SliceTest, HashString) {
   Slice s = b->slice();
 
   ASSERT_EQ(9531555437566788706ULL, s.hash());
-  ASSERT_EQ(9531555437566788706ULL, s.normalizedHash());
+  ASSERT_EQ(16452348778948623970ULL, s.normalizedHash());
 }
 
 TEST(SliceTest, HashStringEmpty) {
@@ -1985,7 +1988,7 @@ TEST(SliceTest, HashStringEmpty) {
   Slice s = b->slice();
 
   ASSERT_EQ(1450600894602296270ULL, s.hash());
-  ASSERT_EQ(1450600894602296270ULL, s.normalizedHash());
+  ASSERT_EQ(8800694971131605273ULL, s.normalizedHash());
 }
 
 TEST(SliceTest, HashStringShort) {
@@ -1993,7 +1996,7 @@ TEST(SliceTest, HashStringShort) {
   Slice s = b->slice();
 
   ASSERT_EQ(14855108345558666872ULL, s.hash());
-  ASSERT_EQ(14855108345558666872ULL, s.normalizedHash());
+  ASSERT_EQ(11326895524475946096ULL, s.normalizedHash());
 }
 
 TEST(SliceTest, HashArray) {
@@ -2043,8 +2046,8 @@ TEST(SliceTest, NormalizedHashDouble) {
   ASSERT_EQ(7102974787002861403ULL, b1.slice().hash());
   ASSERT_EQ(14248638626330948552ULL, b2.slice().hash());
 
-  ASSERT_EQ(13690116699997059692ULL, b1.slice().normalizedHash());
-  ASSERT_EQ(13690116699997059692ULL, b2.slice().normalizedHash());
+  ASSERT_EQ(15098359271284712264ULL, b1.slice().normalizedHash());
+  ASSERT_EQ(15098359271284712264ULL, b2.slice().normalizedHash());
 }
 
 TEST(SliceTest, NormalizedHashArray) {
@@ -2062,8 +2065,8 @@ TEST(SliceTest, NormalizedHashArray) {
   ASSERT_EQ(8308483934453544580ULL, s1.hash());
   ASSERT_EQ(15333913616940129336ULL, s2.hash());
 
-  ASSERT_EQ(1025874842406722974ULL, s1.normalizedHash());
-  ASSERT_EQ(1025874842406722974ULL, s2.normalizedHash());
+  ASSERT_EQ(11819288598028680917ULL, s1.normalizedHash());
+  ASSERT_EQ(11819288598028680917ULL, s2.normalizedHash());
 }
 
 TEST(SliceTest, NormalizedHashArrayNested) {
@@ -2081,8 +2084,8 @@ TEST(SliceTest, NormalizedHashArrayNested) {
   ASSERT_EQ(15793061464938738924ULL, s1.hash());
   ASSERT_EQ(2722569323545975071ULL, s2.hash());
 
-  ASSERT_EQ(11101500731480543049ULL, s1.normalizedHash());
-  ASSERT_EQ(11101500731480543049ULL, s2.normalizedHash());
+  ASSERT_EQ(3208406517197619694ULL, s1.normalizedHash());
+  ASSERT_EQ(3208406517197619694ULL, s2.normalizedHash());
 }
 
 TEST(SliceTest, NormalizedHashObjectOrder) {
@@ -2103,8 +2106,8 @@ TEST(SliceTest, NormalizedHashObjectOrder) {
   ASSERT_EQ(8873752126133306149ULL, s1.hash());
   ASSERT_EQ(9972002797221051811ULL, s2.hash());
 
-  ASSERT_EQ(724735390467908482ULL, s1.normalizedHash());
-  ASSERT_EQ(724735390467908482ULL, s2.normalizedHash());
+  ASSERT_EQ(14090484025074713959ULL, s1.normalizedHash());
+  ASSERT_EQ(14090484025074713959ULL, s2.normalizedHash());
 }
 
 #endif
@@ -2116,7 +2119,7 @@ TEST(SliceTest, HashNull) {
   Slice s = b->slice();
 
   ASSERT_EQ(15292542490648858194ULL, s.hash());
-  ASSERT_EQ(15292542490648858194ULL, s.normalizedHash());
+  ASSERT_EQ(3292743054098051222ULL, s.normalizedHash());
 }
 
 TEST(SliceTest, HashDouble) {
@@ -2124,7 +2127,7 @@ TEST(SliceTest, HashDouble) {
   Slice s = b->slice();
 
   ASSERT_EQ(8711156443018077288ULL, s.hash());
-  ASSERT_EQ(15147306223577264442ULL, s.normalizedHash());
+  ASSERT_EQ(10988672986746915589ULL, s.normalizedHash());
 }
 
 TEST(SliceTest, HashString) {
@@ -2132,7 +2135,7 @@ TEST(SliceTest, HashString) {
   Slice s = b->slice();
 
   ASSERT_EQ(16298643255475496611ULL, s.hash());
-  ASSERT_EQ(16298643255475496611ULL, s.normalizedHash());
+  ASSERT_EQ(16452348778948623970ULL, s.normalizedHash());
 }
 
 TEST(SliceTest, HashStringEmpty) {
@@ -2140,7 +2143,7 @@ TEST(SliceTest, HashStringEmpty) {
   Slice s = b->slice();
 
   ASSERT_EQ(5324680019219065241ULL, s.hash());
-  ASSERT_EQ(5324680019219065241ULL, s.normalizedHash());
+  ASSERT_EQ(8800694971131605273ULL, s.normalizedHash());
 }
 
 TEST(SliceTest, HashStringShort) {
@@ -2148,7 +2151,7 @@ TEST(SliceTest, HashStringShort) {
   Slice s = b->slice();
 
   ASSERT_EQ(13345050106135537218ULL, s.hash());
-  ASSERT_EQ(13345050106135537218ULL, s.normalizedHash());
+  ASSERT_EQ(11326895524475946096ULL, s.normalizedHash());
 }
 
 TEST(SliceTest, HashArray) {
@@ -2198,8 +2201,8 @@ TEST(SliceTest, NormalizedHashDouble) {
   ASSERT_EQ(200376126201688693ULL, b1.slice().hash());
   ASSERT_EQ(3369550273364380220ULL, b2.slice().hash());
 
-  ASSERT_EQ(65589186907022834ULL, b1.slice().normalizedHash());
-  ASSERT_EQ(65589186907022834ULL, b2.slice().normalizedHash());
+  ASSERT_EQ(15098359271284712264ULL, b1.slice().normalizedHash());
+  ASSERT_EQ(15098359271284712264ULL, b2.slice().normalizedHash());
 }
 
 TEST(SliceTest, NormalizedHashArray) {
@@ -2217,8 +2220,8 @@ TEST(SliceTest, NormalizedHashArray) {
   ASSERT_EQ(1515761289406454211ULL, s1.hash());
   ASSERT_EQ(6179595527158943660ULL, s2.hash());
 
-  ASSERT_EQ(13469007395921057835ULL, s1.normalizedHash());
-  ASSERT_EQ(13469007395921057835ULL, s2.normalizedHash());
+  ASSERT_EQ(11819288598028680917ULL, s1.normalizedHash());
+  ASSERT_EQ(11819288598028680917ULL, s2.normalizedHash());
 }
 
 TEST(SliceTest, NormalizedHashArrayNested) {
@@ -2236,8 +2239,8 @@ TEST(SliceTest, NormalizedHashArrayNested) {
   ASSERT_EQ(437707331568343016ULL, s1.hash());
   ASSERT_EQ(12530379609568313352ULL, s2.hash());
 
-  ASSERT_EQ(16364328471445495391ULL, s1.normalizedHash());
-  ASSERT_EQ(16364328471445495391ULL, s2.normalizedHash());
+  ASSERT_EQ(3208406517197619694ULL, s1.normalizedHash());
+  ASSERT_EQ(3208406517197619694ULL, s2.normalizedHash());
 }
 
 TEST(SliceTest, NormalizedHashObject) {
@@ -2265,8 +2268,8 @@ TEST(SliceTest, NormalizedHashObject) {
 
   ASSERT_EQ(4048487509578424242ULL, s2.hash());
 
-  ASSERT_EQ(18068466095586825298ULL, s1.normalizedHash());
-  ASSERT_EQ(18068466095586825298ULL, s2.normalizedHash());
+  ASSERT_EQ(14090484025074713959ULL, s1.normalizedHash());
+  ASSERT_EQ(14090484025074713959ULL, s2.normalizedHash());
 }
 
 TEST(SliceTest, NormalizedHashObjectOrder) {
@@ -2287,12 +2290,134 @@ TEST(SliceTest, NormalizedHashObjectOrder) {
   ASSERT_EQ(6865527808070733846ULL, s1.hash());
   ASSERT_EQ(11084437118009261125ULL, s2.hash());
 
-  ASSERT_EQ(18068466095586825298ULL, s1.normalizedHash());
-  ASSERT_EQ(18068466095586825298ULL, s2.normalizedHash());
+  ASSERT_EQ(14090484025074713959ULL, s1.normalizedHash());
+  ASSERT_EQ(14090484025074713959ULL, s2.normalizedHash());
 }
 
 #endif
 
+TEST(SliceTest, NormalizedHashIndependentOfHashType) {
+  // normalized hash values must be stable across builds, regardless
+  // of the hash function selected for hash()
+  ASSERT_EQ(3292743054098051222ULL,
+            Parser::fromJson("null")->slice().normalizedHash());
+  ASSERT_EQ(8800694971131605273ULL,
+            Parser::fromJson("\"\"")->slice().normalizedHash());
+  ASSERT_EQ(11819288598028680917ULL,
+            Parser::fromJson("[1,2,3,4,5,6,7,8,9,10]")->slice().normalizedHash());
+}
+
+TEST(SliceTest, NormalizedHashNumbers) {
+  Builder b;
+  b.openArray();
+  b.add(Value(3));
+  b.add(Value(static_cast<uint64_t>(3)));
+  b.add(Value(static_cast<int64_t>(3)));
+  b.add(Value(3.0));
+  b.add(Value(static_cast<int64_t>(-5)));
+  b.add(Value(-5.0));
+  b.add(Value(static_cast<uint64_t>(1000000)));
+  b.add(Value(1000000.0));
+  b.add(Value(0.0));
+  b.add(Value(-0.0));
+  b.add(Value(static_cast<int64_t>(0)));
+  b.close();
+
+  Slice s = b.slice();
+  ASSERT_EQ(0x33, s.at(0).head());
+  ASSERT_EQ(s.at(0).normalizedHash(), s.at(1).normalizedHash());
+  ASSERT_EQ(s.at(0).normalizedHash(), s.at(2).normalizedHash());
+  ASSERT_EQ(s.at(0).normalizedHash(), s.at(3).normalizedHash());
+  ASSERT_EQ(s.at(4).normalizedHash(), s.at(5).normalizedHash());
+  ASSERT_EQ(s.at(6).normalizedHash(), s.at(7).normalizedHash());
+  ASSERT_EQ(s.at(8).normalizedHash(), s.at(9).normalizedHash());
+  ASSERT_EQ(s.at(8).normalizedHash(), s.at(10).normalizedHash());
+  ASSERT_NE(s.at(0).normalizedHash(), s.at(4).normalizedHash());
+  ASSERT_NE(s.at(0).normalizedHash(), s.at(8).normalizedHash());
+}
+
+TEST(SliceTest, NormalizedHashDistinguishesTypes) {
+  std::shared_ptr<Builder> b = Parser::fromJson(
+      "[null,false,true,0,\"\",\"0\",[],{},[[]],[{}],[null],{\"a\":null}]");
+  Slice s = b->slice();
+
+  std::vector<uint64_t> hashes;
+  for (auto const& it : ArrayIterator(s)) {
+    hashes.emplace_back(it.normalizedHash());
+  }
+  std::sort(hashes.begin(), hashes.end());
+  ASSERT_EQ(hashes.end(), std::unique(hashes.begin(), hashes.end()));
+}
+
+TEST(SliceTest, NormalizedHashObjectLayouts) {
+  std::string const json("{\"one\":1,\"two\":[2,\"two\"],\"three\":{\"x\":3.5}}");
+  std::shared_ptr<Builder> b1 = Parser::fromJson(json);
+
+  Options options;
+  options.buildUnindexedObjects = true;
+  std::shared_ptr<Builder> b2 = Parser::fromJson(json, &options);
+
+  options.buildUnindexedObjects = false;
+  options.buildHashedObjects = true;
+  options.hashedObjectMinLength = 1;
+  std::shared_ptr<Builder> b3 = Parser::fromJson(json, &options);
+  ASSERT_EQ(0x15, b3->slice().head());
+
+  std::shared_ptr<Builder> b4 = Parser::fromJson(
+      "{\"three\":{\"x\":3.5},\"two\":[2,\"two\"],\"one\":1}");
+
+  uint64_t h = b1->slice().normalizedHash();
+  ASSERT_EQ(h, b2->slice().normalizedHash());
+  ASSERT_EQ(h, b3->slice().normalizedHash());
+  ASSERT_EQ(h, b4->slice().normalizedHash());
+
+  // keys and values must not be interchangeable
+  std::shared_ptr<Builder> b5 = Parser::fromJson(
+      "{\"one\":1,\"two\":[2,\"two\"],\"three\":{\"x\":3.5},\"four\":4}");
+  ASSERT_NE(h, b5->slice().normalizedHash());
+  ASSERT_NE(Parser::fromJson("{\"a\":\"b\"}")->slice().normalizedHash(),
+            Parser::fromJson("{\"b\":\"a\"}")->slice().normalizedHash());
+  ASSERT_NE(Parser::fromJson("{\"a\":1,\"b\":2}")->slice().normalizedHash(),
+            Parser::fromJson("{\"a\":2,\"b\":1}")->slice().normalizedHash());
+}
+
+TEST(SliceTest, NormalizedHashTranslatedKeys) {
+  std::unique_ptr<AttributeTranslator> translator(new AttributeTranslator);
+  translator->add("foo", 1);
+  translator->add("bar", 2);
+  translator->seal();
+
+  AttributeTranslatorScope scope(translator.get());
+
+  Options options;
+  options.attributeTranslator = translator.get();
+  std::shared_ptr<Builder> b1 = Parser::fromJson(
+      "{\"foo\":1,\"bar\":true,\"baz\":null}", &options);
+  ASSERT_TRUE(b1->slice().keyAt(0, false).isSmallInt());
+
+  std::shared_ptr<Builder> b2 = Parser::fromJson(
+      "{\"baz\":null,\"bar\":true,\"foo\":1}");
+
+  ASSERT_EQ(b2->slice().normalizedHash(), b1->slice().normalizedHash());
+}
+
+TEST(SliceTest, NormalizedHash128) {
+  std::shared_ptr<Builder> b = Parser::fromJson(
+      "[null,1,2.5,\"foo\",[1,2,3],{\"a\":[1,2.5,\"x\"],\"b\":null}]");
+
+  for (auto const& it : ArrayIterator(b->slice())) {
+    auto h = it.normalizedHash128();
+    ASSERT_EQ(it.normalizedHash(), h.second);
+    ASSERT_NE(h.first, h.second);
+    ASSERT_EQ(h, it.normalizedHash128());
+    ASSERT_NE(h, it.normalizedHash128(42));
+  }
+
+  auto h = b->slice().at(5).normalizedHash128();
+  ASSERT_EQ(9081207222193497493ULL, h.first);
+  ASSERT_EQ(12775573733070467330ULL, h.second);
+}
+
 TEST(SliceTest, GetNumericValueIntNoLoss) {
   Builder b;
   b.add(Value(ValueType::Array));
@@ -2507,6 +2632,113 @@ TEST(SliceTest, TranslateSingleMember) {
   ASSERT_VELOCYPACK_EXCEPTION(Slice(s.start() + s.getNthOffset(0)).translate().copyString(), Exception::NeedAttributeTranslator); 
 }
 
+TEST(SliceTest, TranslatorLookups) {
+  std::unique_ptr<AttributeTranslator> translator(new AttributeTranslator);
+
+  ASSERT_EQ(nullptr, translator->translate("foo"));
+  ASSERT_EQ(nullptr, translator->translate(1));
+
+  for (uint64_t i = 0; i < 1000; ++i) {
+    translator->add("key" + std::to_string(i), i);
+  }
+  // ids outside of the dense range
+  translator->add("large", 123456789ULL);
+  translator->add("huge", UINT64_MAX);
+  translator->seal();
+
+  ASSERT_EQ(1002UL, translator->count());
+  for (uint64_t i = 0; i < 1000; ++i) {
+    std::string const key("key" + std::to_string(i));
+    uint8_t const* id = translator->translate(key);
+    ASSERT_NE(nullptr, id);
+    ASSERT_EQ(i, Slice(id).getUInt());
+    ASSERT_EQ(id, translator->translate(key.data(), key.size()));
+
+    uint8_t const* name = translator->translate(i);
+    ASSERT_NE(nullptr, name);
+    ASSERT_EQ(key, Slice(name).copyString());
+  }
+
+  ASSERT_EQ(123456789ULL, Slice(translator->translate("large")).getUInt());
+  ASSERT_EQ(UINT64_MAX, Slice(translator->translate("huge")).getUInt());
+  ASSERT_EQ("large", Slice(translator->translate(123456789ULL)).copyString());
+  ASSERT_EQ("huge", Slice(translator->translate(UINT64_MAX)).copyString());
+
+  ASSERT_EQ(nullptr, translator->translate("key1000"));
+  ASSERT_EQ(nullptr, translator->translate(""));
+  ASSERT_EQ(nullptr, translator->translate("ke", 2));
+  ASSERT_EQ(nullptr, translator->translate(1000));
+  ASSERT_EQ(nullptr, translator->translate(123456788ULL));
+}
+
+TEST(SliceTest, TranslatorThreadScope) {
+  // two dictionaries that use the same ids for different attribute names
+  std::unique_ptr<AttributeTranslator> translator1(new AttributeTranslator);
+  translator1->add("foo", 1);
+  translator1->add("bar", 2);
+  translator1->seal();
+
+  std::unique_ptr<AttributeTranslator> translator2(new AttributeTranslator);
+  translator2->add("baz", 1);
+  translator2->add("qux", 2);
+  translator2->seal();
+
+  Options options1;
+  options1.attributeTranslator = translator1.get();
+  Builder b1(&options1);
+  Parser parser1(b1, &options1);
+  parser1.parse("{\"foo\":1,\"bar\":2}");
+
+  Options options2;
+  options2.attributeTranslator = translator2.get();
+  Builder b2(&options2);
+  Parser parser2(b2, &options2);
+  parser2.parse("{\"baz\":3,\"qux\":4}");
+
+  ASSERT_EQ(nullptr, AttributeTranslator::current());
+  ASSERT_VELOCYPACK_EXCEPTION(b1.slice().get("foo"), Exception::NeedAttributeTranslator);
+
+  auto decode = [](AttributeTranslator* translator, Slice s,
+                   std::string const& expected, bool* ok) {
+    AttributeTranslatorThreadScope scope(translator);
+    *ok = true;
+    for (int i = 0; i < 1000; ++i) {
+      if (AttributeTranslator::current() != translator ||
+          s.toJson() != expected) {
+        *ok = false;
+      }
+    }
+  };
+
+  bool ok1 = false;
+  bool ok2 = false;
+  std::thread t1(decode, translator1.get(), b1.slice(), "{\"bar\":2,\"foo\":1}", &ok1);
+  std::thread t2(decode, translator2.get(), b2.slice(), "{\"baz\":3,\"qux\":4}", &ok2);
+  t1.join();
+  t2.join();
+  ASSERT_TRUE(ok1);
+  ASSERT_TRUE(ok2);
+
+  {
+    AttributeTranslatorThreadScope scope(translator2.get());
+    ASSERT_EQ(4UL, b2.slice().get("qux").getUInt());
+    ASSERT_TRUE(b2.slice().get("bar").isNone());
+    ASSERT_EQ("baz", b2.slice().keyAt(0).copyString());
+
+    {
+      // thread scopes nest, and take precedence over Options::Defaults
+      AttributeTranslatorScope globalScope(translator2.get());
+      AttributeTranslatorThreadScope inner(translator1.get());
+      ASSERT_EQ(translator1.get(), AttributeTranslator::current());
+      ASSERT_EQ(1UL, b1.slice().get("foo").getUInt());
+    }
+    ASSERT_EQ(translator2.get(), AttributeTranslator::current());
+  }
+
+  ASSERT_EQ(nullptr, AttributeTranslator::current());
+  ASSERT_EQ(nullptr, Options::Defaults.attributeTranslator);
+}
+
 TEST(SliceTest, Translations) {
   std::unique_ptr<AttributeTranslator> translator(new AttributeTranslator);
 
@@ -2779,6 +3011,59 @@ TEST(SliceTest, SliceScope) {
       b.copyString());
 }
 
+TEST(SliceTest, ByteSizeAllTypes) {
+  // head byte followed by a length field with value 0x0302 (0x02 for
+  // 1-byte lengths) and non-zero garbage behind it, so that reading more
+  // bytes than the width of the length field is detected
+  uint8_t buffer[32];
+  for (size_t i = 0; i < 256; ++i) {
+    uint8_t const h = static_cast<uint8_t>(i);
+    ValueLength width = 0;
+    ValueLength extra = 0;
+    if ((h >= 0x02 && h <= 0x09) || (h >= 0x0b && h <= 0x12)) {
+      width = SliceStaticData::WidthMap[h];
+    } else if (h == 0x15) {
+      width = 4;
+    } else if (h == 0xbf) {
+      width = 8;
+      extra = 9;
+    } else if (h >= 0xc0 && h <= 0xc7) {
+      width = h - 0xbf;
+      extra = 1 + width;
+    } else if (h >= 0xc8 && h <= 0xcf) {
+      width = h - 0xc7;
+      extra = 1 + width;
+    } else if (h >= 0xd0 && h <= 0xd7) {
+      width = h - 0xcf;
+      extra = 1 + width;
+    } else if (h >= 0xf4) {
+      width = 1ULL << ((h - 0xf4) / 3);
+      extra = 1 + width;
+    }
+
+    memset(buffer, 0xa5, sizeof(buffer));
+    buffer[0] = h;
+    buffer[1] = 0x02;
+    if (width != 1) {
+      buffer[2] = 0x03;
+    }
+    for (ValueLength j = 3; j <= width; ++j) {
+      buffer[j] = 0x00;
+    }
+    Slice s(buffer);
+
+    if (width > 0) {
+      ASSERT_EQ(extra + (width == 1 ? 0x02ULL : 0x0302ULL), s.byteSize());
+    } else if (SliceStaticData::FixedTypeLengths[h] != 0) {
+      ASSERT_EQ(SliceStaticData::FixedTypeLengths[h], s.byteSize());
+    } else if (h == 0x13 || h == 0x14) {
+      ASSERT_EQ(0x02ULL, s.byteSize());
+    } else {
+      ASSERT_VELOCYPACK_EXCEPTION(s.byteSize(), Exception::InternalError);
+    }
+  }
+}
+
 TEST(SliceTest, CustomTypeByteSize) {
   uint8_t example0[] = { 0xf0, 0x00 };
   {
@@ -34,10 +34,11 @@ TEST(ValidatorTest, NoOptions) {
 }
 
 TEST(ValidatorTest, ReservedValue1) {
+  // 0x15 is an Object with hash table, which cannot be a single byte
   std::string const value("\x15", 1);
 
   Validator validator;
-  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidType);
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidLength);
 }
 
 TEST(ValidatorTest, ReservedValue2) {
@@ -1026,7 +1027,7 @@ TEST(ValidatorTest, ArrayOneByteIndexedIndexOutOfBounds3) {
 }
 
 TEST(ValidatorTest, ArrayOneByteIndexedMultipleMembers) {
-  std::string const value("\x06\x09\x02\x18\x18\x18\x03\x04\x05", 9);
+  std::string const value("\x06\x09\x03\x18\x18\x18\x03\x04\x05", 9);
 
   Validator validator;
   ASSERT_TRUE(validator.validate(value.c_str(), value.size()));
@@ -1193,6 +1194,484 @@ TEST(ValidatorTest, EmptyObjectWithExtra) {
   ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidLength);
 }
 
+TEST(ValidatorTest, ObjectHashed) {
+  Options options;
+  options.buildHashedObjects = true;
+  options.hashedObjectMinLength = 2;
+
+  Builder b(&options);
+  b.openObject();
+  b.add("a", Value(1));
+  b.add("b", Value(2));
+  b.close();
+
+  ASSERT_EQ(0x15, b.slice().head());
+  ASSERT_EQ(57UL, b.size());
+
+  Validator validator;
+  ASSERT_TRUE(validator.validate(b.start(), b.size()));
+}
+
+TEST(ValidatorTest, ObjectHashedInvalid) {
+  Options options;
+  options.buildHashedObjects = true;
+  options.hashedObjectMinLength = 2;
+
+  Builder b(&options);
+  b.openObject();
+  b.add("a", Value(1));
+  b.add("b", Value(2));
+  b.close();
+
+  std::string const original(reinterpret_cast<char const*>(b.start()), b.size());
+  Validator validator;
+
+  // too short
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(original.c_str(), 10), Exception::ValidatorInvalidLength);
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(original.c_str(), original.size() - 1), Exception::ValidatorInvalidLength);
+
+  // unknown hash function
+  std::string value = original;
+  value[9] = '\x03';
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidType);
+
+  // hash table does not fit
+  value = original;
+  value[10] = '\x05';
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidLength);
+
+  // hash table too small for the number of members
+  value = original;
+  value[10] = '\x01';
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidLength);
+
+  // hash table entry pointing into the hash table
+  value = original;
+  for (size_t i = 0; i < 4; ++i) {
+    if (value[11 + i * 8 + 4] != '\x00') {
+      value[11 + i * 8 + 4] = '\x0b';
+      break;
+    }
+  }
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidLength);
+
+  // index table entry out of bounds
+  value = original;
+  value[value.size() - 4] = '\x01';
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidLength);
+}
+
+// copies the member offset of the first used hash table slot into the
+// second one, so that two slots point to the same member
+static void DuplicateHashTableEntry(std::string& value) {
+  size_t const slots = size_t(1) << static_cast<uint8_t>(value[10]);
+  size_t used[2];
+  size_t n = 0;
+  for (size_t i = 0; i < slots && n < 2; ++i) {
+    if (readIntegerFixed<ValueLength, 4>(reinterpret_cast<uint8_t const*>(value.data()) + 11 + i * 8 + 4) != 0) {
+      used[n++] = i;
+    }
+  }
+  ASSERT_EQ(2UL, n);
+  value.replace(11 + used[1] * 8 + 4, 4, value, 11 + used[0] * 8 + 4, 4);
+}
+
+TEST(ValidatorTest, ObjectHashedDuplicateEntry) {
+  Options options;
+  options.buildHashedObjects = true;
+  options.hashedObjectMinLength = 2;
+
+  Builder b(&options);
+  b.openObject();
+  b.add("a", Value(1));
+  b.add("b", Value(2));
+  b.add("c", Value(3));
+  b.close();
+  ASSERT_EQ(0x15, b.slice().head());
+
+  Validator validator;
+  ASSERT_TRUE(validator.validate(b.start(), b.size()));
+
+  // the number of used slots still matches, but one member cannot be found
+  std::string value(reinterpret_cast<char const*>(b.start()), b.size());
+  DuplicateHashTableEntry(value);
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidLength);
+}
+
+TEST(ValidatorTest, ArrayOneByteIndexedEntriesNotInOrder) {
+  // index table entries must be the member offsets in storage order
+  std::string value("\x06\x09\x02\x18\x18\x18\x03\x04\x05", 9);
+
+  Validator validator;
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidLength);
+
+  value = std::string("\x06\x09\x03\x18\x18\x18\x03\x05\x04", 9);
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidLength);
+}
+
+TEST(ValidatorTest, ArrayOneByteIndexedPadding) {
+  std::string value("\x06\x09\x02\x00\x00\x18\x18\x05\x06", 9);
+
+  Validator validator;
+  ASSERT_TRUE(validator.validate(value.c_str(), value.size()));
+
+  // padding must consist of zero bytes only
+  value[4] = '\x01';
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidLength);
+}
+
+TEST(ValidatorTest, ArrayEqualSizeMembersDoNotFill) {
+  std::string const value("\x02\x06\x21\x01\x00\x18", 6);
+
+  Validator validator;
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidLength);
+}
+
+TEST(ValidatorTest, ArrayCompactMembersDoNotFill) {
+  std::string const value("\x13\x05\x18\x18\x01", 5);
+
+  Validator validator;
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidLength);
+}
+
+TEST(ValidatorTest, ArrayCompactLengthNotMinimal) {
+  std::string value("\x13\x85\x00\x18\x01", 5);
+
+  Validator validator;
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidLength);
+
+  value = std::string("\x13\x05\x18\x81\x00", 5);
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidLength);
+}
+
+TEST(ValidatorTest, ArrayCompactLengthTooLong) {
+  std::string const value("\x13\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\x01", 12);
+
+  Validator validator;
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidLength);
+}
+
+TEST(ValidatorTest, ObjectKeyTypes) {
+  Validator validator;
+
+  std::string value("\x14\x05\x31\x18\x01", 5);
+  ASSERT_TRUE(validator.validate(value.c_str(), value.size()));
+
+  value = std::string("\x14\x06\x28\xff\x18\x01", 6);
+  ASSERT_TRUE(validator.validate(value.c_str(), value.size()));
+
+  // negative SmallInt
+  value = std::string("\x14\x05\x3f\x18\x01", 5);
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidType);
+
+  // Int
+  value = std::string("\x14\x06\x20\x01\x18\x01", 6);
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidType);
+
+  // Null
+  value = std::string("\x14\x05\x18\x18\x01", 5);
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidType);
+}
+
+TEST(ValidatorTest, ObjectIndexTableEntries) {
+  Validator validator;
+
+  // entries in storage order
+  std::string value("\x0b\x0b\x02\x41\x61\x18\x41\x62\x18\x03\x06", 11);
+  ASSERT_TRUE(validator.validate(value.c_str(), value.size()));
+
+  // entries in a different order
+  value[9] = '\x06';
+  value[10] = '\x03';
+  ASSERT_TRUE(validator.validate(value.c_str(), value.size()));
+
+  // entry pointing into a member
+  value[9] = '\x04';
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidLength);
+
+  // the same member twice
+  value[9] = '\x03';
+  value[10] = '\x03';
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidLength);
+
+  // entry pointing into the index table
+  value[10] = '\x09';
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidLength);
+}
+
+TEST(ValidatorTest, ObjectMembersDoNotFill) {
+  // nrItems is 1, but there are two members in front of the index table
+  std::string const value("\x0b\x0a\x01\x41\x61\x18\x41\x62\x18\x03", 10);
+
+  Validator validator;
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidLength);
+}
+
+TEST(ValidatorTest, BuilderOutput) {
+  std::string const json("{\"z\":1,\"y\":[1,2,3,\"foo\",{\"c\":null,\"b\":false,\"a\":[]}],\"x\":{\"q\":\"r\",\"p\":[[],{},[1.5,\"bar\"]]},\"w\":\"\xc3\xa4\xc3\xb6\xc3\xbc\",\"v\":[{\"u\":1},{\"t\":2}]}");
+
+  for (int variant = 0; variant < 4; ++variant) {
+    Options options;
+    options.buildUnindexedArrays = (variant & 1) != 0;
+    options.buildUnindexedObjects = (variant & 2) != 0;
+    options.validateUtf8Strings = true;
+
+    Parser parser(&options);
+    parser.parse(json);
+    std::shared_ptr<Builder> b = parser.steal();
+
+    Validator validator(&options);
+    ASSERT_TRUE(validator.validate(b->start(), b->size()));
+    ASSERT_TRUE(validator.validateFraming(b->start(), b->size()));
+
+    // every proper prefix must be rejected
+    for (size_t i = 0; i < b->size(); ++i) {
+      ASSERT_VELOCYPACK_EXCEPTION(validator.validate(b->start(), i), Exception::ValidatorInvalidLength);
+    }
+  }
+}
+
+TEST(ValidatorTest, CorruptedBuilderOutput) {
+  // values that pass validation must be safe to read, whatever else
+  // happened to them
+  Options options;
+  options.disallowExternals = true;
+  options.unsupportedTypeBehavior = Options::NullifyUnsupportedType;
+
+  std::shared_ptr<Builder> b = Parser::fromJson("[{\"a\":[1,2,\"abc\"],\"b\":{\"c\":-17,\"d\":[]}},\"foobar\",[[1],[2]],{\"e\":1.5}]", &options);
+  std::string const original(reinterpret_cast<char const*>(b->start()), b->size());
+
+  Validator validator(&options);
+  for (size_t i = 0; i < original.size(); ++i) {
+    for (int bit = 0; bit < 8; ++bit) {
+      std::string value = original;
+      value[i] ^= static_cast<char>(1 << bit);
+      bool valid = false;
+      try {
+        valid = validator.validate(value.c_str(), value.size());
+      } catch (Exception const&) {
+      }
+      if (!valid) {
+        continue;
+      }
+      Slice s(reinterpret_cast<uint8_t const*>(value.data()));
+      try {
+        s.toJson(&options);
+        s.toString(&options);
+      } catch (Exception const&) {
+        // e.g. integer keys without an AttributeTranslator
+      }
+    }
+  }
+}
+
+TEST(ValidatorTest, MaxDepth) {
+  std::shared_ptr<Builder> b = Parser::fromJson("[1,[2,{\"a\":[3]}],[]]");
+
+  Options options;
+  Validator validator(&options);
+  ASSERT_TRUE(validator.validate(b->start(), b->size()));
+
+  options.validateMaxDepth = 4;
+  ASSERT_TRUE(validator.validate(b->start(), b->size()));
+
+  options.validateMaxDepth = 3;
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(b->start(), b->size()), Exception::ValidatorNestingTooDeep);
+
+  options.validateMaxDepth = 1;
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(b->start(), b->size()), Exception::ValidatorNestingTooDeep);
+
+  std::string const value("\x18", 1);
+  ASSERT_TRUE(validator.validate(value.c_str(), value.size()));
+}
+
+TEST(ValidatorTest, Utf8InKeys) {
+  Options options;
+  options.validateUtf8Strings = true;
+  Validator validator(&options);
+
+  std::string const value("\x14\x06\x41\xff\x18\x01", 6);
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::InvalidUtf8Sequence);
+
+  options.validateUtf8Strings = false;
+  ASSERT_TRUE(validator.validate(value.c_str(), value.size()));
+}
+
+TEST(ValidatorTest, LongStringUtf8) {
+  Options options;
+  options.validateUtf8Strings = true;
+  Validator validator(&options);
+
+  for (size_t pos = 0; pos < 40; ++pos) {
+    std::string text(40, 'a');
+    Builder b;
+    b.add(Value(text));
+    ASSERT_TRUE(validator.validate(b.start(), b.size()));
+
+    // invalid byte or truncated sequence after an ASCII run
+    text[pos] = '\xff';
+    b.clear();
+    b.add(Value(text));
+    ASSERT_VELOCYPACK_EXCEPTION(validator.validate(b.start(), b.size()), Exception::InvalidUtf8Sequence);
+
+    text = std::string(pos, 'a') + "\xc3";
+    b.clear();
+    b.add(Value(text));
+    ASSERT_VELOCYPACK_EXCEPTION(validator.validate(b.start(), b.size()), Exception::InvalidUtf8Sequence);
+
+    text = std::string(pos, 'a') + "\xe2\x82\xac" + std::string(pos, 'b');
+    b.clear();
+    b.add(Value(text));
+    ASSERT_TRUE(validator.validate(b.start(), b.size()));
+  }
+}
+
+TEST(ValidatorTest, Framing) {
+  std::shared_ptr<Builder> b = Parser::fromJson("{\"a\":[1,2,3],\"b\":\"foo\"}");
+  std::string value(reinterpret_cast<char const*>(b->start()), b->size());
+
+  Validator validator;
+  ASSERT_TRUE(validator.validateFraming(value.c_str(), value.size()));
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validateFraming(value.c_str(), value.size() - 1), Exception::ValidatorInvalidLength);
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validateFraming(value.c_str(), 1), Exception::ValidatorInvalidLength);
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validateFraming(value.c_str(), 0), Exception::ValidatorInvalidLength);
+
+  value.push_back('\x18');
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validateFraming(value.c_str(), value.size()), Exception::ValidatorInvalidLength);
+  ASSERT_TRUE(validator.validateFraming(value.c_str(), value.size(), true));
+  value.pop_back();
+
+  // members are not looked at
+  value[value.size() - 1] = '\x01';
+  ASSERT_TRUE(validator.validateFraming(value.c_str(), value.size()));
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidLength);
+
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validateFraming("\x16", 1), Exception::ValidatorInvalidType);
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validateFraming("\xd8", 1), Exception::ValidatorInvalidType);
+}
+
+static Builder buildLargeValue(bool object, Options const* options = &Options::Defaults) {
+  // about 2 MB of mixed values, large enough for validateParallel()
+  Builder b(options);
+  if (object) {
+    b.openObject();
+  } else {
+    b.openArray();
+  }
+  for (size_t i = 0; i < 50000; ++i) {
+    if (object) {
+      b.add(Value("key" + std::to_string(i)));
+    }
+    switch (i % 4) {
+      case 0:
+        b.add(Value(std::string(100, 'x')));
+        break;
+      case 1:
+        b.add(Value(static_cast<int64_t>(i) * -1000));
+        break;
+      case 2:
+        b.openObject();
+        b.add("a", Value(i));
+        b.add("b", Value("foo"));
+        b.close();
+        break;
+      default:
+        b.openArray();
+        b.add(Value(1.5));
+        b.add(Value(ValueType::Null));
+        b.close();
+        break;
+    }
+  }
+  b.close();
+  return b;
+}
+
+TEST(ValidatorTest, Parallel) {
+  Options hashedOptions;
+  hashedOptions.buildHashedObjects = true;
+
+  Validator validator;
+  for (auto const& b : { buildLargeValue(false), buildLargeValue(true),
+                         buildLargeValue(true, &hashedOptions) }) {
+    ASSERT_GT(b.size(), 1024UL * 1024UL);
+    for (size_t concurrency : { 0, 1, 2, 3, 8 }) {
+      ASSERT_TRUE(validator.validateParallel(b.start(), b.size(), false, concurrency));
+    }
+    ASSERT_VELOCYPACK_EXCEPTION(validator.validateParallel(b.start(), b.size() - 1, false, 4), Exception::ValidatorInvalidLength);
+  }
+  ASSERT_EQ(0x15, buildLargeValue(true, &hashedOptions).slice().head());
+
+  Builder b = buildLargeValue(true, &hashedOptions);
+  std::string value(reinterpret_cast<char const*>(b.start()), b.size());
+  DuplicateHashTableEntry(value);
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validateParallel(value.c_str(), value.size(), false, 4), Exception::ValidatorInvalidLength);
+}
+
+TEST(ValidatorTest, ParallelEqualSizeMembers) {
+  Builder b;
+  b.openArray();
+  for (size_t i = 0; i < 20000; ++i) {
+    b.add(Value(std::string(100, 'a' + (i % 26))));
+  }
+  b.close();
+  ASSERT_TRUE(b.slice().head() >= 0x02 && b.slice().head() <= 0x05);
+
+  Validator validator;
+  ASSERT_TRUE(validator.validateParallel(b.start(), b.size(), false, 4));
+
+  // a member with a different size in the middle
+  std::string value(reinterpret_cast<char const*>(b.start()), b.size());
+  size_t const pos = b.slice().at(10000).start() - b.start();
+  ASSERT_EQ(0xa4, static_cast<uint8_t>(value[pos]));
+  value[pos] = '\xa3';
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidLength);
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validateParallel(value.c_str(), value.size(), false, 4), Exception::ValidatorInvalidLength);
+}
+
+TEST(ValidatorTest, ParallelInvalid) {
+  // the same corruptions must be found with and without threads
+  Options options;
+  options.validateUtf8Strings = true;
+  options.validateMaxDepth = 2;
+  Validator validator(&options);
+
+  for (bool object : { false, true }) {
+    Builder b = buildLargeValue(object);
+    std::string const original(reinterpret_cast<char const*>(b.start()), b.size());
+    Slice s(b.start());
+    ASSERT_EQ(object ? 0x0d : 0x08, s.head());
+    Slice member = object ? s.valueAt(s.length() / 2) : s.at(s.length() / 2);
+    size_t const middle = member.start() - b.start();
+
+    // invalid UTF-8 in a string in the middle
+    std::string value = original;
+    size_t pos = value.find(std::string(100, 'x'), middle);
+    value[pos + 50] = '\xff';
+    ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::InvalidUtf8Sequence);
+    ASSERT_VELOCYPACK_EXCEPTION(validator.validateParallel(value.c_str(), value.size(), false, 4), Exception::InvalidUtf8Sequence);
+
+    // reserved type in the middle
+    value = original;
+    value[middle] = '\x16';
+    ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidType);
+    ASSERT_VELOCYPACK_EXCEPTION(validator.validateParallel(value.c_str(), value.size(), false, 4), Exception::ValidatorInvalidType);
+
+    // nesting too deep
+    options.validateMaxDepth = 1;
+    ASSERT_VELOCYPACK_EXCEPTION(validator.validate(original.c_str(), original.size()), Exception::ValidatorNestingTooDeep);
+    ASSERT_VELOCYPACK_EXCEPTION(validator.validateParallel(original.c_str(), original.size(), false, 4), Exception::ValidatorNestingTooDeep);
+    options.validateMaxDepth = 2;
+
+    // index table entry pointing into a member
+    value = original;
+    size_t const entry = value.size() - 4 * s.length() + (s.length() / 3) * 4;
+    value[entry] = static_cast<char>(value[entry] + 1);
+    ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidLength);
+    ASSERT_VELOCYPACK_EXCEPTION(validator.validateParallel(value.c_str(), value.size(), false, 4), Exception::ValidatorInvalidLength);
+  }
+}
+
 int main(int argc, char* argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
 
@@ -28,6 +28,7 @@
 #include <string>
 #include <unordered_map>
 #include <fstream>
+#include <memory>
 
 #include "velocypack/vpack.h"
 #include "velocypack/velocypack-exception-macros.h"
@@ -62,8 +63,19 @@ static void usage(char* argv[]) {
             << std::endl;
   std::cout << " --compress      compress Object keys" << std::endl;
   std::cout << " --no-compress   don't compress Object keys" << std::endl;
+  std::cout << " --dict-in FILE  compress Object keys using the key dictionary"
+            << std::endl;
+  std::cout << "                 from FILE instead of building one" << std::endl;
+  std::cout << " --dict-out FILE save the key dictionary into FILE (implies"
+            << std::endl;
+  std::cout << "                 --compress)" << std::endl;
   std::cout << " --hex           print a hex dump of the generated VPack value"
             << std::endl;
+  std::cout << " --documents     store each top-level JSON value of INFILE (e.g. one"
+            << std::endl;
+  std::cout << "                 per line) as a document of a document file, which"
+            << std::endl;
+  std::cout << "                 allows random access to the documents" << std::endl;
 }
 
 static inline bool isOption(char const* arg, char const* expected) {
@@ -71,21 +83,28 @@ static inline bool isOption(char const* arg, char const* expected) {
 }
 
 static bool buildCompressedKeys(
-    std::string const& s, std::unordered_map<std::string, size_t>& keysFound) {
+    std::string const& s, bool multi,
+    std::unordered_map<std::string, size_t>& keysFound) {
   Options options;
   Parser parser(&options);
   try {
-    parser.parse(s);
+    parser.parse(s, multi);
     std::shared_ptr<Builder> builder = parser.steal();
 
-    Collection::visitRecursive(
-        builder->slice(), Collection::PreOrder,
-        [&keysFound](Slice const& key, Slice const&) -> bool {
-          if (key.isString()) {
-            keysFound[key.copyString()]++;
-          }
-          return true;
-        });
+    uint8_t const* p = builder->start();
+    uint8_t const* end = p + builder->size();
+    while (p < end) {
+      Slice value(p);
+      Collection::visitRecursive(
+          value, Collection::PreOrder,
+          [&keysFound](Slice const& key, Slice const&) -> bool {
+            if (key.isString()) {
+              keysFound[key.copyString()]++;
+            }
+            return true;
+          });
+      p += value.byteSize();
+    }
 
     return true;
   } catch (...) {
@@ -103,6 +122,9 @@ int main(int argc, char* argv[]) {
   bool compact = true;
   bool compress = false;
   bool hexDump = false;
+  bool documents = false;
+  char const* dictInName = nullptr;
+  char const* dictOutName = nullptr;
 
   int i = 1;
   while (i < argc) {
@@ -118,8 +140,23 @@ int main(int argc, char* argv[]) {
       compress = true;
     } else if (allowFlags && isOption(p, "--no-compress")) {
       compress = false;
+    } else if (allowFlags && isOption(p, "--dict-in")) {
+      if (++i >= argc) {
+        usage(argv);
+        return EXIT_FAILURE;
+      }
+      dictInName = argv[i];
+    } else if (allowFlags && isOption(p, "--dict-out")) {
+      if (++i >= argc) {
+        usage(argv);
+        return EXIT_FAILURE;
+      }
+      dictOutName = argv[i];
+      compress = true;
     } else if (allowFlags && isOption(p, "--hex")) {
       hexDump = true;
+    } else if (allowFlags && isOption(p, "--documents")) {
+      documents = true;
     } else if (allowFlags && isOption(p, "--")) {
       allowFlags = false;
     } else if (infileName == nullptr) {
@@ -139,7 +176,7 @@ int main(int argc, char* argv[]) {
   }
 #endif
 
-  if (infileName == nullptr) {
+  if (infileName == nullptr || (hexDump && documents)) {
     usage(argv);
     return EXIT_FAILURE;
   }
@@ -188,11 +225,22 @@ int main(int argc, char* argv[]) {
   options.buildUnindexedArrays = compact;
   options.buildUnindexedObjects = compact;
 
-  // compress object keys?
-  if (compress) {
+  // compress object keys with an existing dictionary?
+  std::unique_ptr<KeyDictionary> dictionary;
+  if (dictInName != nullptr) {
+    try {
+      dictionary.reset(new KeyDictionary(dictInName));
+    } catch (Exception const& ex) {
+      std::cerr << "Cannot load key dictionary '" << dictInName
+                << "': " << ex.what() << std::endl;
+      return EXIT_FAILURE;
+    }
+    options.attributeTranslator = dictionary->translator();
+  } else if (compress) {
+    // build a dictionary from the input
     size_t compressedOccurrences = 0;
     std::unordered_map<std::string, size_t> keysFound;
-    buildCompressedKeys(s, keysFound);
+    buildCompressedKeys(s, documents, keysFound);
 
     std::vector<std::tuple<uint64_t, std::string, size_t>> stats;
     size_t requiredLength = 2;
@@ -233,8 +281,7 @@ int main(int argc, char* argv[]) {
 
   Parser parser(&options);
   try {
-    parser.parse(s);
-exit(0);
+    parser.parse(s, documents);
   } catch (Exception const& ex) {
     std::cerr << "An exception occurred while parsing infile '" << infile
               << "': " << ex.what() << std::endl;
@@ -260,7 +307,22 @@ exit(0);
 
   // write into stream
   std::shared_ptr<Builder> builder = parser.steal();
-  if (hexDump) {
+  ValueLength outSize = builder->size();
+  if (documents) {
+    // the parsed values are stored back to back in the Builder
+    OutputFileStreamSink sink(&ofs);
+    DocumentFileWriter writer(&sink);
+    uint8_t const* p = builder->start();
+    uint8_t const* end = p + builder->size();
+    while (p < end) {
+      Slice document(p);
+      writer.add(document);
+      p += document.byteSize();
+    }
+    writer.finish();
+    outSize += DocumentFile::HeaderSize + 8 * writer.size() +
+               DocumentFile::FooterSize;
+  } else if (hexDump) {
     ofs << HexDump(builder->slice()) << std::endl;
   } else {
     uint8_t const* start = builder->start();
@@ -269,13 +331,26 @@ exit(0);
 
   ofs.close();
 
+  if (dictOutName != nullptr) {
+    try {
+      KeyDictionary::save(*options.attributeTranslator, dictOutName);
+    } catch (Exception const& ex) {
+      std::cerr << "Cannot save key dictionary '" << dictOutName
+                << "': " << ex.what() << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
   if (!toStdOut) {
     std::cout << "Successfully converted JSON infile '" << infile << "'"
               << std::endl;
     std::cout << "JSON Infile size:    " << s.size() << std::endl;
-    std::cout << "VPack Outfile size:  " << builder->size() << std::endl;
+    std::cout << "VPack Outfile size:  " << outSize << std::endl;
 
-    if (compress) {
+    if (dictionary != nullptr) {
+      std::cout << "Key dictionary:      '" << dictInName << "' ("
+                << dictionary->translator()->count() << " keys)" << std::endl;
+    } else if (compress) {
       if (translator.get()->count() > 0) {
         std::cout << "Key dictionary size: "
                   << Slice(translator.get()->builder()->data())
@@ -0,0 +1,987 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <thread>
+
+#include "velocypack/vpack.h"
+#include "velocypack/Compare.h"
+#include "velocypack/velocypack-aliases.h"
+
+using namespace arangodb::velocypack;
+
+// micro benchmarks for individual VPack operations. each scenario
+// repeatedly executes a small piece of work until the runtime is used up
+// and reports the number of operations (and bytes, if applicable) per
+// second
+
+namespace {
+
+// prevents the compiler from optimizing away benchmark results
+volatile uint64_t sink = 0;
+
+struct Scenario {
+  char const* name;
+  char const* description;
+  std::function<void(double)> run;
+};
+
+// run func until runTime seconds have passed. func returns the number of
+// operations it has performed. bytesPerOp may be 0 if not applicable
+void measure(std::string const& label, double runTime, size_t bytesPerOp,
+             std::function<size_t()> const& func) {
+  using clock = std::chrono::high_resolution_clock;
+
+  // warm up
+  func();
+
+  size_t ops = 0;
+  auto start = clock::now();
+  double elapsed = 0.0;
+  do {
+    for (int i = 0; i < 16; ++i) {
+      ops += func();
+    }
+    elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(
+                  clock::now() - start).count();
+  } while (elapsed < runTime);
+
+  std::cout << std::left << std::setw(40) << label << std::right
+            << std::setw(14) << std::fixed << std::setprecision(0)
+            << (ops / elapsed) << " ops/s";
+  if (bytesPerOp > 0) {
+    std::cout << std::setw(12) << std::setprecision(1)
+              << (static_cast<double>(ops) * bytesPerOp / elapsed / 1000000.0)
+              << " MB/s";
+  }
+  std::cout << std::endl;
+}
+
+// builds an object with n attributes named "attributeXXX"
+Builder buildObject(size_t n, Options const* options = &Options::Defaults) {
+  Builder b(options);
+  b.add(Value(ValueType::Object));
+  for (size_t i = 0; i < n; ++i) {
+    b.add("attribute" + std::to_string(i), Value(i));
+  }
+  b.close();
+  return b;
+}
+
+void runObjectLookup(double runTime) {
+  for (size_t n : { 4, 8, 16, 32, 64, 256, 1024, 4096 }) {
+    Builder b = buildObject(n);
+    Slice s = b.slice();
+
+    // look up every key plus an equal number of non-existing keys
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < n; ++i) {
+      keys.emplace_back("attribute" + std::to_string(i));
+      keys.emplace_back("attribute" + std::to_string(i) + "x");
+    }
+
+    measure("object-lookup n=" + std::to_string(n) + " (" + s.hexType() + ")",
+            runTime, 0, [&]() -> size_t {
+      uint64_t found = 0;
+      for (auto const& key : keys) {
+        found += s.get(key).isNone() ? 0 : 1;
+      }
+      sink += found;
+      return keys.size();
+    });
+  }
+}
+
+void runWideObjectLookup(double runTime) {
+  Options hashed;
+  hashed.buildHashedObjects = true;
+  hashed.hashedObjectMinLength = 1;
+
+  for (size_t n : { 10000, 100000, 1000000 }) {
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < 10000; ++i) {
+      keys.emplace_back("attribute" + std::to_string((i * 7919) % n));
+    }
+
+    for (Options const* options : { &Options::Defaults, &hashed }) {
+      Builder b = buildObject(n, options);
+      Slice s = b.slice();
+
+      measure("wide-object-lookup n=" + std::to_string(n) + " (" +
+              s.hexType() + ")", runTime, 0, [&]() -> size_t {
+        uint64_t found = 0;
+        for (auto const& key : keys) {
+          found += s.get(key).getUInt();
+        }
+        sink += found;
+        return keys.size();
+      });
+    }
+  }
+}
+
+// builds an array with n members of mixed types
+Builder buildMixedArray(size_t n) {
+  Builder b;
+  b.openArray();
+  for (size_t i = 0; i < n; ++i) {
+    switch (i % 10) {
+      case 0:
+        b.add(Value(i % 10));
+        break;
+      case 1:
+        b.add(Value(static_cast<int64_t>(i) * -1000));
+        break;
+      case 2:
+        b.add(Value(static_cast<double>(i) / 3.0));
+        break;
+      case 3:
+        b.add(Value("value" + std::to_string(i)));
+        break;
+      case 4:
+        b.add(Value(std::string(150, 'x')));
+        break;
+      case 5:
+        b.add(Value(i % 2 == 0));
+        break;
+      case 6:
+        b.add(Value(ValueType::Null));
+        break;
+      case 7:
+        b.openArray();
+        b.add(Value(i));
+        b.add(Value("foo"));
+        b.close();
+        break;
+      case 8:
+        b.openObject();
+        b.add("a", Value(i));
+        b.add("bb", Value(true));
+        b.close();
+        break;
+      default:
+        b.add(ValuePair("binary", 6));
+        break;
+    }
+  }
+  b.close();
+  return b;
+}
+
+void runArrayIteration(double runTime) {
+  Builder b = buildMixedArray(100000);
+  Slice s = b.slice();
+
+  measure("array-iteration mixed", runTime, s.byteSize(), [&]() -> size_t {
+    uint64_t total = 0;
+    for (auto const& it : ArrayIterator(s)) {
+      total += it.byteSize();
+    }
+    sink += total;
+    return 1;
+  });
+
+  measure("array-iteration mixed, nested", runTime, s.byteSize(),
+          [&]() -> size_t {
+    uint64_t total = 0;
+    for (auto const& it : ArrayIterator(s)) {
+      if (it.isArray()) {
+        for (auto const& sub : ArrayIterator(it)) {
+          total += sub.byteSize();
+        }
+      } else if (it.isObject()) {
+        for (auto const& sub : ObjectIterator(it, true)) {
+          total += sub.value.byteSize();
+        }
+      } else {
+        total += it.byteSize();
+      }
+    }
+    sink += total;
+    return 1;
+  });
+}
+
+void runNormalizedHash(double runTime) {
+  Builder b = buildMixedArray(100000);
+  Slice s = b.slice();
+
+  measure("normalized-hash array mixed", runTime, s.byteSize(),
+          [&]() -> size_t {
+    sink += s.normalizedHash();
+    return 1;
+  });
+
+  for (size_t n : { 10, 1000 }) {
+    Builder o = buildObject(n);
+    Slice os = o.slice();
+
+    measure("normalized-hash object n=" + std::to_string(n), runTime,
+            os.byteSize(), [&]() -> size_t {
+      sink += os.normalizedHash();
+      return 1;
+    });
+  }
+}
+
+void runSort(double runTime) {
+  Builder b = buildMixedArray(100000);
+  std::vector<Slice> values;
+  for (auto const& it : ArrayIterator(b.slice())) {
+    values.emplace_back(it);
+  }
+
+  std::vector<Slice> copy;
+  measure("sort NormalizedLess mixed", runTime, 0, [&]() -> size_t {
+    copy = values;
+    std::sort(copy.begin(), copy.end(), NormalizedLess());
+    sink += copy.front().head();
+    return 1;
+  });
+
+  // equality of neighbors in sorted order, as when removing duplicates.
+  // equals() does not support Binary values
+  copy.clear();
+  for (auto const& it : values) {
+    if (!it.isBinary()) {
+      copy.emplace_back(it);
+    }
+  }
+  std::sort(copy.begin(), copy.end(), NormalizedLess());
+  measure("sort equals sorted neighbors", runTime, 0,
+          [&]() -> size_t {
+    size_t equal = 0;
+    for (size_t i = 1; i < copy.size(); ++i) {
+      equal += NormalizedCompare::equals(copy[i - 1], copy[i]) ? 1 : 0;
+    }
+    sink += equal;
+    return copy.size() - 1;
+  });
+}
+
+void runKeyEncoding(double runTime) {
+  Builder b = buildMixedArray(100000);
+  Slice s = b.slice();
+
+  std::vector<std::string> keys;
+  measure("key-encoding encode mixed", runTime, s.byteSize(), [&]() -> size_t {
+    keys.clear();
+    for (auto const& it : ArrayIterator(s)) {
+      keys.emplace_back(KeyEncoder::encode(it));
+    }
+    return 1;
+  });
+
+  std::vector<std::string> copy;
+  measure("key-encoding sort encoded mixed", runTime, 0, [&]() -> size_t {
+    copy = keys;
+    std::sort(copy.begin(), copy.end());
+    sink += copy.front().size();
+    return 1;
+  });
+
+  measure("key-encoding decode mixed", runTime, 0, [&]() -> size_t {
+    Builder out;
+    out.openArray();
+    for (auto const& key : keys) {
+      KeyEncoder::decode(reinterpret_cast<uint8_t const*>(key.data()),
+                         key.size(), out);
+    }
+    out.close();
+    sink += out.size();
+    return 1;
+  });
+}
+
+void runTranslatedKeys(double runTime) {
+  // a dictionary of 200 attribute names, documents use 10 of them each
+  AttributeTranslator translator;
+  for (uint64_t i = 0; i < 200; ++i) {
+    translator.add("attribute" + std::to_string(i), i);
+  }
+  translator.seal();
+  AttributeTranslatorScope scope(&translator);
+
+  Options options;
+  options.attributeTranslator = &translator;
+
+  Builder b(&options);
+  b.openArray();
+  for (size_t i = 0; i < 10000; ++i) {
+    b.openObject();
+    for (size_t j = 0; j < 10; ++j) {
+      b.add("attribute" + std::to_string((i + j * 17) % 200), Value(j));
+    }
+    b.close();
+  }
+  b.close();
+  Slice s = b.slice();
+
+  measure("translated-keys iterate", runTime, s.byteSize(), [&]() -> size_t {
+    uint64_t total = 0;
+    for (auto const& doc : ArrayIterator(s)) {
+      ObjectIterator it(doc, true);
+      while (it.valid()) {
+        total += it.key(true).getStringLength();
+        it.next();
+      }
+    }
+    sink += total;
+    return 1;
+  });
+
+  measure("translated-keys dump", runTime, s.byteSize(), [&]() -> size_t {
+    std::string json;
+    StringSink stringSink(&json);
+    Dumper::dump(s, &stringSink);
+    sink += json.size();
+    return 1;
+  });
+
+  std::vector<std::string> keys;
+  for (uint64_t i = 0; i < 400; ++i) {
+    keys.emplace_back("attribute" + std::to_string(i));
+  }
+  measure("translated-keys translate key", runTime, 0, [&]() -> size_t {
+    uint64_t found = 0;
+    for (auto const& key : keys) {
+      found += translator.translate(key.data(), key.size()) != nullptr ? 1 : 0;
+    }
+    sink += found;
+    return keys.size();
+  });
+}
+
+void runDump(double runTime) {
+  Builder b = buildMixedArray(100000);
+  Slice s = b.slice();
+
+  Options options;
+  options.unsupportedTypeBehavior = Options::NullifyUnsupportedType;
+
+  std::string json;
+  measure("dump StringSink", runTime, s.byteSize(), [&]() -> size_t {
+    json.clear();
+    StringSink stringSink(&json);
+    Dumper::dump(s, &stringSink, &options);
+    sink += json.size();
+    return 1;
+  });
+
+  Buffer<char> buffer;
+  measure("dump CharBufferSink", runTime, s.byteSize(), [&]() -> size_t {
+    buffer.clear();
+    CharBufferSink bufferSink(&buffer);
+    Dumper::dump(s, &bufferSink, &options);
+    sink += buffer.size();
+    return 1;
+  });
+
+  measure("dump StringStreamSink", runTime, s.byteSize(), [&]() -> size_t {
+    std::ostringstream stream;
+    StringStreamSink streamSink(&stream);
+    Dumper::dump(s, &streamSink, &options);
+    sink += stream.tellp();
+    return 1;
+  });
+
+  Options prettyOptions = options;
+  prettyOptions.prettyPrint = true;
+  measure("dump StringSink prettyPrint", runTime, s.byteSize(),
+          [&]() -> size_t {
+    json.clear();
+    StringSink stringSink(&json);
+    Dumper::dump(s, &stringSink, &prettyOptions);
+    sink += json.size();
+    return 1;
+  });
+}
+
+void runDumpObjects(double runTime) {
+  // one object with 100k attributes and 10k objects with 20 attributes
+  // each, with attributes added in random order
+  Builder wide;
+  wide.openObject();
+  for (size_t i = 0; i < 100000; ++i) {
+    wide.add("key" + std::to_string((i * 7919) % 100000), Value(i));
+  }
+  wide.close();
+
+  Builder many;
+  many.openArray();
+  for (size_t i = 0; i < 10000; ++i) {
+    many.openObject();
+    for (size_t j = 0; j < 20; ++j) {
+      many.add("attribute" + std::to_string((j * 7 + i) % 20), Value(j));
+    }
+    many.close();
+  }
+  many.close();
+
+  Options indexOrder;
+  Options storageOrder;
+  storageOrder.dumpAttributesInIndexOrder = false;
+
+  for (auto const& input : { std::make_pair("1 x 100k", wide.slice()),
+                             std::make_pair("10k x 20", many.slice()) }) {
+    for (auto const& order : { std::make_pair("index order", &indexOrder),
+                               std::make_pair("storage order", &storageOrder) }) {
+      Slice s = input.second;
+      std::string json;
+      measure(std::string("dump-objects ") + input.first + " " + order.first,
+              runTime, s.byteSize(), [&]() -> size_t {
+        json.clear();
+        StringSink stringSink(&json);
+        Dumper::dump(s, &stringSink, order.second);
+        sink += json.size();
+        return 1;
+      });
+    }
+  }
+}
+
+void runDumpIntegers(double runTime) {
+  // arrays of 100k integers with values from different ranges
+  struct Range {
+    char const* label;
+    uint64_t modulo;
+    bool negative;
+  };
+  std::vector<Range> const ranges = {
+    { "0..9", 10, false },
+    { "0..999", 1000, false },
+    { "0..2^32", 1ULL << 32, false },
+    { "0..2^64", 0, false },
+    { "-2^32..0", 1ULL << 32, true },
+  };
+
+  for (auto const& range : ranges) {
+    Builder b;
+    b.openArray();
+    uint64_t x = 88172645463325252ULL;
+    for (size_t i = 0; i < 100000; ++i) {
+      x ^= x << 13;
+      x ^= x >> 7;
+      x ^= x << 17;
+      uint64_t const v = range.modulo == 0 ? x : x % range.modulo;
+      if (range.negative) {
+        b.add(Value(-static_cast<int64_t>(v)));
+      } else {
+        b.add(Value(v));
+      }
+    }
+    b.close();
+    Slice s = b.slice();
+
+    std::string json;
+    measure(std::string("dump-integers ") + range.label, runTime,
+            s.byteSize() / s.length(), [&]() -> size_t {
+      json.clear();
+      StringSink stringSink(&json);
+      Dumper::dump(s, &stringSink);
+      sink += json.size();
+      return s.length();
+    });
+  }
+}
+
+void runDumpDoubles(double runTime) {
+  // 100k doubles with few digits and 100k doubles with random bit patterns
+  Builder simple;
+  simple.openArray();
+  for (size_t i = 0; i < 100000; ++i) {
+    simple.add(Value(static_cast<double>(i) / 8.0 + 0.1));
+  }
+  simple.close();
+
+  Builder random;
+  random.openArray();
+  uint64_t x = 88172645463325252ULL;
+  size_t n = 0;
+  while (n < 100000) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    double d;
+    memcpy(&d, &x, sizeof(d));
+    if (!std::isnan(d) && std::isfinite(d)) {
+      random.add(Value(d));
+      ++n;
+    }
+  }
+  random.close();
+
+  Options shortest;
+  Options fpconv;
+  fpconv.doubleFormat = Options::FpconvDoubleFormat;
+
+  for (auto const& input : { std::make_pair("simple", simple.slice()),
+                             std::make_pair("random", random.slice()) }) {
+    for (auto const& format : { std::make_pair("shortest", &shortest),
+                                std::make_pair("fpconv", &fpconv) }) {
+      Slice s = input.second;
+      std::string json;
+      measure(std::string("dump-doubles ") + input.first + " " + format.first,
+              runTime, s.byteSize() / s.length(), [&]() -> size_t {
+        json.clear();
+        StringSink stringSink(&json);
+        Dumper::dump(s, &stringSink, format.second);
+        sink += json.size();
+        return s.length();
+      });
+    }
+  }
+}
+
+void runDumpStrings(double runTime) {
+  std::string const text =
+      "Lorem ipsum dolor sit amet, te enim mandamus consequat ius, cu eos "
+      "timeam bonorum, in nec eruditi tibique. At nec malorum saperet vivendo. ";
+  std::string const greek =
+      "\xce\x9c\xce\xb5\xce\xb9 \xce\xb5\xce\xb9 \xcf\x80\xce\xb1\xcf\x81"
+      "\xcf\x84\xce\xb5\xce\xbc \xce\xbc\xce\xbf\xce\xbb\xce\xbb\xce\xb9"
+      "\xcf\x82, ";
+
+  // 10k strings each: short plain strings, long plain strings with an
+  // occasional escape, and long non-ASCII strings
+  struct Input {
+    char const* label;
+    std::string value;
+    bool escapeUnicode;
+  };
+  std::vector<Input> inputs;
+  inputs.push_back({ "short", "attribute value", false });
+  std::string value;
+  for (size_t i = 0; i < 8; ++i) {
+    value += text;
+  }
+  value += "\n\"quoted\"";
+  inputs.push_back({ "long", value, false });
+  value.clear();
+  for (size_t i = 0; i < 16; ++i) {
+    value += greek;
+  }
+  inputs.push_back({ "utf8", value, false });
+  inputs.push_back({ "utf8 escapeUnicode", value, true });
+
+  for (auto const& input : inputs) {
+    Builder b;
+    b.openArray();
+    for (size_t i = 0; i < 10000; ++i) {
+      b.add(Value(input.value));
+    }
+    b.close();
+    Slice s = b.slice();
+
+    Options options;
+    options.escapeUnicode = input.escapeUnicode;
+
+    std::string json;
+    measure(std::string("dump-strings ") + input.label, runTime, s.byteSize(),
+            [&]() -> size_t {
+      json.clear();
+      StringSink stringSink(&json);
+      Dumper::dump(s, &stringSink, &options);
+      sink += json.size();
+      return 1;
+    });
+  }
+}
+
+void runDumpLimited(double runTime) {
+  // logging-style dumps of large values with limited output. the time
+  // per dump should not depend on the size of the value. bytes per op
+  // are the bytes of JSON produced
+  Builder mixed = buildMixedArray(100000);
+  Builder longString;
+  longString.add(Value(std::string(10 * 1024 * 1024, 'x')));
+
+  Options options;
+  options.unsupportedTypeBehavior = Options::NullifyUnsupportedType;
+  options.dumpMaxBytes = 1024;
+
+  Options elementOptions = options;
+  elementOptions.dumpMaxBytes = 0;
+  elementOptions.dumpMaxElements = 10;
+
+  struct Input {
+    char const* label;
+    Slice slice;
+    Options const* options;
+  };
+  for (auto const& input : { Input{ "100k values 1 KB", mixed.slice(), &options },
+                             Input{ "100k values 10 elements", mixed.slice(), &elementOptions },
+                             Input{ "10 MB string 1 KB", longString.slice(), &options } }) {
+    std::string json = Dumper::toString(input.slice, input.options);
+    measure(std::string("dump-limited ") + input.label, runTime, json.size(),
+            [&]() -> size_t {
+      json.clear();
+      StringSink stringSink(&json);
+      Dumper::dump(input.slice, &stringSink, input.options);
+      sink += json.size();
+      return 1;
+    });
+  }
+}
+
+void runDumpParallel(double runTime) {
+  // Dumper::dumpParallel() of an array with 1M values with 1, 2, 4, ...
+  // threads, up to the number of hardware threads
+  Builder b = buildMixedArray(1000000);
+  Slice s = b.slice();
+
+  Options options;
+  options.unsupportedTypeBehavior = Options::NullifyUnsupportedType;
+
+  size_t const maxThreads =
+      (std::max)(static_cast<size_t>(std::thread::hardware_concurrency()),
+                 static_cast<size_t>(1));
+  std::vector<size_t> concurrencies;
+  for (size_t n = 1; n < maxThreads; n *= 2) {
+    concurrencies.push_back(n);
+  }
+  concurrencies.push_back(maxThreads);
+
+  std::string json;
+  for (size_t concurrency : concurrencies) {
+    measure("dump-parallel " + std::to_string(concurrency) + " threads",
+            runTime, s.byteSize(), [&]() -> size_t {
+      json.clear();
+      StringSink stringSink(&json);
+      Dumper::dumpParallel(s, &stringSink, &options, concurrency);
+      sink += json.size();
+      return 1;
+    });
+  }
+}
+
+void runValidate(double runTime) {
+  // Validator bandwidth for full validation, with and without UTF-8
+  // checks, and for framing-only validation of the same values
+  Builder mixed = buildMixedArray(100000);
+
+  Builder objects;
+  objects.openArray();
+  Builder object = buildObject(16);
+  for (size_t i = 0; i < 10000; ++i) {
+    objects.add(object.slice());
+  }
+  objects.close();
+
+  Builder strings;
+  strings.openArray();
+  for (size_t i = 0; i < 10000; ++i) {
+    std::string value;
+    while (value.size() < 1000) {
+      value.append("abcdefgh\xc3\xa4\xc3\xb6\xc3\xbc\xe2\x82\xac");
+    }
+    strings.add(Value(value));
+  }
+  strings.close();
+
+  Options options;
+  Options utf8Options;
+  utf8Options.validateUtf8Strings = true;
+
+  struct Input {
+    char const* label;
+    Slice slice;
+  };
+  for (auto const& input : { Input{ "100k mixed", mixed.slice() },
+                             Input{ "10k objects", objects.slice() },
+                             Input{ "10k strings", strings.slice() } }) {
+    Slice s = input.slice;
+    for (auto const& mode : { std::make_pair("", &options),
+                              std::make_pair(" utf8", &utf8Options) }) {
+      Validator validator(mode.second);
+      measure(std::string("validate ") + input.label + mode.first, runTime,
+              s.byteSize(), [&]() -> size_t {
+        sink += validator.validate(s.start(), s.byteSize());
+        return 1;
+      });
+    }
+
+    Validator validator(&options);
+    measure(std::string("validate-framing ") + input.label, runTime,
+            s.byteSize(), [&]() -> size_t {
+      sink += validator.validateFraming(s.start(), s.byteSize());
+      return 1;
+    });
+  }
+}
+
+void runValidateParallel(double runTime) {
+  // Validator::validateParallel() of an array with 1M values and of an
+  // object with 1M attributes with 1, 2, 4, ... threads, up to the number
+  // of hardware threads
+  Builder mixed = buildMixedArray(1000000);
+  Builder object = buildObject(1000000);
+
+  size_t const maxThreads =
+      (std::max)(static_cast<size_t>(std::thread::hardware_concurrency()),
+                 static_cast<size_t>(1));
+  std::vector<size_t> concurrencies;
+  for (size_t n = 1; n < maxThreads; n *= 2) {
+    concurrencies.push_back(n);
+  }
+  concurrencies.push_back(maxThreads);
+
+  Validator validator;
+  for (auto const& input : { std::make_pair("1M mixed", mixed.slice()),
+                             std::make_pair("1M attributes", object.slice()) }) {
+    Slice s = input.second;
+    for (size_t concurrency : concurrencies) {
+      measure(std::string("validate-parallel ") + input.first + " " +
+                  std::to_string(concurrency) + " threads",
+              runTime, s.byteSize(), [&]() -> size_t {
+        sink += validator.validateParallel(s.start(), s.byteSize(), false,
+                                           concurrency);
+        return 1;
+      });
+    }
+  }
+}
+
+void runReadSequence(double runTime) {
+  // Reader over 1M values of mixed types stored back to back, with the
+  // default and with a small buffer, and with per-value validation
+  Builder mixed = buildMixedArray(1000000);
+  std::string data;
+  for (auto const& it : ArrayIterator(mixed.slice())) {
+    data.append(it.startAs<char>(), it.byteSize());
+  }
+
+  Validator validator;
+  struct Mode {
+    char const* label;
+    ValueLength bufferSize;
+    Validator const* validator;
+  };
+  for (auto const& mode : { Mode{ "4 MB buffer", Reader::DefaultBufferSize, nullptr },
+                            Mode{ "64 kB buffer", 65536, nullptr },
+                            Mode{ "validated", Reader::DefaultBufferSize,
+                                  &validator } }) {
+    measure(std::string("read-sequence 1M mixed ") + mode.label, runTime,
+            data.size(), [&]() -> size_t {
+      std::istringstream in(data);
+      Reader reader(in, mode.validator, mode.bufferSize);
+      Slice s;
+      while (reader.next(s)) {
+        sink += s.head();
+      }
+      return 1;
+    });
+  }
+}
+
+void runDocumentFile(double runTime) {
+  // DocumentFile::at() on a document file with 1M objects with 4
+  // attributes each, in file order and in random order
+  size_t const n = 1000000;
+  std::string data;
+  {
+    StringSink stringSink(&data);
+    DocumentFileWriter writer(&stringSink);
+    Builder b;
+    for (size_t i = 0; i < n; ++i) {
+      b.clear();
+      b.openObject();
+      b.add("_key", Value("key" + std::to_string(i)));
+      b.add("name", Value("name of document " + std::to_string(i)));
+      b.add("value", Value(i));
+      b.add("active", Value(i % 2 == 0));
+      b.close();
+      writer.add(b.slice());
+    }
+    writer.finish();
+  }
+  DocumentFile file(reinterpret_cast<uint8_t const*>(data.data()), data.size());
+
+  std::vector<ValueLength> sequential;
+  std::vector<ValueLength> random;
+  uint64_t x = 88172645463325252ULL;
+  for (size_t i = 0; i < n; ++i) {
+    sequential.push_back(i);
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    random.push_back(x % n);
+  }
+
+  for (auto const& order : { std::make_pair("file order", &sequential),
+                             std::make_pair("random order", &random) }) {
+    std::vector<ValueLength> const& indexes = *order.second;
+    measure(std::string("document-file 1M at() ") + order.first, runTime, 0,
+            [&]() -> size_t {
+      for (auto const& it : indexes) {
+        sink += file.at(it).head();
+      }
+      return indexes.size();
+    });
+  }
+}
+
+void runSharedSlice(double runTime) {
+  // handing out the 100k members of an array of mixed types as owning
+  // values, copied into a SliceContainer or shared as SharedSlice
+  Builder b = buildMixedArray(100000);
+  SharedSlice array(b.steal());
+  Slice s = array.slice();
+
+  measure("shared-slice 100k SliceContainer copies", runTime, s.byteSize(),
+          [&]() -> size_t {
+    std::vector<SliceContainer> members;
+    members.reserve(s.length());
+    for (auto const& it : ArrayIterator(s)) {
+      members.emplace_back(it);
+    }
+    sink += members.size();
+    return 1;
+  });
+
+  measure("shared-slice 100k SharedSlices", runTime, s.byteSize(),
+          [&]() -> size_t {
+    std::vector<SharedSlice> members;
+    members.reserve(s.length());
+    for (auto const& it : ArrayIterator(s)) {
+      members.emplace_back(array.share(it));
+    }
+    sink += members.size();
+    return 1;
+  });
+}
+
+std::vector<Scenario> const scenarios = {
+  { "object-lookup", "Slice::get() on objects with 4 to 4096 keys",
+    runObjectLookup },
+  { "wide-object-lookup", "Slice::get() on objects with 10k to 1M keys, "
+    "with and without hash table", runWideObjectLookup },
+  { "array-iteration", "ArrayIterator over 100k values of mixed types",
+    runArrayIteration },
+  { "normalized-hash", "Slice::normalizedHash() on mixed arrays and objects",
+    runNormalizedHash },
+  { "sort", "std::sort of 100k values of mixed types with NormalizedLess",
+    runSort },
+  { "key-encoding", "KeyEncoder encoding, memcmp sort and decoding of 100k "
+    "values of mixed types", runKeyEncoding },
+  { "translated-keys", "iteration and dumping of 10k objects with "
+    "translated attribute names", runTranslatedKeys },
+  { "dump", "JSON dumping of 100k values of mixed types into different "
+    "sinks", runDump },
+  { "dump-objects", "JSON dumping of large and many objects in index and "
+    "in storage order", runDumpObjects },
+  { "dump-integers", "JSON dumping of 100k integers from different value "
+    "ranges", runDumpIntegers },
+  { "dump-doubles", "JSON dumping of 100k doubles, shortest and fpconv "
+    "format", runDumpDoubles },
+  { "dump-strings", "JSON dumping of 10k short, long and non-ASCII strings",
+    runDumpStrings },
+  { "dump-limited", "JSON dumping of large values with output limited by "
+    "size and element count", runDumpLimited },
+  { "dump-parallel", "parallel JSON dumping of 1M values of mixed types "
+    "with 1 up to all hardware threads", runDumpParallel },
+  { "validate", "Validator bandwidth on mixed values, objects and strings, "
+    "full and framing only", runValidate },
+  { "validate-parallel", "parallel validation of 1M values and of 1M "
+    "attributes with 1 up to all hardware threads", runValidateParallel },
+  { "read-sequence", "Reader over 1M values of mixed types stored back to "
+    "back, with and without validation", runReadSequence },
+  { "document-file", "DocumentFile access by index to 1M documents in file "
+    "and in random order", runDocumentFile },
+  { "shared-slice", "owning copies of 100k array members with SliceContainer "
+    "and SharedSlice", runSharedSlice },
+};
+
+void usage(char* argv[]) {
+  std::cout << "Usage: " << argv[0] << " [SCENARIO ...] [--time SECONDS]"
+            << std::endl;
+  std::cout << "Runs the given micro benchmark scenarios, or all if none"
+            << std::endl;
+  std::cout << "is specified. Each measurement runs for SECONDS seconds"
+            << std::endl;
+  std::cout << "(default: 1). Available scenarios:" << std::endl;
+  for (auto const& it : scenarios) {
+    std::cout << "  " << std::left << std::setw(24) << it.name
+              << it.description << std::endl;
+  }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  double runTime = 1.0;
+  std::vector<std::string> selected;
+
+  for (int i = 1; i < argc; ++i) {
+    if (::strcmp(argv[i], "--help") == 0 || ::strcmp(argv[i], "-h") == 0) {
+      usage(argv);
+      return EXIT_SUCCESS;
+    }
+    if (::strcmp(argv[i], "--time") == 0) {
+      if (++i >= argc) {
+        usage(argv);
+        return EXIT_FAILURE;
+      }
+      runTime = std::stod(argv[i]);
+      continue;
+    }
+    selected.emplace_back(argv[i]);
+  }
+
+  for (auto const& name : selected) {
+    bool found = false;
+    for (auto const& it : scenarios) {
+      if (name == it.name) {
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      std::cerr << "Unknown scenario '" << name << "'" << std::endl;
+      usage(argv);
+      return EXIT_FAILURE;
+    }
+  }
+
+  for (auto const& it : scenarios) {
+    if (!selected.empty() &&
+        std::find(selected.begin(), selected.end(), it.name) == selected.end()) {
+      continue;
+    }
+    it.run(runTime);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -27,6 +27,8 @@
 #include <iostream>
 #include <string>
 #include <fstream>
+#include <memory>
+#include <sstream>
 
 #include "velocypack/vpack.h"
 #include "velocypack/velocypack-exception-macros.h"
@@ -40,11 +42,12 @@ static void usage(char* argv[]) {
 #else
   std::cout << "Usage: " << argv[0] << " [OPTIONS] INFILE OUTFILE" << std::endl;
 #endif
-  std::cout << "This program reads the VPack INFILE into a string and saves its"
+  std::cout << "This program reads the VPack values stored back to back in INFILE"
             << std::endl;
-  std::cout << "JSON representation in file OUTFILE. Will work only for input"
+  std::cout << "and saves their JSON representations in file OUTFILE, one value"
+            << std::endl;
+  std::cout << "per line. The input is streamed, so INFILE can be of any size."
             << std::endl;
-  std::cout << "files up to 2 GB size." << std::endl;
 #ifdef __linux__
   std::cout << "If no OUTFILE is specified, the generated JSON value be"
             << std::endl;
@@ -56,6 +59,12 @@ static void usage(char* argv[]) {
   std::cout << " --print-unsupported       convert non-JSON types into something else" << std::endl;
   std::cout << " --no-print-unsupported    fail when encoutering a non-JSON type" << std::endl;
   std::cout << " --hex                     try to turn hex-encoded input into binary vpack" << std::endl;
+  std::cout << " --dict-in FILE            translate compressed Object keys using the key" << std::endl;
+  std::cout << "                           dictionary from FILE" << std::endl;
+  std::cout << " --documents               read INFILE as document file, as written by" << std::endl;
+  std::cout << "                           json-to-vpack --documents" << std::endl;
+  std::cout << " --index N                 only convert the document with index N of the" << std::endl;
+  std::cout << "                           document file (implies --documents)" << std::endl;
 }
 
 static std::string convertFromHex(std::string const& value) {
@@ -105,6 +114,9 @@ int main(int argc, char* argv[]) {
   bool pretty = true;
   bool printUnsupported = true;
   bool hex = false;
+  bool documents = false;
+  char const* index = nullptr;
+  char const* dictInName = nullptr;
 
   int i = 1;
   while (i < argc) {
@@ -122,6 +134,21 @@ int main(int argc, char* argv[]) {
       printUnsupported = false;
     } else if (allowFlags && isOption(p, "--hex")) {
       hex = true;
+    } else if (allowFlags && isOption(p, "--dict-in")) {
+      if (++i >= argc) {
+        usage(argv);
+        return EXIT_FAILURE;
+      }
+      dictInName = argv[i];
+    } else if (allowFlags && isOption(p, "--documents")) {
+      documents = true;
+    } else if (allowFlags && isOption(p, "--index")) {
+      if (++i >= argc) {
+        usage(argv);
+        return EXIT_FAILURE;
+      }
+      index = argv[i];
+      documents = true;
     } else if (allowFlags && isOption(p, "--")) {
       allowFlags = false;
     } else if (infileName == nullptr) {
@@ -141,7 +168,7 @@ int main(int argc, char* argv[]) {
   }
 #endif
 
-  if (infileName == nullptr) {
+  if (infileName == nullptr || (hex && documents)) {
     usage(argv);
     return EXIT_FAILURE;
   }
@@ -169,42 +196,106 @@ int main(int argc, char* argv[]) {
   }
 #endif
 
-  std::string s;
-  std::ifstream ifs(infile, std::ifstream::in);
+  std::unique_ptr<DocumentFile> documentFile;
+  if (documents) {
+    try {
+      documentFile.reset(new DocumentFile(
+          infile, index != nullptr ? DocumentFile::RandomAccess
+                                   : DocumentFile::SequentialAccess));
+    } catch (Exception const& ex) {
+      std::cerr << "Cannot open document file '" << infile << "': " << ex.what()
+                << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::ifstream ifs;
+  if (!documents) {
+    ifs.open(infile, std::ifstream::in | std::ifstream::binary);
+  }
 
-  if (!ifs.is_open()) {
+  if (!documents && !ifs.is_open()) {
     std::cerr << "Cannot read infile '" << infile << "'" << std::endl;
     return EXIT_FAILURE;
   }
 
-  {
+  // hex-encoded input is small enough to be converted in memory
+  std::istringstream hexInput;
+  if (hex) {
+    std::string s;
     char buffer[32768];
-    s.reserve(sizeof(buffer));
-
     while (ifs.good()) {
       ifs.read(&buffer[0], sizeof(buffer));
       s.append(buffer, checkOverflow(ifs.gcount()));
     }
+    hexInput.str(convertFromHex(s));
   }
-  ifs.close();
 
-  if (hex) {
-    s = convertFromHex(s);
+  std::unique_ptr<KeyDictionary> dictionary;
+  if (dictInName != nullptr) {
+    try {
+      dictionary.reset(new KeyDictionary(dictInName));
+    } catch (Exception const& ex) {
+      std::cerr << "Cannot load key dictionary '" << dictInName
+                << "': " << ex.what() << std::endl;
+      return EXIT_FAILURE;
+    }
   }
-
-  Slice const slice(s.data());
+  AttributeTranslatorScope scope(dictionary != nullptr ? dictionary->translator() : nullptr);
 
   Options options;
   options.prettyPrint = pretty;
   options.unsupportedTypeBehavior = 
     (printUnsupported ? Options::ConvertUnsupportedType : Options::FailOnUnsupportedType);
 
+  std::ofstream ofs(outfileName, std::ofstream::out);
+
+  if (!ofs.is_open()) {
+    std::cerr << "Cannot write outfile '" << outfileName << "'" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // reset stream
+  if (!toStdOut) {
+    ofs.seekp(0);
+  }
+
   Buffer<char> buffer(4096);
   CharBufferSink sink(&buffer);
   Dumper dumper(&sink, &options);
 
-  try {
+  uint64_t count = 0;
+  uint64_t inSize = 0;
+  uint64_t outSize = 0;
+
+  auto convert = [&](Slice slice) {
+    if (count > 0) {
+      buffer.push_back('\n');
+    }
     dumper.dump(slice);
+    ++count;
+    inSize += slice.byteSize();
+
+    // write into stream, so that the JSON is not kept in memory
+    ofs.write(buffer.data(), buffer.size());
+    outSize += buffer.size();
+    buffer.reset();
+  };
+
+  try {
+    if (index != nullptr) {
+      convert(documentFile->at(std::stoull(index)));
+    } else if (documents) {
+      for (ValueLength i = 0; i < documentFile->size(); ++i) {
+        convert(documentFile->at(i));
+      }
+    } else {
+      Reader reader(hex ? static_cast<std::istream&>(hexInput) : ifs);
+      Slice slice;
+      while (reader.next(slice)) {
+        convert(slice);
+      }
+    }
   } catch (Exception const& ex) {
     std::cerr << "An exception occurred while processing infile '" << infile
               << "': " << ex.what() << std::endl;
@@ -215,29 +306,21 @@ int main(int argc, char* argv[]) {
     return EXIT_FAILURE;
   }
 
-  std::ofstream ofs(outfileName, std::ofstream::out);
+  ifs.close();
+  ofs.close();
 
-  if (!ofs.is_open()) {
-    std::cerr << "Cannot write outfile '" << outfileName << "'" << std::endl;
+  if (count == 0 && !documents) {
+    std::cerr << "Infile '" << infile << "' does not contain any VPack value"
+              << std::endl;
     return EXIT_FAILURE;
   }
 
-  // reset stream
-  if (!toStdOut) {
-    ofs.seekp(0);
-  }
-
-  // write into stream
-  char const* start = buffer.data();
-  ofs.write(start, buffer.size());
-
-  ofs.close();
-
   if (!toStdOut) {
     std::cout << "Successfully converted JSON infile '" << infile << "'"
               << std::endl;
-    std::cout << "VPack Infile size: " << s.size() << std::endl;
-    std::cout << "JSON Outfile size: " << buffer.size() << std::endl;
+    std::cout << "VPack Infile size: " << inSize << std::endl;
+    std::cout << "VPack values: " << count << std::endl;
+    std::cout << "JSON Outfile size: " << outSize << std::endl;
   }
   
   VELOCYPACK_GLOBAL_EXCEPTION_CATCH